@@ -9,21 +9,24 @@
 
 import type { Layout, Node, Yoga } from "./src/yoga.ts";
 import { constants, Direction, Unit } from "./src/yoga_const.ts";
+import { installFFIBackend } from "./src/yoga_ffi.ts";
 
-// hack: for tests
-Object.defineProperty(globalThis, "YGBENCHMARK", {
-  get: () => Deno.test,
-});
+// hack: for tests, unless a benchmark runner installed its own
+if (!("YGBENCHMARK" in globalThis)) {
+  Object.defineProperty(globalThis, "YGBENCHMARK", {
+    get: () => Deno.test,
+  });
+}
 
 let module!: { exports: Yoga };
+let libraryPath: string | undefined;
 
 if (typeof Deno === "object") {
   const { dlopen } = await import("node:process");
   module = { exports: {} } as any;
-  dlopen(
-    module,
-    new URL("./build/libyoga_node_api.dylib", import.meta.url).pathname,
-  );
+  libraryPath = new URL("./build/libyoga_node_api.dylib", import.meta.url)
+    .pathname;
+  dlopen(module, libraryPath);
 } else if (typeof require !== "undefined") {
   const r = require;
   module = r(
@@ -47,6 +50,12 @@ function patch(prototype: any, name: string, fn: any) {
 
 const lib = module.exports as any;
 
+// Prefer fast FFI calls for the hot setters and getters when allowed to. This
+// has to happen before the patches below, which wrap the installed methods.
+if (libraryPath !== undefined) {
+  installFFIBackend(lib, libraryPath);
+}
+
 for (
   const fnName of [
     "setPosition",
@@ -137,6 +146,27 @@ patch(
   },
 );
 
+patch(
+  lib.Node.prototype,
+  "calculateLayoutSliced",
+  function (
+    this: Node,
+    original: (
+      this: Node,
+      width: number,
+      height: number,
+      direction: Direction,
+      budgetMs: number,
+    ) => boolean,
+    width = NaN,
+    height = NaN,
+    direction = Direction.LTR,
+    budgetMs = Infinity,
+  ) {
+    return original.call(this, width, height, direction, budgetMs);
+  },
+);
+
 function wrapMeasureFunction(
   measureFunction: (...args: any[]) => Layout,
 ) {
@@ -0,0 +1,234 @@
+#include "call_trace.h"
+#include <cstring>
+
+namespace {
+
+constexpr char kMagic[4] = {'Y', 'G', 'T', 'R'};
+
+// Bounds the nesting of array values.
+constexpr size_t kMaxValueDepth = 16;
+
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T> T read() {
+    T value = {};
+    if (offset_ + sizeof(T) > size_) {
+      failed_ = true;
+      return value;
+    }
+    std::memcpy(&value, data_ + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+  }
+
+  void readBytes(std::string &out, size_t length) {
+    if (length > size_ - offset_) {
+      failed_ = true;
+      return;
+    }
+    out.assign((const char *)data_ + offset_, length);
+    offset_ += length;
+  }
+
+  bool readValue(TraceValue &value, size_t depth) {
+    value.type = static_cast<TraceValue::Type>(read<uint8_t>());
+    switch (value.type) {
+    case TraceValue::Undefined:
+    case TraceValue::Null:
+    case TraceValue::Function:
+    case TraceValue::Other:
+      break;
+    case TraceValue::Number:
+      value.number = read<double>();
+      break;
+    case TraceValue::Bool:
+      value.number = read<uint8_t>();
+      break;
+    case TraceValue::String:
+    case TraceValue::Buffer:
+      readBytes(value.bytes, read<uint32_t>());
+      break;
+    case TraceValue::Node:
+    case TraceValue::Config:
+      value.id = read<uint32_t>();
+      break;
+    case TraceValue::Array: {
+      uint32_t count = read<uint32_t>();
+      // Every element takes at least a byte.
+      if (depth >= kMaxValueDepth || count > size_ - offset_) {
+        return false;
+      }
+      value.elements.resize(count);
+      for (TraceValue &element : value.elements) {
+        if (!readValue(element, depth + 1)) {
+          return false;
+        }
+      }
+      break;
+    }
+    default:
+      return false;
+    }
+    return !failed_;
+  }
+
+  bool done() const { return offset_ == size_; }
+  bool failed() const { return failed_; }
+
+private:
+  const uint8_t *data_;
+  size_t size_;
+  size_t offset_ = 0;
+  bool failed_ = false;
+};
+
+} // namespace
+
+TraceWriter::TraceWriter() {
+  out_.insert(out_.end(), kMagic, kMagic + sizeof(kMagic));
+  write<uint16_t>(kCallTraceVersion);
+  write<uint16_t>(0);
+}
+
+template <typename T> void TraceWriter::write(T value) {
+  size_t at = out_.size();
+  out_.resize(at + sizeof(T));
+  std::memcpy(out_.data() + at, &value, sizeof(T));
+}
+
+void TraceWriter::writeValue(TraceValue const &value) {
+  write<uint8_t>(value.type);
+  switch (value.type) {
+  case TraceValue::Number:
+    write<double>(value.number);
+    break;
+  case TraceValue::Bool:
+    write<uint8_t>(value.number != 0);
+    break;
+  case TraceValue::String:
+  case TraceValue::Buffer:
+    write<uint32_t>(value.bytes.size());
+    out_.insert(out_.end(), value.bytes.begin(), value.bytes.end());
+    break;
+  case TraceValue::Node:
+  case TraceValue::Config:
+    write<uint32_t>(value.id);
+    break;
+  case TraceValue::Array:
+    write<uint32_t>(value.elements.size());
+    for (TraceValue const &element : value.elements) {
+      writeValue(element);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+void TraceWriter::writeCall(const char *name, TraceValue const &self,
+                            std::vector<TraceValue> const &args) {
+  auto [it, added] = names_.try_emplace(name, names_.size());
+  if (added) {
+    size_t length = std::strlen(name);
+    write<uint8_t>((uint8_t)TraceRecordKind::Name);
+    write<uint16_t>(it->second);
+    write<uint16_t>(length);
+    out_.insert(out_.end(), name, name + length);
+  }
+  write<uint8_t>((uint8_t)TraceRecordKind::Call);
+  write<uint16_t>(it->second);
+  writeValue(self);
+  write<uint8_t>(args.size());
+  for (TraceValue const &arg : args) {
+    writeValue(arg);
+  }
+}
+
+void TraceWriter::writeNodeCreated(uint32_t id, uint32_t configId) {
+  write<uint8_t>((uint8_t)TraceRecordKind::NodeCreated);
+  write<uint32_t>(id);
+  write<uint32_t>(configId);
+}
+
+void TraceWriter::writeConfigCreated(uint32_t id) {
+  write<uint8_t>((uint8_t)TraceRecordKind::ConfigCreated);
+  write<uint32_t>(id);
+}
+
+void TraceWriter::writeMeasure(uint32_t id, float availableWidth,
+                               uint8_t widthMode, float availableHeight,
+                               uint8_t heightMode, float width, float height) {
+  write<uint8_t>((uint8_t)TraceRecordKind::Measure);
+  write<uint32_t>(id);
+  write<float>(availableWidth);
+  write<uint8_t>(widthMode);
+  write<float>(availableHeight);
+  write<uint8_t>(heightMode);
+  write<float>(width);
+  write<float>(height);
+}
+
+bool readCallTrace(const uint8_t *data, size_t size,
+                   std::vector<std::string> &names,
+                   std::vector<TraceRecord> &records) {
+  Reader reader(data, size);
+  for (char c : kMagic) {
+    if (reader.read<char>() != c) {
+      return false;
+    }
+  }
+  if (reader.read<uint16_t>() != kCallTraceVersion) {
+    return false;
+  }
+  reader.read<uint16_t>();
+
+  while (!reader.failed() && !reader.done()) {
+    TraceRecord record;
+    record.kind = static_cast<TraceRecordKind>(reader.read<uint8_t>());
+    switch (record.kind) {
+    case TraceRecordKind::Name: {
+      uint16_t index = reader.read<uint16_t>();
+      if (names.size() <= index) {
+        names.resize(index + 1);
+      }
+      reader.readBytes(names[index], reader.read<uint16_t>());
+      continue;
+    }
+    case TraceRecordKind::Call: {
+      record.name = reader.read<uint16_t>();
+      if (record.name >= names.size() || !reader.readValue(record.self, 0)) {
+        return false;
+      }
+      record.args.resize(reader.read<uint8_t>());
+      for (TraceValue &arg : record.args) {
+        if (!reader.readValue(arg, 0)) {
+          return false;
+        }
+      }
+      break;
+    }
+    case TraceRecordKind::NodeCreated:
+      record.id = reader.read<uint32_t>();
+      record.configId = reader.read<uint32_t>();
+      break;
+    case TraceRecordKind::ConfigCreated:
+      record.id = reader.read<uint32_t>();
+      break;
+    case TraceRecordKind::Measure:
+      record.id = reader.read<uint32_t>();
+      record.availableWidth = reader.read<float>();
+      record.widthMode = reader.read<uint8_t>();
+      record.availableHeight = reader.read<float>();
+      record.heightMode = reader.read<uint8_t>();
+      record.width = reader.read<float>();
+      record.height = reader.read<float>();
+      break;
+    default:
+      return false;
+    }
+    records.push_back(std::move(record));
+  }
+  return !reader.failed();
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Binary traces of binding calls, recorded by `Yoga.startRecording` and
+// replayed by yoga_replay. Little-endian:
+//
+//   header:  "YGTR" | u16 version | u16 reserved
+//   record:  u8 kind | payload
+//
+//   name:          u16 index | u16 length | bytes
+//   call:          u16 name index | value this | u8 argc | value...
+//   node created:  u32 node id | u32 config id (0 for the default config)
+//   config created: u32 config id
+//   measure:       u32 node id | f32 available width | u8 width mode |
+//                  f32 available height | u8 height mode | f32 width |
+//                  f32 height
+//
+//   value:   u8 type | payload, see TraceValue
+//
+// Function names are interned: a name record precedes the first call that
+// uses it. Nodes are identified by their registry id, which is reused after a
+// node is freed; configs get ids of their own. Node creations and measure
+// results are recorded as they happen, so they follow the call that caused
+// them.
+
+constexpr uint16_t kCallTraceVersion = 1;
+
+enum class TraceRecordKind : uint8_t {
+  Name = 0,
+  Call = 1,
+  NodeCreated = 2,
+  ConfigCreated = 3,
+  Measure = 4,
+};
+
+struct TraceValue {
+  enum Type : uint8_t {
+    Undefined = 0,
+    Null = 1,
+    Number = 2,   // f64
+    Bool = 3,     // u8
+    String = 4,   // u32 length | bytes
+    Node = 5,     // u32 id
+    Config = 6,   // u32 id
+    Function = 7, // no payload
+    Buffer = 8,   // u32 length | bytes
+    Array = 9,    // u32 count | value...
+    Other = 10,   // no payload
+  };
+
+  Type type = Undefined;
+  double number = 0;
+  uint32_t id = 0;
+  std::string bytes;
+  std::vector<TraceValue> elements;
+};
+
+struct TraceRecord {
+  TraceRecordKind kind;
+  // Call, `name` indexes the names of the trace.
+  uint16_t name = 0;
+  TraceValue self;
+  std::vector<TraceValue> args;
+  // NodeCreated, ConfigCreated and Measure
+  uint32_t id = 0;
+  uint32_t configId = 0;
+  // Measure, the constraints and the measured size.
+  float availableWidth = 0;
+  uint8_t widthMode = 0;
+  float availableHeight = 0;
+  uint8_t heightMode = 0;
+  float width = 0;
+  float height = 0;
+};
+
+class TraceWriter {
+public:
+  TraceWriter();
+
+  void writeCall(const char *name, TraceValue const &self,
+                 std::vector<TraceValue> const &args);
+  void writeNodeCreated(uint32_t id, uint32_t configId);
+  void writeConfigCreated(uint32_t id);
+  void writeMeasure(uint32_t id, float availableWidth, uint8_t widthMode,
+                    float availableHeight, uint8_t heightMode, float width,
+                    float height);
+
+  std::vector<uint8_t> const &data() const { return out_; }
+
+private:
+  template <typename T> void write(T value);
+  void writeValue(TraceValue const &value);
+
+  std::vector<uint8_t> out_;
+  std::unordered_map<const char *, uint16_t> names_;
+};
+
+// Parses a trace into its records and the function names they refer to.
+// Returns false if the trace is truncated or malformed.
+bool readCallTrace(const uint8_t *data, size_t size,
+                   std::vector<std::string> &names,
+                   std::vector<TraceRecord> &records);
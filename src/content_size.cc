@@ -0,0 +1,66 @@
+#include "content_size.h"
+#include "node_context.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include <algorithm>
+#include <vector>
+
+void updateContentExtents(YGNodeRef root, bool full) {
+  // Nodes to update are collected parents first, then updated in reverse so
+  // that every child is done before its parent.
+  std::vector<YGNodeRef> pending;
+  std::vector<YGNodeRef> stack = {root};
+  while (!stack.empty()) {
+    YGNodeRef node = stack.back();
+    stack.pop_back();
+    if (!full && nodeContext(node)->hasContentExtent &&
+        !YGNodeGetHasNewLayout(node)) {
+      continue;
+    }
+    pending.push_back(node);
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      stack.push_back(YGNodeGetChild(node, i));
+    }
+  }
+
+  for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+    YGNodeRef node = *it;
+    float right = 0, bottom = 0;
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      YGNodeRef child = YGNodeGetChild(node, i);
+      if (YGNodeStyleGetDisplay(child) == YGDisplayNone) {
+        continue;
+      }
+      float childRight = YGNodeLayoutGetWidth(child) +
+                         YGNodeLayoutGetMargin(child, YGEdgeRight);
+      float childBottom = YGNodeLayoutGetHeight(child) +
+                          YGNodeLayoutGetMargin(child, YGEdgeBottom);
+      if (YGNodeStyleGetOverflow(child) == YGOverflowVisible) {
+        NodeContext *childCtx = nodeContext(child);
+        childRight = std::max(childRight, childCtx->contentRight);
+        childBottom = std::max(childBottom, childCtx->contentBottom);
+      }
+      right = std::max(right, YGNodeLayoutGetLeft(child) + childRight);
+      bottom = std::max(bottom, YGNodeLayoutGetTop(child) + childBottom);
+    }
+    NodeContext *ctx = nodeContext(node);
+    ctx->contentRight = right;
+    ctx->contentBottom = bottom;
+    ctx->hasContentExtent = true;
+  }
+}
+
+YGSize contentSize(YGNodeConstRef node) {
+  NodeContext *ctx = nodeContext(node);
+  float borderLeft = YGNodeLayoutGetBorder(node, YGEdgeLeft);
+  float borderTop = YGNodeLayoutGetBorder(node, YGEdgeTop);
+  float width = YGNodeLayoutGetWidth(node) - borderLeft -
+                YGNodeLayoutGetBorder(node, YGEdgeRight);
+  float height = YGNodeLayoutGetHeight(node) - borderTop -
+                 YGNodeLayoutGetBorder(node, YGEdgeBottom);
+  width = std::max(width, ctx->contentRight - borderLeft +
+                              YGNodeLayoutGetPadding(node, YGEdgeRight));
+  height = std::max(height, ctx->contentBottom - borderTop +
+                                YGNodeLayoutGetPadding(node, YGEdgeBottom));
+  return {width, height};
+}
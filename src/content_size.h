@@ -0,0 +1,19 @@
+#pragma once
+
+#include "yoga/YGNode.h"
+
+// Scrollable content sizes. The content of a node is the union of the margin
+// boxes of everything below it, where nodes with hidden or scroll overflow
+// cut off their own descendants. Its extent, the right and bottom edges of
+// that union relative to the node's border box, is kept in the NodeContext
+// of every node. Content before the start of a node can't be scrolled to and
+// is left out.
+
+// Recomputes the content extents under `root` after a layout. Unless `full`,
+// subtrees Yoga didn't lay out again keep the extents from the last call.
+void updateContentExtents(YGNodeRef root, bool full);
+
+// The size of the scrollable area of `node` from its content extent: the
+// union of its padding box and its content plus end padding, measured from
+// the top left corner of the padding box.
+YGSize contentSize(YGNodeConstRef node);
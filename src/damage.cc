@@ -0,0 +1,131 @@
+#include "damage.h"
+#include "node_context.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include <limits>
+
+namespace {
+
+constexpr size_t kMaxDamageRects = 8;
+
+bool touches(LayoutRect const &a, LayoutRect const &b) {
+  return a.left <= b.right && b.left <= a.right && a.top <= b.bottom &&
+         b.top <= a.bottom;
+}
+
+bool contains(LayoutRect const &outer, LayoutRect const &inner) {
+  return outer.left <= inner.left && outer.top <= inner.top &&
+         inner.right <= outer.right && inner.bottom <= outer.bottom;
+}
+
+float area(LayoutRect const &rect) {
+  return (rect.right - rect.left) * (rect.bottom - rect.top);
+}
+
+bool sameRect(LayoutRect const &a, LayoutRect const &b) {
+  return a.left == b.left && a.top == b.top && a.right == b.right &&
+         a.bottom == b.bottom;
+}
+
+} // namespace
+
+void DamageRegion::add(LayoutRect rect) {
+  if (rect.isEmpty()) {
+    return;
+  }
+  for (LayoutRect const &existing : rects_) {
+    if (contains(existing, rect)) {
+      return;
+    }
+  }
+  // A grown rect may touch rects it missed before, so start over after each
+  // merge.
+  for (size_t i = 0; i < rects_.size();) {
+    if (touches(rects_[i], rect)) {
+      rect = rect.unite(rects_[i]);
+      rects_[i] = rects_.back();
+      rects_.pop_back();
+      i = 0;
+    } else {
+      i++;
+    }
+  }
+  rects_.push_back(rect);
+  if (rects_.size() <= kMaxDamageRects) {
+    return;
+  }
+
+  size_t first = 0, second = 1;
+  float leastGrowth = std::numeric_limits<float>::infinity();
+  for (size_t i = 0; i < rects_.size(); i++) {
+    for (size_t j = i + 1; j < rects_.size(); j++) {
+      float growth = area(rects_[i].unite(rects_[j])) - area(rects_[i]) -
+                     area(rects_[j]);
+      if (growth < leastGrowth) {
+        leastGrowth = growth;
+        first = i;
+        second = j;
+      }
+    }
+  }
+  LayoutRect merged = rects_[first].unite(rects_[second]);
+  rects_.erase(rects_.begin() + second);
+  rects_.erase(rects_.begin() + first);
+  add(merged);
+}
+
+void collectDamage(YGNodeRef root, DamageRegion *region) {
+  struct Pending {
+    YGNodeRef node;
+    float originX;
+    float originY;
+    // Whether the origin moved since the previous call.
+    bool moved;
+  };
+
+  std::vector<Pending> stack = {{root, 0, 0, region == NULL}};
+  while (!stack.empty()) {
+    Pending pending = stack.back();
+    stack.pop_back();
+    YGNodeRef node = pending.node;
+    if (!pending.moved && !YGNodeGetHasNewLayout(node)) {
+      continue;
+    }
+    NodeContext *ctx = nodeContext(node);
+    if (YGNodeStyleGetDisplay(node) == YGDisplayNone) {
+      if (region != NULL && ctx->hasDamageFrame) {
+        region->add(ctx->damageFrame);
+      }
+      ctx->hasDamageFrame = false;
+      continue;
+    }
+
+    float left = pending.originX + YGNodeLayoutGetLeft(node);
+    float top = pending.originY + YGNodeLayoutGetTop(node);
+    LayoutRect frame = {left, top, left + YGNodeLayoutGetWidth(node),
+                        top + YGNodeLayoutGetHeight(node)};
+    LayoutRect const &previous = ctx->damageFrame;
+    bool moved = region == NULL || !ctx->hasDamageFrame ||
+                 left != previous.left || top != previous.top;
+    if (region != NULL && (moved || !sameRect(frame, previous))) {
+      if (ctx->hasDamageFrame) {
+        region->add(previous);
+      }
+      region->add(frame);
+    }
+    ctx->damageFrame = frame;
+    ctx->hasDamageFrame = true;
+
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      stack.push_back({YGNodeGetChild(node, i), left, top, moved});
+    }
+  }
+}
+
+void forgetDamageFrame(YGNodeRef node, DamageRegion &region) {
+  NodeContext *ctx = nodeContext(node);
+  if (ctx->hasDamageFrame) {
+    region.add(ctx->damageFrame);
+    ctx->hasDamageFrame = false;
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "spatial_index.h"
+#include "yoga/YGNode.h"
+#include <vector>
+
+// A few rects covering every area added to them. A new rect absorbs the ones
+// it overlaps or touches; past the limit, the two rects whose union adds the
+// least area are merged.
+class DamageRegion {
+public:
+  void add(LayoutRect rect);
+  void clear() { rects_.clear(); }
+  std::vector<LayoutRect> const &rects() const { return rects_; }
+
+private:
+  std::vector<LayoutRect> rects_;
+};
+
+// Compares the absolute frame of every node under `root` with the one recorded
+// for it by the previous call, and adds both to `region` where they differ.
+// Frames are relative to the parent of `root`. Subtrees that Yoga didn't lay
+// out again and that didn't move are skipped. Without a region, frames are
+// only recorded.
+void collectDamage(YGNodeRef root, DamageRegion *region);
+
+// Adds the recorded frame of a node leaving the tree to `region`.
+void forgetDamageFrame(YGNodeRef node, DamageRegion &region);
@@ -0,0 +1,119 @@
+#include "intrinsic_sizes.h"
+#include "layout_cache.h"
+#include "node_context.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include "yoga/node/Node.h"
+#include <algorithm>
+#include <vector>
+
+using facebook::yoga::resolveRef;
+
+namespace {
+
+// Copies the subtree under `root`, appending the copies to `copies` in
+// preorder. Copies get a scratch NodeContext that only carries what measure
+// functions read, the JS wrapper and the measure preset, so measuring them
+// leaves the measurements and predictions of the original alone. Without an
+// id they aren't recorded in call traces either. They never report being
+// dirtied.
+YGNodeRef copySubtree(YGNodeRef root, std::vector<YGNodeRef> &copies) {
+  struct Pending {
+    YGNodeRef original;
+    YGNodeRef parent;
+    size_t index;
+  };
+
+  YGNodeRef rootCopy = NULL;
+  std::vector<Pending> stack = {{root, NULL, 0}};
+  while (!stack.empty()) {
+    Pending pending = stack.back();
+    stack.pop_back();
+    YGNodeRef copy = YGNodeClone(pending.original);
+    NodeContext *original = nodeContext(pending.original);
+    NodeContext *scratch = new NodeContext();
+    scratch->ref = original->ref;
+    scratch->measurePreset = original->measurePreset;
+    YGNodeSetContext(copy, scratch);
+    YGNodeSetDirtiedFunc(copy, NULL);
+    copies.push_back(copy);
+    if (pending.parent == NULL) {
+      rootCopy = copy;
+    } else {
+      resolveRef(pending.parent)->replaceChild(resolveRef(copy), pending.index);
+      resolveRef(copy)->setOwner(resolveRef(pending.parent));
+    }
+    for (size_t i = YGNodeGetChildCount(pending.original); i > 0; i--) {
+      stack.push_back({YGNodeGetChild(pending.original, i - 1), copy, i - 1});
+    }
+  }
+  return rootCopy;
+}
+
+// The right edge of everything in flow under `node`, relative to its left.
+float contentRight(YGNodeConstRef node) {
+  float right = YGNodeLayoutGetWidth(node);
+  float inset = YGNodeLayoutGetPadding(node, YGEdgeRight) +
+                YGNodeLayoutGetBorder(node, YGEdgeRight);
+  for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+    YGNodeConstRef child = YGNodeGetChild((YGNodeRef)node, i);
+    if (YGNodeStyleGetDisplay(child) == YGDisplayNone ||
+        YGNodeStyleGetPositionType(child) == YGPositionTypeAbsolute) {
+      continue;
+    }
+    right = std::max(right, YGNodeLayoutGetLeft(child) + contentRight(child) +
+                                YGNodeLayoutGetMargin(child, YGEdgeRight) +
+                                inset);
+  }
+  return right;
+}
+
+IntrinsicSizes computeIntrinsicSizes(YGNodeRef node) {
+  // The copy is laid out as the only child of a container that hands it the
+  // width under test as an upper bound.
+  std::vector<YGNodeRef> copies;
+  YGNodeRef copy = copySubtree(node, copies);
+  YGNodeStyleSetPositionType(copy, YGPositionTypeRelative);
+  YGNodeStyleSetAlignSelf(copy, YGAlignFlexStart);
+  YGNodeRef container = YGNodeNewWithConfig(YGNodeGetConfig(node));
+  YGNodeStyleSetAlignItems(container, YGAlignFlexStart);
+  YGNodeInsertChild(container, copy, 0);
+
+  IntrinsicSizes sizes;
+  YGNodeCalculateLayout(container, YGUndefined, YGUndefined, YGDirectionLTR);
+  sizes.maxContentWidth = YGNodeLayoutGetWidth(copy);
+  sizes.maxContentHeight = YGNodeLayoutGetHeight(copy);
+
+  YGNodeStyleSetWidth(container, 0);
+  YGNodeCalculateLayout(container, YGUndefined, YGUndefined, YGDirectionLTR);
+  sizes.minContentWidth = std::min(contentRight(copy), sizes.maxContentWidth);
+
+  YGNodeStyleSetWidth(container, sizes.minContentWidth);
+  YGNodeCalculateLayout(container, YGUndefined, YGUndefined, YGDirectionLTR);
+  sizes.minContentHeight = YGNodeLayoutGetHeight(copy);
+
+  for (YGNodeRef each : copies) {
+    delete nodeContext(each);
+    YGNodeFinalize(each);
+  }
+  YGNodeFinalize(container);
+  return sizes;
+}
+
+} // namespace
+
+IntrinsicSizes const &intrinsicSizes(YGNodeRef node) {
+  NodeContext *ctx = nodeContext(node);
+  uint64_t hash;
+  hashSubtree(node, hash);
+  if (ctx->hasIntrinsicSizes && ctx->intrinsicSizesHash == hash &&
+      !YGNodeIsDirty(node)) {
+    return ctx->intrinsicSizes;
+  }
+  ctx->intrinsicSizes = computeIntrinsicSizes(node);
+  // A dirty node isn't told about further changes, so its sizes can't be
+  // kept.
+  ctx->hasIntrinsicSizes = !YGNodeIsDirty(node);
+  ctx->intrinsicSizesHash = hash;
+  return ctx->intrinsicSizes;
+}
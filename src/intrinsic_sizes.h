@@ -0,0 +1,23 @@
+#pragma once
+
+#include "yoga/YGNode.h"
+
+// Min-content and max-content widths of a subtree, with its heights at those
+// widths.
+//
+// Max-content is the width the subtree takes when nothing constrains it.
+// Min-content is the narrowest it can be laid out without its content
+// overflowing: the subtree is offered no width at all, text wraps as far as
+// it can, and whatever sticks out is measured. Both are computed on a copy of
+// the subtree, which starts from the measurement caches of the original, so
+// the original layout is left alone.
+struct IntrinsicSizes {
+  float minContentWidth;
+  float minContentHeight;
+  float maxContentWidth;
+  float maxContentHeight;
+};
+
+// Returns the intrinsic sizes of `node`. They are kept in its NodeContext
+// while the node stays clean and its subtree hash is unchanged.
+IntrinsicSizes const &intrinsicSizes(YGNodeRef node);
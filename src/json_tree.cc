@@ -0,0 +1,642 @@
+#include "json_tree.h"
+#include "yoga/YGNodeStyle.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// Trees are parsed recursively, so nesting is bounded to stay well within the
+// stack of a worker thread.
+constexpr size_t kMaxDepth = 256;
+
+struct Scalar {
+  enum Kind { Null, Bool, Number, String, Other } kind = Null;
+  bool boolean = false;
+  double number = 0;
+  std::string string;
+};
+
+struct Length {
+  YGUnit unit;
+  float value;
+};
+
+bool toLength(Scalar const &scalar, Length &length) {
+  switch (scalar.kind) {
+  case Scalar::Null:
+    length = {YGUnitUndefined, YGUndefined};
+    return true;
+  case Scalar::Number:
+    length = {YGUnitPoint, (float)scalar.number};
+    return true;
+  case Scalar::String:
+    break;
+  default:
+    return false;
+  }
+  std::string const &text = scalar.string;
+  if (text == "auto") {
+    length = {YGUnitAuto, YGUndefined};
+    return true;
+  }
+  if (text.size() < 2 || text.back() != '%') {
+    return false;
+  }
+  char *end = NULL;
+  double value = std::strtod(text.c_str(), &end);
+  if (end != text.c_str() + text.size() - 1) {
+    return false;
+  }
+  length = {YGUnitPercent, (float)value};
+  return true;
+}
+
+// Looks up an enum value by the name Yoga gives it.
+template <typename T>
+bool toEnum(std::string const &name, const char *(*toString)(T), T &value) {
+  for (int i = 0; i < 32; i++) {
+    const char *candidate = toString(static_cast<T>(i));
+    if (std::strcmp(candidate, "unknown") == 0) {
+      break;
+    }
+    if (name == candidate) {
+      value = static_cast<T>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename T, const char *(*toString)(T), void (*set)(YGNodeRef, T)>
+bool applyEnum(YGNodeRef node, Scalar const &scalar) {
+  T value;
+  if (scalar.kind != Scalar::String ||
+      !toEnum(scalar.string, toString, value)) {
+    return false;
+  }
+  set(node, value);
+  return true;
+}
+
+template <void (*set)(YGNodeRef, float)>
+bool applyNumber(YGNodeRef node, Scalar const &scalar) {
+  if (scalar.kind == Scalar::Null) {
+    set(node, YGUndefined);
+    return true;
+  }
+  if (scalar.kind != Scalar::Number) {
+    return false;
+  }
+  set(node, (float)scalar.number);
+  return true;
+}
+
+struct ScalarProperty {
+  const char *name;
+  bool (*apply)(YGNodeRef, Scalar const &);
+};
+
+const ScalarProperty kScalarProperties[] = {
+    {"direction", applyEnum<YGDirection, YGDirectionToString,
+                            YGNodeStyleSetDirection>},
+    {"flexDirection", applyEnum<YGFlexDirection, YGFlexDirectionToString,
+                                YGNodeStyleSetFlexDirection>},
+    {"justifyContent",
+     applyEnum<YGJustify, YGJustifyToString, YGNodeStyleSetJustifyContent>},
+    {"alignContent",
+     applyEnum<YGAlign, YGAlignToString, YGNodeStyleSetAlignContent>},
+    {"alignItems",
+     applyEnum<YGAlign, YGAlignToString, YGNodeStyleSetAlignItems>},
+    {"alignSelf", applyEnum<YGAlign, YGAlignToString, YGNodeStyleSetAlignSelf>},
+    {"positionType", applyEnum<YGPositionType, YGPositionTypeToString,
+                               YGNodeStyleSetPositionType>},
+    {"flexWrap", applyEnum<YGWrap, YGWrapToString, YGNodeStyleSetFlexWrap>},
+    {"overflow",
+     applyEnum<YGOverflow, YGOverflowToString, YGNodeStyleSetOverflow>},
+    {"display", applyEnum<YGDisplay, YGDisplayToString, YGNodeStyleSetDisplay>},
+    {"flex", applyNumber<YGNodeStyleSetFlex>},
+    {"flexGrow", applyNumber<YGNodeStyleSetFlexGrow>},
+    {"flexShrink", applyNumber<YGNodeStyleSetFlexShrink>},
+    {"aspectRatio", applyNumber<YGNodeStyleSetAspectRatio>},
+};
+
+// Setters of a length; those a property doesn't support are NULL.
+struct LengthProperty {
+  const char *name;
+  void (*point)(YGNodeRef, float);
+  void (*percent)(YGNodeRef, float);
+  void (*setAuto)(YGNodeRef);
+};
+
+const LengthProperty kLengthProperties[] = {
+    {"width", YGNodeStyleSetWidth, YGNodeStyleSetWidthPercent,
+     YGNodeStyleSetWidthAuto},
+    {"height", YGNodeStyleSetHeight, YGNodeStyleSetHeightPercent,
+     YGNodeStyleSetHeightAuto},
+    {"minWidth", YGNodeStyleSetMinWidth, YGNodeStyleSetMinWidthPercent, NULL},
+    {"minHeight", YGNodeStyleSetMinHeight, YGNodeStyleSetMinHeightPercent,
+     NULL},
+    {"maxWidth", YGNodeStyleSetMaxWidth, YGNodeStyleSetMaxWidthPercent, NULL},
+    {"maxHeight", YGNodeStyleSetMaxHeight, YGNodeStyleSetMaxHeightPercent,
+     NULL},
+    {"flexBasis", YGNodeStyleSetFlexBasis, YGNodeStyleSetFlexBasisPercent,
+     YGNodeStyleSetFlexBasisAuto},
+};
+
+bool applyLength(YGNodeRef node, LengthProperty const &property,
+                 Length const &length) {
+  switch (length.unit) {
+  case YGUnitUndefined:
+  case YGUnitPoint:
+    property.point(node, length.value);
+    return true;
+  case YGUnitPercent:
+    if (property.percent == NULL) {
+      return false;
+    }
+    property.percent(node, length.value);
+    return true;
+  case YGUnitAuto:
+    if (property.setAuto == NULL) {
+      return false;
+    }
+    property.setAuto(node);
+    return true;
+  }
+  return false;
+}
+
+struct EdgeProperty {
+  const char *name;
+  void (*point)(YGNodeRef, YGEdge, float);
+  void (*percent)(YGNodeRef, YGEdge, float);
+  void (*setAuto)(YGNodeRef, YGEdge);
+};
+
+const EdgeProperty kEdgeProperties[] = {
+    {"margin", YGNodeStyleSetMargin, YGNodeStyleSetMarginPercent,
+     YGNodeStyleSetMarginAuto},
+    {"padding", YGNodeStyleSetPadding, YGNodeStyleSetPaddingPercent, NULL},
+    {"border", YGNodeStyleSetBorder, NULL, NULL},
+    {"position", YGNodeStyleSetPosition, YGNodeStyleSetPositionPercent,
+     YGNodeStyleSetPositionAuto},
+};
+
+bool applyEdge(YGNodeRef node, EdgeProperty const &property, YGEdge edge,
+               Length const &length) {
+  switch (length.unit) {
+  case YGUnitUndefined:
+  case YGUnitPoint:
+    property.point(node, edge, length.value);
+    return true;
+  case YGUnitPercent:
+    if (property.percent == NULL) {
+      return false;
+    }
+    property.percent(node, edge, length.value);
+    return true;
+  case YGUnitAuto:
+    if (property.setAuto == NULL) {
+      return false;
+    }
+    property.setAuto(node, edge);
+    return true;
+  }
+  return false;
+}
+
+bool applyGap(YGNodeRef node, YGGutter gutter, Length const &length) {
+  switch (length.unit) {
+  case YGUnitUndefined:
+  case YGUnitPoint:
+    YGNodeStyleSetGap(node, gutter, length.value);
+    return true;
+  case YGUnitPercent:
+    YGNodeStyleSetGapPercent(node, gutter, length.value);
+    return true;
+  default:
+    return false;
+  }
+}
+
+struct PresetProperty {
+  const char *name;
+  MeasurePreset preset;
+  // Values that have to be given.
+  size_t required;
+};
+
+const PresetProperty kPresetProperties[] = {
+    {"intrinsicSize", {MeasurePreset::IntrinsicSize, {}}, 2},
+    {"aspectMeasure", {MeasurePreset::AspectRatio, {0, 0, INFINITY}}, 1},
+    {"clampMeasure", {MeasurePreset::Clamp, {0, 0, INFINITY, INFINITY}}, 0},
+};
+
+class Parser {
+public:
+  Parser(std::string_view json, YGConfigConstRef config,
+         std::vector<YGNodeRef> &nodes, std::deque<MeasurePreset> &presets)
+      : json_(json), config_(config), nodes_(nodes), presets_(presets) {}
+
+  bool parse(std::string &error) {
+    parseNode(0);
+    skipSpace();
+    if (!failed_ && pos_ != json_.size()) {
+      fail("unexpected trailing characters");
+    }
+    if (failed_) {
+      error = error_ + " at offset " + std::to_string(errorPos_);
+    }
+    return !failed_;
+  }
+
+private:
+  void fail(std::string message) {
+    if (!failed_) {
+      failed_ = true;
+      error_ = std::move(message);
+      errorPos_ = pos_;
+    }
+  }
+
+  void skipSpace() {
+    while (pos_ < json_.size() &&
+           (json_[pos_] == ' ' || json_[pos_] == '\t' ||
+            json_[pos_] == '\r' || json_[pos_] == '\n')) {
+      pos_++;
+    }
+  }
+
+  char peek() {
+    skipSpace();
+    return pos_ < json_.size() ? json_[pos_] : '\0';
+  }
+
+  bool consume(char c) {
+    if (peek() != c) {
+      return false;
+    }
+    pos_++;
+    return true;
+  }
+
+  bool consumeWord(const char *word) {
+    size_t length = std::strlen(word);
+    if (json_.substr(pos_, length) != word) {
+      return false;
+    }
+    pos_ += length;
+    return true;
+  }
+
+  // Calls `member` for each key of an object, positioned at its value, which
+  // `member` has to consume.
+  template <typename Fn> void parseObject(Fn member) {
+    if (!consume('{')) {
+      fail("expected an object");
+      return;
+    }
+    if (consume('}')) {
+      return;
+    }
+    do {
+      std::string key;
+      if (peek() != '"' || !parseString(key)) {
+        fail("expected a key");
+        return;
+      }
+      if (!consume(':')) {
+        fail("expected ':'");
+        return;
+      }
+      member(key);
+      if (failed_) {
+        return;
+      }
+    } while (consume(','));
+    if (!consume('}')) {
+      fail("expected ',' or '}'");
+    }
+  }
+
+  template <typename Fn> void parseArray(Fn element) {
+    if (!consume('[')) {
+      fail("expected an array");
+      return;
+    }
+    if (consume(']')) {
+      return;
+    }
+    do {
+      element();
+      if (failed_) {
+        return;
+      }
+    } while (consume(','));
+    if (!consume(']')) {
+      fail("expected ',' or ']'");
+    }
+  }
+
+  bool parseString(std::string &out) {
+    pos_++;
+    while (pos_ < json_.size()) {
+      char c = json_[pos_++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (pos_ >= json_.size()) {
+        break;
+      }
+      switch (char escape = json_[pos_++]) {
+      case 'b':
+        out += '\b';
+        break;
+      case 'f':
+        out += '\f';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'u': {
+        if (pos_ + 4 > json_.size()) {
+          return false;
+        }
+        std::string hex(json_.substr(pos_, 4));
+        char *end = NULL;
+        unsigned long code = std::strtoul(hex.c_str(), &end, 16);
+        if (end != hex.c_str() + 4) {
+          return false;
+        }
+        pos_ += 4;
+        appendUtf8(out, code);
+        break;
+      }
+      default:
+        out += escape;
+      }
+    }
+    return false;
+  }
+
+  static void appendUtf8(std::string &out, unsigned long code) {
+    if (code < 0x80) {
+      out += (char)code;
+    } else if (code < 0x800) {
+      out += (char)(0xC0 | (code >> 6));
+      out += (char)(0x80 | (code & 0x3F));
+    } else {
+      out += (char)(0xE0 | (code >> 12));
+      out += (char)(0x80 | ((code >> 6) & 0x3F));
+      out += (char)(0x80 | (code & 0x3F));
+    }
+  }
+
+  bool parseNumber(double &out) {
+    size_t start = pos_;
+    while (pos_ < json_.size() && json_[pos_] != '\0' &&
+           std::strchr("+-.0123456789eE", json_[pos_]) != NULL) {
+      pos_++;
+    }
+    std::string text(json_.substr(start, pos_ - start));
+    char *end = NULL;
+    out = std::strtod(text.c_str(), &end);
+    return !text.empty() && end == text.c_str() + text.size();
+  }
+
+  // Parses any value; objects and arrays are skipped and reported as Other.
+  Scalar parseScalar(size_t depth) {
+    Scalar scalar;
+    char c = peek();
+    if (c == '"') {
+      scalar.kind = Scalar::String;
+      if (!parseString(scalar.string)) {
+        fail("malformed string");
+      }
+    } else if (c == '{' || c == '[') {
+      scalar.kind = Scalar::Other;
+      skipValue(depth);
+    } else if (consumeWord("null")) {
+      scalar.kind = Scalar::Null;
+    } else if (consumeWord("true")) {
+      scalar.kind = Scalar::Bool;
+      scalar.boolean = true;
+    } else if (consumeWord("false")) {
+      scalar.kind = Scalar::Bool;
+    } else {
+      scalar.kind = Scalar::Number;
+      if (!parseNumber(scalar.number)) {
+        fail("malformed value");
+      }
+    }
+    return scalar;
+  }
+
+  void skipValue(size_t depth) {
+    if (depth > kMaxDepth) {
+      fail("document is nested too deeply");
+      return;
+    }
+    char c = peek();
+    if (c == '{') {
+      parseObject([&](std::string const &) { skipValue(depth + 1); });
+    } else if (c == '[') {
+      parseArray([&] { skipValue(depth + 1); });
+    } else {
+      parseScalar(depth);
+    }
+  }
+
+  Length parseLength(std::string const &name, size_t depth) {
+    Length length = {YGUnitUndefined, YGUndefined};
+    Scalar scalar = parseScalar(depth);
+    if (!failed_ && !toLength(scalar, length)) {
+      fail("invalid length for \"" + name + "\"");
+    }
+    return length;
+  }
+
+  void parseEdges(YGNodeRef node, EdgeProperty const &property,
+                  size_t depth) {
+    if (peek() != '{') {
+      Length length = parseLength(property.name, depth);
+      if (!failed_ && !applyEdge(node, property, YGEdgeAll, length)) {
+        fail(std::string("unsupported unit for \"") + property.name + "\"");
+      }
+      return;
+    }
+    parseObject([&](std::string const &key) {
+      YGEdge edge;
+      if (!toEnum(key, YGEdgeToString, edge)) {
+        fail("unknown edge \"" + key + "\"");
+        return;
+      }
+      Length length = parseLength(property.name, depth);
+      if (!failed_ && !applyEdge(node, property, edge, length)) {
+        fail(std::string("unsupported unit for \"") + property.name + "\"");
+      }
+    });
+  }
+
+  void parseGap(YGNodeRef node, size_t depth) {
+    if (peek() != '{') {
+      Length length = parseLength("gap", depth);
+      if (!failed_ && !applyGap(node, YGGutterAll, length)) {
+        fail("unsupported unit for \"gap\"");
+      }
+      return;
+    }
+    parseObject([&](std::string const &key) {
+      YGGutter gutter;
+      if (!toEnum(key, YGGutterToString, gutter)) {
+        fail("unknown gutter \"" + key + "\"");
+        return;
+      }
+      Length length = parseLength("gap", depth);
+      if (!failed_ && !applyGap(node, gutter, length)) {
+        fail("unsupported unit for \"gap\"");
+      }
+    });
+  }
+
+  void parsePreset(YGNodeRef node, PresetProperty const &property,
+                   size_t depth) {
+    MeasurePreset preset = property.preset;
+    size_t count = 0;
+    parseArray([&] {
+      Scalar value = parseScalar(depth);
+      if (failed_) {
+        return;
+      }
+      if (count == 4 || (value.kind != Scalar::Number &&
+                         (value.kind != Scalar::Null ||
+                          count < property.required))) {
+        fail(std::string("invalid value for \"") + property.name + "\"");
+        return;
+      }
+      if (value.kind == Scalar::Number) {
+        preset.values[count] = value.number;
+      }
+      count++;
+    });
+    if (failed_) {
+      return;
+    }
+    if (count < property.required || !isValidMeasurePreset(preset)) {
+      fail(std::string("invalid value for \"") + property.name + "\"");
+      return;
+    }
+    if (YGNodeGetChildCount(node) > 0) {
+      fail("nodes with children cannot be measured");
+      return;
+    }
+    presets_.push_back(preset);
+    YGNodeSetContext(node, &presets_.back());
+    YGNodeSetMeasureFunc(node, &measureJsonPreset);
+  }
+
+  void parseProperty(YGNodeRef node, std::string const &key, size_t depth) {
+    if (key == "children") {
+      if (YGNodeHasMeasureFunc(node)) {
+        fail("nodes with children cannot be measured");
+        return;
+      }
+      parseArray([&] {
+        YGNodeRef child = parseNode(depth + 1);
+        if (child != NULL) {
+          YGNodeInsertChild(node, child, YGNodeGetChildCount(node));
+        }
+      });
+      return;
+    }
+    if (key == "gap") {
+      parseGap(node, depth);
+      return;
+    }
+    for (PresetProperty const &property : kPresetProperties) {
+      if (key == property.name) {
+        parsePreset(node, property, depth);
+        return;
+      }
+    }
+    for (EdgeProperty const &property : kEdgeProperties) {
+      if (key == property.name) {
+        parseEdges(node, property, depth);
+        return;
+      }
+    }
+    for (LengthProperty const &property : kLengthProperties) {
+      if (key == property.name) {
+        Length length = parseLength(key, depth);
+        if (!failed_ && !applyLength(node, property, length)) {
+          fail("unsupported unit for \"" + key + "\"");
+        }
+        return;
+      }
+    }
+    Scalar value = parseScalar(depth);
+    if (failed_) {
+      return;
+    }
+    for (ScalarProperty const &property : kScalarProperties) {
+      if (key == property.name) {
+        if (!property.apply(node, value)) {
+          fail("invalid value for \"" + key + "\"");
+        }
+        return;
+      }
+    }
+  }
+
+  YGNodeRef parseNode(size_t depth) {
+    if (depth > kMaxDepth) {
+      fail("tree is nested too deeply");
+      return NULL;
+    }
+    if (peek() != '{') {
+      fail("expected a node object");
+      return NULL;
+    }
+    YGNodeRef node = YGNodeNewWithConfig(config_);
+    nodes_.push_back(node);
+    parseObject(
+        [&](std::string const &key) { parseProperty(node, key, depth); });
+    return node;
+  }
+
+  std::string_view json_;
+  YGConfigConstRef config_;
+  std::vector<YGNodeRef> &nodes_;
+  std::deque<MeasurePreset> &presets_;
+  size_t pos_ = 0;
+  bool failed_ = false;
+  std::string error_;
+  size_t errorPos_ = 0;
+};
+
+} // namespace
+
+YGSize measureJsonPreset(YGNodeConstRef node, float width,
+                         YGMeasureMode widthMode, float height,
+                         YGMeasureMode heightMode) {
+  return measureWithPreset(*(MeasurePreset *)YGNodeGetContext(node), width,
+                           widthMode, height, heightMode);
+}
+
+bool parseJsonTree(std::string_view json, YGConfigConstRef config,
+                   std::vector<YGNodeRef> &nodes,
+                   std::deque<MeasurePreset> &presets, std::string &error) {
+  return Parser(json, config, nodes, presets).parse(error);
+}
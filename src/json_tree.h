@@ -0,0 +1,40 @@
+#pragma once
+
+#include "measure_preset.h"
+#include "yoga/YGConfig.h"
+#include "yoga/YGNode.h"
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Builds a tree from a JSON document. A node is an object of style properties
+// with an optional "children" array:
+//
+//   {"width": 300, "flexDirection": "row", "padding": {"horizontal": 8},
+//    "children": [{"flexGrow": 1, "margin": "5%"}, {"width": "auto"}]}
+//
+// Lengths are numbers (points), "<n>%", "auto" or null. Edge properties
+// (margin, padding, border, position) take a length for all edges or an object
+// keyed by Yoga's edge names, and gap works the same with "row", "column" and
+// "all". Enum values use Yoga's names, such as "space-between". Unknown
+// properties are ignored.
+//
+// Leaves can be measured with a preset, see measure_preset.h:
+// "intrinsicSize": [width, height], "aspectMeasure": [ratio, minWidth,
+// maxWidth] or "clampMeasure": [minWidth, minHeight, maxWidth, maxHeight].
+// Trailing bounds can be left out or null.
+//
+// Nodes are created with `config` and appended to `nodes` in preorder. Their
+// presets are kept in `presets`, which has to outlive them. Returns false and
+// sets `error` if the document is malformed; nodes created before the error
+// are still appended so the caller can free them.
+bool parseJsonTree(std::string_view json, YGConfigConstRef config,
+                   std::vector<YGNodeRef> &nodes,
+                   std::deque<MeasurePreset> &presets, std::string &error);
+
+// The measure function of those nodes, which answers with the preset their
+// context points to.
+YGSize measureJsonPreset(YGNodeConstRef node, float width,
+                         YGMeasureMode widthMode, float height,
+                         YGMeasureMode heightMode);
@@ -0,0 +1,204 @@
+#include "layout_cache.h"
+#include "node_context.h"
+#include "yoga/YGConfig.h"
+#include "yoga/node/Node.h"
+#include <cstring>
+
+namespace {
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+// Stored hashes are only trusted if they were computed in the current epoch.
+thread_local uint32_t hashEpoch = 1;
+
+uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+template <typename T> uint64_t mix(uint64_t hash, T value) {
+  return fnv1a(hash, &value, sizeof(T));
+}
+
+uint32_t floatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+bool hasTrustedHash(YGNodeConstRef node) {
+  NodeContext *ctx = nodeContext(node);
+  return ctx != NULL && ctx->subtreeHashEpoch == hashEpoch &&
+         !YGNodeIsDirty(node);
+}
+
+void collectPreorder(YGNodeRef root, std::vector<YGNodeRef> &out) {
+  std::vector<YGNodeRef> stack = {root};
+  while (!stack.empty()) {
+    YGNodeRef node = stack.back();
+    stack.pop_back();
+    out.push_back(node);
+    for (size_t i = YGNodeGetChildCount(node); i > 0; i--) {
+      stack.push_back(YGNodeGetChild(node, i - 1));
+    }
+  }
+}
+
+} // namespace
+
+uint64_t hashBytes(const void *data, size_t size) {
+  return fnv1a(kFnvOffset, data, size);
+}
+
+LayoutCacheKey layoutCacheKey(uint64_t subtreeHash, float width, float height,
+                              YGDirection direction) {
+  return {subtreeHash, floatBits(width), floatBits(height),
+          static_cast<uint32_t>(direction)};
+}
+
+bool hashSubtree(YGNodeRef root, uint64_t &hash) {
+  // Nodes without a trusted hash are collected parents first, then hashed in
+  // reverse so that every child is done before its parent.
+  std::vector<YGNodeRef> pending;
+  std::vector<YGNodeRef> stack = {root};
+  while (!stack.empty()) {
+    YGNodeRef node = stack.back();
+    stack.pop_back();
+    if (hasTrustedHash(node)) {
+      continue;
+    }
+    pending.push_back(node);
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      stack.push_back(YGNodeGetChild(node, i));
+    }
+  }
+
+  std::vector<uint8_t> style;
+  for (auto it = pending.rbegin(); it != pending.rend(); ++it) {
+    YGNodeRef node = *it;
+    NodeContext *ctx = nodeContext(node);
+    if (ctx == NULL) {
+      return false;
+    }
+    style.clear();
+    serializeStyle(node, style);
+    uint64_t nodeHash = hashBytes(style.data(), style.size());
+
+    YGConfigConstRef config = YGNodeGetConfig(node);
+    nodeHash = mix(nodeHash, YGConfigGetPointScaleFactor(config));
+    nodeHash = mix(nodeHash, static_cast<uint32_t>(YGConfigGetErrata(config)));
+    nodeHash = mix(nodeHash, YGConfigGetUseWebDefaults(config));
+    nodeHash = mix(nodeHash, YGConfigIsExperimentalFeatureEnabled(
+                                 config, YGExperimentalFeatureWebFlexBasis));
+    nodeHash = mix(nodeHash, static_cast<uint32_t>(YGNodeGetNodeType(node)));
+
+    bool cacheable = !YGNodeHasBaselineFunc(node);
+    bool hasMeasureFunc = YGNodeHasMeasureFunc(node);
+    nodeHash = mix(nodeHash, hasMeasureFunc);
+    if (hasMeasureFunc && ctx->measurePreset.kind != MeasurePreset::None) {
+      // Presets are answered from their values alone.
+      nodeHash = mix(nodeHash, ctx->measurePreset.kind);
+      for (float value : ctx->measurePreset.values) {
+        nodeHash = mix(nodeHash, floatBits(value));
+      }
+    } else if (hasMeasureFunc) {
+      cacheable = cacheable && ctx->hasMeasureCacheKey;
+      nodeHash = mix(nodeHash, ctx->measureCacheKey);
+    }
+
+    size_t count = YGNodeGetChildCount(node);
+    nodeHash = mix(nodeHash, static_cast<uint64_t>(count));
+    for (size_t i = 0; i < count; i++) {
+      NodeContext *child = nodeContext(YGNodeGetChild(node, i));
+      cacheable = cacheable && child->subtreeCacheable;
+      nodeHash = mix(nodeHash, child->subtreeHash);
+    }
+
+    ctx->subtreeHash = nodeHash;
+    ctx->subtreeCacheable = cacheable;
+    ctx->subtreeHashEpoch = hashEpoch;
+  }
+
+  NodeContext *ctx = nodeContext(root);
+  hash = ctx->subtreeHash;
+  return ctx->subtreeCacheable;
+}
+
+void invalidateSubtreeHash(YGNodeRef node) {
+  for (; node != NULL; node = YGNodeGetParent(node)) {
+    NodeContext *ctx = nodeContext(node);
+    if (ctx != NULL) {
+      ctx->subtreeHashEpoch = 0;
+    }
+  }
+}
+
+void invalidateAllSubtreeHashes() { hashEpoch++; }
+
+void LayoutCache::setCapacity(size_t capacity) {
+  capacity_ = capacity;
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+void LayoutCache::clear() {
+  entries_.clear();
+  index_.clear();
+  stats_ = {};
+}
+
+bool LayoutCache::apply(const LayoutCacheKey &key, YGNodeRef root) {
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    stats_.misses++;
+    return false;
+  }
+  const std::vector<LayoutRecord> &records = found->second->second;
+  std::vector<YGNodeRef> nodes;
+  collectPreorder(root, nodes);
+  if (nodes.size() != records.size()) {
+    stats_.misses++;
+    return false;
+  }
+  entries_.splice(entries_.begin(), entries_, found->second);
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    auto *node = facebook::yoga::resolveRef(nodes[i]);
+    // Yoga's own measurement caches describe whatever the node held before.
+    node->setLayout({});
+    restoreLayout(nodes[i], records[i]);
+    node->setDirty(false);
+    node->setHasNewLayout(true);
+  }
+  stats_.hits++;
+  return true;
+}
+
+void LayoutCache::store(const LayoutCacheKey &key, YGNodeRef root) {
+  if (capacity_ == 0) {
+    return;
+  }
+  std::vector<YGNodeRef> nodes;
+  collectPreorder(root, nodes);
+  std::vector<LayoutRecord> records;
+  records.reserve(nodes.size());
+  for (YGNodeRef node : nodes) {
+    records.push_back(captureLayout(node));
+  }
+
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    found->second->second = std::move(records);
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+  entries_.emplace_front(key, std::move(records));
+  index_.emplace(key, entries_.begin());
+  setCapacity(capacity_);
+}
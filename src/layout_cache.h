@@ -0,0 +1,83 @@
+#pragma once
+
+#include "snapshot.h"
+#include "yoga/YGNode.h"
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A finished layout is identified by the content hash of the laid out subtree
+// and the constraints its root was given. Constraints are compared bitwise so
+// that undefined (NaN) sizes match each other.
+struct LayoutCacheKey {
+  uint64_t subtreeHash;
+  uint32_t width;
+  uint32_t height;
+  uint32_t direction;
+
+  bool operator==(const LayoutCacheKey &other) const {
+    return subtreeHash == other.subtreeHash && width == other.width &&
+           height == other.height && direction == other.direction;
+  }
+};
+
+LayoutCacheKey layoutCacheKey(uint64_t subtreeHash, float width, float height,
+                              YGDirection direction);
+
+uint64_t hashBytes(const void *data, size_t size);
+
+// Hashes the styles, structure, config and measure cache keys of the subtree
+// under `root`. Hashes of clean nodes are kept in their NodeContext and reused,
+// so only the dirty path is rehashed. Returns false if the subtree has a JS
+// measure function without a cache key, as its layout can't be shared.
+bool hashSubtree(YGNodeRef root, uint64_t &hash);
+
+// Drops the stored hash of `node` and its ancestors, for changes that affect
+// layout without marking the node dirty.
+void invalidateSubtreeHash(YGNodeRef node);
+
+// Drops every stored hash, e.g. after a config was changed.
+void invalidateAllSubtreeHashes();
+
+struct LayoutCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+};
+
+// Bounded LRU map from LayoutCacheKey to the preorder layouts of a subtree.
+class LayoutCache {
+public:
+  size_t capacity() const { return capacity_; }
+  size_t size() const { return entries_.size(); }
+  const LayoutCacheStats &stats() const { return stats_; }
+
+  void setCapacity(size_t capacity);
+  void clear();
+
+  // Copies a cached layout onto the subtree under `root` and marks it clean.
+  // Returns false, leaving the subtree untouched, if there is no entry.
+  bool apply(const LayoutCacheKey &key, YGNodeRef root);
+
+  // Records the current layout of the subtree under `root`.
+  void store(const LayoutCacheKey &key, YGNodeRef root);
+
+private:
+  struct KeyHash {
+    size_t operator()(const LayoutCacheKey &key) const {
+      return key.subtreeHash ^ (size_t(key.width) << 1) ^ key.height ^
+             key.direction;
+    }
+  };
+  using Entry = std::pair<LayoutCacheKey, std::vector<LayoutRecord>>;
+
+  size_t capacity_ = 0;
+  std::list<Entry> entries_;
+  std::unordered_map<LayoutCacheKey, std::list<Entry>::iterator, KeyHash>
+      index_;
+  LayoutCacheStats stats_ = {};
+};
+
+extern thread_local LayoutCache layoutCache;
@@ -0,0 +1,102 @@
+#include "measure_preset.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float clampTo(float value, float min, float max) {
+  return std::max(min, std::min(value, max));
+}
+
+float measureFixed(float size, float offered, YGMeasureMode mode) {
+  switch (mode) {
+  case YGMeasureModeExactly:
+    return offered;
+  case YGMeasureModeAtMost:
+    return std::min(size, offered);
+  default:
+    return size;
+  }
+}
+
+// Without a usable bound, content takes its largest size.
+float measureClamped(float min, float max, float offered, YGMeasureMode mode) {
+  switch (mode) {
+  case YGMeasureModeExactly:
+    return offered;
+  case YGMeasureModeAtMost:
+    return clampTo(offered, min, max);
+  default:
+    return std::isfinite(max) ? max : min;
+  }
+}
+
+YGSize measureAspect(float ratio, float minWidth, float maxWidth, float width,
+                     YGMeasureMode widthMode, float height,
+                     YGMeasureMode heightMode) {
+  float measuredWidth;
+  if (widthMode == YGMeasureModeExactly) {
+    measuredWidth = width;
+  } else {
+    if (heightMode == YGMeasureModeExactly) {
+      measuredWidth = clampTo(height * ratio, minWidth, maxWidth);
+    } else {
+      measuredWidth = measureClamped(minWidth, maxWidth, width, widthMode);
+    }
+    if (widthMode == YGMeasureModeAtMost) {
+      measuredWidth = std::max(minWidth, std::min(measuredWidth, width));
+    }
+  }
+
+  if (heightMode == YGMeasureModeExactly) {
+    return {measuredWidth, height};
+  }
+  float measuredHeight = measuredWidth / ratio;
+  if (heightMode == YGMeasureModeAtMost && measuredHeight > height) {
+    measuredHeight = height;
+    if (widthMode != YGMeasureModeExactly) {
+      measuredWidth = std::max(minWidth, height * ratio);
+    }
+  }
+  return {measuredWidth, measuredHeight};
+}
+
+} // namespace
+
+bool isValidMeasurePreset(MeasurePreset const &preset) {
+  const float *values = preset.values;
+  switch (preset.kind) {
+  case MeasurePreset::None:
+    return true;
+  case MeasurePreset::IntrinsicSize:
+    return values[0] >= 0 && values[1] >= 0 && std::isfinite(values[0]) &&
+           std::isfinite(values[1]);
+  case MeasurePreset::AspectRatio:
+    return values[0] > 0 && std::isfinite(values[0]) && values[1] >= 0 &&
+           values[2] >= values[1];
+  case MeasurePreset::Clamp:
+    return values[0] >= 0 && values[1] >= 0 && values[2] >= values[0] &&
+           values[3] >= values[1];
+  default:
+    return false;
+  }
+}
+
+YGSize measureWithPreset(MeasurePreset const &preset, float width,
+                         YGMeasureMode widthMode, float height,
+                         YGMeasureMode heightMode) {
+  const float *values = preset.values;
+  switch (preset.kind) {
+  case MeasurePreset::IntrinsicSize:
+    return {measureFixed(values[0], width, widthMode),
+            measureFixed(values[1], height, heightMode)};
+  case MeasurePreset::AspectRatio:
+    return measureAspect(values[0], values[1], values[2], width, widthMode,
+                         height, heightMode);
+  case MeasurePreset::Clamp:
+    return {measureClamped(values[0], values[2], width, widthMode),
+            measureClamped(values[1], values[3], height, heightMode)};
+  default:
+    return {0, 0};
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "yoga/YGNode.h"
+#include <cstdint>
+
+// Measure functions answered natively from a few numbers, for leaves like
+// images and icons that don't need a JS round-trip to be measured.
+struct MeasurePreset {
+  enum Kind : uint8_t {
+    None,
+    // A fixed size: width, height.
+    IntrinsicSize,
+    // Width over height: ratio, min width, max width.
+    AspectRatio,
+    // The offered size within bounds: min width, min height, max width,
+    // max height.
+    Clamp,
+  };
+
+  Kind kind = None;
+  float values[4] = {};
+};
+
+// Sizes must be non-negative, intrinsic sizes and ratios finite, ratios
+// positive and maximums at least their minimums.
+bool isValidMeasurePreset(MeasurePreset const &preset);
+
+// Answers a measure request the way the preset describes. Exact constraints
+// are always honored, and at-most constraints are only exceeded by minimums.
+YGSize measureWithPreset(MeasurePreset const &preset, float width,
+                         YGMeasureMode widthMode, float height,
+                         YGMeasureMode heightMode);
@@ -1,6 +1,89 @@
 #pragma once
 
 #include "js_native_api.h"
+#include <algorithm>
+#include <cstdint>
+
+#ifdef YOGA_NODE_API_PROFILE
+#include <chrono>
+#include <unordered_map>
+#endif
+
+// The binding function running on this thread and a counter that changes with
+// every call, so side effects can be attributed to the call that caused them.
+// Maintained by the method headers below.
+inline thread_local const char *currentNapiCall = NULL;
+inline thread_local uint64_t napiCallSerial = 0;
+
+#ifdef YOGA_NODE_API_PROFILE
+// Call profile of builds with YOGA_NODE_API_PROFILE, by binding function.
+// Time includes binding calls made by JS callbacks during the call, and bytes
+// count the array buffers handed to JS.
+struct CallProfileEntry {
+  uint64_t calls = 0;
+  uint64_t nanoseconds = 0;
+  uint64_t bytes = 0;
+};
+
+inline thread_local std::unordered_map<const char *, CallProfileEntry>
+    callProfile;
+inline thread_local CallProfileEntry *currentCallProfile = NULL;
+
+#define NAPI_PROFILE_BYTES(count)                                              \
+  do {                                                                         \
+    if (currentCallProfile != NULL) {                                          \
+      currentCallProfile->bytes += (count);                                    \
+    }                                                                          \
+  } while (0)
+#else
+#define NAPI_PROFILE_BYTES(count)                                              \
+  do {                                                                         \
+  } while (0)
+#endif
+
+struct NapiCallScope {
+  const char *previous;
+#ifdef YOGA_NODE_API_PROFILE
+  CallProfileEntry *previousProfile;
+  CallProfileEntry *profile;
+  std::chrono::steady_clock::time_point start;
+#endif
+
+  explicit NapiCallScope(const char *name) : previous(currentNapiCall) {
+    currentNapiCall = name;
+    napiCallSerial++;
+#ifdef YOGA_NODE_API_PROFILE
+    previousProfile = currentCallProfile;
+    profile = &callProfile[name];
+    profile->calls++;
+    currentCallProfile = profile;
+    start = std::chrono::steady_clock::now();
+#endif
+  }
+  ~NapiCallScope() {
+#ifdef YOGA_NODE_API_PROFILE
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    profile->nanoseconds +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    currentCallProfile = previousProfile;
+#endif
+    currentNapiCall = previous;
+  }
+};
+
+// Observes every binding call made from JS, before it runs, with the
+// arguments it was given. Calls made by JS callbacks while another binding
+// call is running are not reported. Used to record call traces.
+inline thread_local void (*napiCallHook)(napi_env env, const char *name,
+                                         napi_value self, size_t argc,
+                                         napi_value *argv) = NULL;
+
+#define NAPI_CALL_HOOK(self, argc, argv)                                       \
+  do {                                                                         \
+    if (napiCallHook != NULL && napiCallScope.previous == NULL) {              \
+      napiCallHook(env, __func__, self, argc, argv);                           \
+    }                                                                          \
+  } while (0)
 
 #define NAPI_FUNCTION(name)                                                    \
   napi_value name(napi_env env, napi_callback_info cbinfo)
@@ -16,15 +99,19 @@
 #define NAPI_FINALIZER(name) void name(napi_env env, void *data, void *hint)
 
 #define NAPI_METHOD_HEADER(objtype, objname, argcount)                         \
+  NapiCallScope napiCallScope(__func__);                                       \
   napi_value jsThis;                                                           \
   size_t argc = argcount;                                                      \
   napi_value argv[argcount];                                                   \
   napi_get_cb_info(env, cbinfo, &argc, argv, &jsThis, NULL);                   \
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)argcount), argv);              \
   objtype objname = (objtype)unwrap(env, jsThis)
 
 #define NAPI_METHOD_HEADER_NO_ARGS(objtype, objname)                           \
+  NapiCallScope napiCallScope(__func__);                                       \
   napi_value jsThis;                                                           \
   napi_get_cb_info(env, cbinfo, NULL, NULL, &jsThis, NULL);                    \
+  NAPI_CALL_HOOK(jsThis, 0, NULL);                                             \
   objtype objname = (objtype)unwrap(env, jsThis)
 
 #define NAPI_ARG_INT32(name, index)                                            \
@@ -63,6 +150,77 @@ inline napi_value js_double(napi_env env, double value) {
   return result;
 }
 
+inline napi_value js_typed_array(napi_env env, napi_typedarray_type type,
+                                 size_t length, size_t elementSize,
+                                 void **data) {
+  napi_value arraybuffer, result;
+  napi_create_arraybuffer(env, length * elementSize, data, &arraybuffer);
+  NAPI_PROFILE_BYTES(length * elementSize);
+  napi_create_typedarray(env, type, length, arraybuffer, 0, &result);
+  return result;
+}
+
+inline napi_value js_uint32_array(napi_env env, const uint32_t *data,
+                                  size_t length) {
+  void *buffer;
+  napi_value arraybuffer, result;
+  napi_create_arraybuffer(env, length * sizeof(uint32_t), &buffer,
+                          &arraybuffer);
+  NAPI_PROFILE_BYTES(length * sizeof(uint32_t));
+  std::copy(data, data + length, (uint32_t *)buffer);
+  napi_create_typedarray(env, napi_uint32_array, length, arraybuffer, 0,
+                         &result);
+  return result;
+}
+
+inline size_t js_typed_array_element_size(napi_typedarray_type type) {
+  switch (type) {
+  case napi_int8_array:
+  case napi_uint8_array:
+  case napi_uint8_clamped_array:
+    return 1;
+  case napi_int16_array:
+  case napi_uint16_array:
+    return 2;
+  case napi_int32_array:
+  case napi_uint32_array:
+  case napi_float32_array:
+    return 4;
+  default:
+    return 8;
+  }
+}
+
+// Reads the bytes behind an ArrayBuffer, or the bytes a typed array or
+// DataView views.
+inline bool js_buffer_data(napi_env env, napi_value value, void **data,
+                           size_t *length) {
+  bool isArrayBuffer = false;
+  napi_is_arraybuffer(env, value, &isArrayBuffer);
+  if (isArrayBuffer) {
+    return napi_get_arraybuffer_info(env, value, data, length) == napi_ok;
+  }
+  bool isDataView = false;
+  napi_is_dataview(env, value, &isDataView);
+  if (isDataView) {
+    return napi_get_dataview_info(env, value, length, data, NULL, NULL) ==
+           napi_ok;
+  }
+  bool isTypedArray = false;
+  napi_is_typedarray(env, value, &isTypedArray);
+  if (!isTypedArray) {
+    return false;
+  }
+  napi_typedarray_type type;
+  size_t count;
+  if (napi_get_typedarray_info(env, value, &type, &count, data, NULL, NULL) !=
+      napi_ok) {
+    return false;
+  }
+  *length = count * js_typed_array_element_size(type);
+  return true;
+}
+
 inline napi_value defineClass(napi_env env, const char *name,
                               napi_callback constructor,
                               napi_property_descriptor *props, size_t propc) {
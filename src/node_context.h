@@ -0,0 +1,136 @@
+#pragma once
+
+#include "intrinsic_sizes.h"
+#include "js_native_api.h"
+#include "measure_preset.h"
+#include "snapshot.h"
+#include "spatial_index.h"
+#include "yoga/YGNode.h"
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// A measure request together with its answer.
+struct MeasureEntry {
+  float width;
+  float height;
+  YGMeasureMode widthMode;
+  YGMeasureMode heightMode;
+  YGSize size;
+
+  // Matches with the same tolerance Yoga uses for its measurement cache.
+  bool matches(float otherWidth, YGMeasureMode otherWidthMode,
+               float otherHeight, YGMeasureMode otherHeightMode) const {
+    return widthMode == otherWidthMode && heightMode == otherHeightMode &&
+           (widthMode == YGMeasureModeUndefined ||
+            std::fabs(width - otherWidth) < 0.0001f) &&
+           (heightMode == YGMeasureModeUndefined ||
+            std::fabs(height - otherHeight) < 0.0001f);
+  }
+};
+
+struct VirtualList;
+
+// Binding state attached to every YGNode through its context pointer.
+struct NodeContext {
+  // Strong reference keeping the JS wrapper alive until the node is freed.
+  napi_ref ref = NULL;
+  // Stable numeric handle, see NodeRegistry.
+  uint32_t id = 0;
+  bool hasDirtiedFunc = false;
+  bool queuedDirtied = false;
+  bool hasBulkMeasureFunc = false;
+  // The last request `_measureFunc` answered, used to predict the next one.
+  bool hasLastMeasure = false;
+  MeasureEntry lastMeasure;
+  // Answers prepared by a bulk measure call for the current layout pass.
+  uint8_t predictedCount = 0;
+  MeasureEntry predicted[2];
+  // Content hash of the subtree, see hashSubtree. Only valid while the node
+  // is clean and the epoch is current.
+  uint32_t subtreeHashEpoch = 0;
+  bool subtreeCacheable = false;
+  uint64_t subtreeHash = 0;
+  // Stands in for the output of the measure function when hashing.
+  bool hasMeasureCacheKey = false;
+  uint64_t measureCacheKey = 0;
+  // Tag matched by Yoga.markDirtyByTag, 0 if none.
+  uint32_t measureTag = 0;
+  // Set while the node is measured natively, see measure_preset.h.
+  MeasurePreset measurePreset;
+  // Set while the node is in virtual list mode.
+  VirtualList *virtualList = NULL;
+  // Persistent trees, see persistent_tree.h. A frozen node counts the frozen
+  // parents and versions referring to it; a live node lists the frozen nodes
+  // it is a child of, and remembers its live parent while it has any.
+  bool frozen = false;
+  uint32_t frozenRefs = 0;
+  std::vector<YGNodeRef> frozenParents;
+  YGNodeRef liveParent = NULL;
+  // Layouts live nodes below a frozen node had before a layout pass changed
+  // them, by id. Copies of a node made for the same frozen parents share them.
+  std::shared_ptr<std::unordered_map<uint32_t, LayoutRecord>> capturedLayouts;
+  // Absolute frame after the last layout of a root tracking damage, see
+  // damage.h.
+  bool hasDamageFrame = false;
+  LayoutRect damageFrame = {};
+  // Kept until the node is dirtied or its subtree hash changes, see
+  // intrinsic_sizes.h.
+  bool hasIntrinsicSizes = false;
+  uint64_t intrinsicSizesHash = 0;
+  IntrinsicSizes intrinsicSizes = {};
+  // Right and bottom edges of the content below the node after the last
+  // layout, see content_size.h.
+  bool hasContentExtent = false;
+  float contentRight = 0;
+  float contentBottom = 0;
+  // Kept dirty while set, see layoutFrozenNodes in the binding.
+  bool layoutFrozen = false;
+};
+
+inline NodeContext *nodeContext(YGNodeConstRef node) {
+  return (NodeContext *)YGNodeGetContext(node);
+}
+
+// Maps numeric node ids to live nodes. Id 0 is never handed out, and ids of
+// freed nodes are reused.
+class NodeRegistry {
+public:
+  uint32_t add(YGNodeRef node) {
+    if (free_.empty()) {
+      nodes_.push_back(node);
+      return nodes_.size() - 1;
+    }
+    uint32_t id = free_.back();
+    free_.pop_back();
+    nodes_[id] = node;
+    return id;
+  }
+
+  void remove(uint32_t id) {
+    nodes_[id] = NULL;
+    free_.push_back(id);
+  }
+
+  YGNodeRef get(uint32_t id) const {
+    return id < nodes_.size() ? nodes_[id] : NULL;
+  }
+
+private:
+  std::vector<YGNodeRef> nodes_ = {NULL};
+  std::vector<uint32_t> free_;
+};
+
+extern thread_local NodeRegistry nodeRegistry;
+
+// Set around calls that must not re-enter JS, like the FFI exports. Dirtied
+// callbacks are then recorded in `deferredDirtied` and delivered later.
+extern thread_local bool deferDirtiedCallbacks;
+extern thread_local std::vector<uint32_t> deferredDirtied;
+
+// Set while recording a call trace. Records a call the FFI exports made on
+// behalf of the N-API method `name`, with node `id` as the receiver.
+extern thread_local void (*ffiCallHook)(const char *name, uint32_t id,
+                                        double const *args, size_t argc);
@@ -0,0 +1,223 @@
+#include "persistent_tree.h"
+#include "node_context.h"
+#include "yoga/node/Node.h"
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+using facebook::yoga::resolveRef;
+
+thread_local size_t frozenNodeCount = 0;
+thread_local uint64_t unshareCount = 0;
+
+namespace {
+
+// Nodes lent during the current layout pass, with the owner to give back.
+struct Lent {
+  YGNodeRef node;
+  YGNodeRef owner;
+};
+thread_local std::vector<Lent> lentNodes;
+// The frozen nodes above each lent node whose versions reach it through the
+// live tree.
+thread_local std::unordered_map<YGNodeConstRef, std::vector<YGNodeRef>>
+    lentBoundaries;
+
+// Copies a live node into a frozen one that shares its children.
+YGNodeRef freezeCopy(YGNodeRef node) {
+  YGNodeRef copy = YGNodeClone(node);
+  NodeContext *ctx = new NodeContext();
+  ctx->id = nodeContext(node)->id;
+  // Kept for serializing versions.
+  ctx->measurePreset = nodeContext(node)->measurePreset;
+  ctx->frozen = true;
+  YGNodeSetContext(copy, ctx);
+  YGNodeSetDirtiedFunc(copy, NULL);
+  frozenNodeCount++;
+
+  for (size_t i = 0, count = YGNodeGetChildCount(copy); i < count; i++) {
+    YGNodeRef child = YGNodeGetChild(copy, i);
+    NodeContext *childCtx = nodeContext(child);
+    if (childCtx->frozenParents.empty()) {
+      childCtx->liveParent = node;
+      resolveRef(child)->setOwner(resolveRef(copy));
+    }
+    childCtx->frozenParents.push_back(copy);
+  }
+  return copy;
+}
+
+// Points the frozen parents of a shared node at a frozen copy of it, and
+// gives the node back to its live parent. Parents that captured layouts below
+// the node get a copy of their own carrying them, see cloneSharedNode.
+void unshare(YGNodeRef node) {
+  NodeContext *ctx = nodeContext(node);
+  std::vector<YGNodeRef> parents = std::move(ctx->frozenParents);
+  while (!parents.empty()) {
+    auto captured = nodeContext(parents.back())->capturedLayouts;
+    auto same = std::partition(
+        parents.begin(), parents.end(), [&captured](YGNodeRef parent) {
+          return nodeContext(parent)->capturedLayouts != captured;
+        });
+    YGNodeRef copy = freezeCopy(node);
+    NodeContext *copyCtx = nodeContext(copy);
+    copyCtx->frozenRefs = parents.end() - same;
+    copyCtx->capturedLayouts = captured;
+    if (captured != nullptr) {
+      auto found = captured->find(ctx->id);
+      if (found != captured->end()) {
+        restoreLayout(copy, found->second);
+      }
+    }
+    for (auto it = same; it != parents.end(); ++it) {
+      resolveRef(*it)->replaceChild(resolveRef(node), resolveRef(copy));
+    }
+    parents.erase(same, parents.end());
+  }
+  resolveRef(node)->setOwner(resolveRef(ctx->liveParent));
+  ctx->frozenParents.clear();
+  ctx->liveParent = NULL;
+  unshareCount++;
+}
+
+// Lends `node` to `owner` for the current pass. Its layout is captured in the
+// frozen nodes above it first, and its children are lent in turn by clearing
+// their owner, so that Yoga asks for them before laying them out.
+void lend(YGNodeRef node, YGNodeRef owner,
+          std::vector<YGNodeRef> const &boundaries) {
+  LayoutRecord layout = captureLayout(node);
+  uint32_t id = nodeContext(node)->id;
+  for (YGNodeRef boundary : boundaries) {
+    auto &captured = nodeContext(boundary)->capturedLayouts;
+    if (captured == nullptr) {
+      captured =
+          std::make_shared<std::unordered_map<uint32_t, LayoutRecord>>();
+    }
+    captured->emplace(id, layout);
+  }
+  for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+    YGNodeRef child = YGNodeGetChild(node, i);
+    if (YGNodeGetOwner(child) == node) {
+      resolveRef(child)->setOwner(NULL);
+      lentNodes.push_back({child, node});
+    }
+  }
+  lentBoundaries[node] = boundaries;
+}
+
+} // namespace
+
+YGNodeRef freezeSnapshot(YGNodeRef node) {
+  YGNodeRef copy = freezeCopy(node);
+  nodeContext(copy)->frozenRefs = 1;
+  return copy;
+}
+
+void releaseFrozen(YGNodeRef root) {
+  std::vector<YGNodeRef> stack = {root};
+  while (!stack.empty()) {
+    YGNodeRef node = stack.back();
+    stack.pop_back();
+    NodeContext *ctx = nodeContext(node);
+    if (--ctx->frozenRefs > 0) {
+      continue;
+    }
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      YGNodeRef child = YGNodeGetChild(node, i);
+      NodeContext *childCtx = nodeContext(child);
+      if (childCtx->frozen) {
+        stack.push_back(child);
+        continue;
+      }
+      std::vector<YGNodeRef> &parents = childCtx->frozenParents;
+      parents.erase(std::find(parents.begin(), parents.end(), node));
+      if (parents.empty()) {
+        resolveRef(child)->setOwner(resolveRef(childCtx->liveParent));
+        childCtx->liveParent = NULL;
+      } else if (YGNodeGetOwner(child) == node) {
+        resolveRef(child)->setOwner(resolveRef(parents.back()));
+      }
+    }
+    delete ctx;
+    YGNodeFinalize(node);
+    frozenNodeCount--;
+  }
+}
+
+bool isShared(YGNodeConstRef node) {
+  NodeContext *ctx = nodeContext(node);
+  return ctx != NULL && !ctx->frozenParents.empty();
+}
+
+YGNodeRef liveParent(YGNodeRef node) {
+  return isShared(node) ? nodeContext(node)->liveParent : YGNodeGetOwner(node);
+}
+
+void unsharePath(YGNodeRef node) {
+  // Unsharing a node shares its children, so the path is unshared top down
+  // from its topmost shared node.
+  std::vector<YGNodeRef> path;
+  size_t top = 0;
+  for (YGNodeRef at = node; at != NULL; at = liveParent(at)) {
+    path.push_back(at);
+    if (isShared(at)) {
+      top = path.size();
+    }
+  }
+  for (size_t i = top; i > 0; i--) {
+    if (isShared(path[i - 1])) {
+      unshare(path[i - 1]);
+    }
+  }
+}
+
+void unshareChildren(YGNodeRef node) {
+  for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+    YGNodeRef child = YGNodeGetChild(node, i);
+    if (isShared(child)) {
+      unshare(child);
+    }
+  }
+}
+
+void returnLentNodes() {
+  for (auto it = lentNodes.rbegin(); it != lentNodes.rend(); ++it) {
+    resolveRef(it->node)->setOwner(resolveRef(it->owner));
+  }
+  lentNodes.clear();
+  lentBoundaries.clear();
+}
+
+LayoutRecord versionLayout(YGNodeConstRef node, YGNodeConstRef boundary) {
+  if (boundary != NULL) {
+    auto const &captured = nodeContext(boundary)->capturedLayouts;
+    if (captured != nullptr) {
+      auto found = captured->find(nodeContext(node)->id);
+      if (found != captured->end()) {
+        return found->second;
+      }
+    }
+  }
+  return captureLayout(node);
+}
+
+YGNodeRef cloneSharedNode(YGNodeConstRef oldNode, YGNodeConstRef owner,
+                          size_t childIndex) {
+  YGNodeRef node = (YGNodeRef)oldNode;
+  NodeContext *ctx = nodeContext(node);
+  auto above = lentBoundaries.find(owner);
+  std::vector<YGNodeRef> boundaries;
+  if (above != lentBoundaries.end()) {
+    boundaries = above->second;
+  }
+  if (isShared(node) && ctx->liveParent == owner) {
+    lentNodes.push_back({node, YGNodeGetOwner(node)});
+    boundaries.insert(boundaries.end(), ctx->frozenParents.begin(),
+                      ctx->frozenParents.end());
+  } else if (YGNodeGetOwner(node) != NULL || boundaries.empty()) {
+    // Yoga makes a copy of its own.
+    return NULL;
+  }
+  lend(node, (YGNodeRef)owner, boundaries);
+  return node;
+}
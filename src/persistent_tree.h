@@ -0,0 +1,83 @@
+#pragma once
+
+#include "snapshot.h"
+#include "yoga/YGConfig.h"
+#include "yoga/YGNode.h"
+#include <cstddef>
+#include <cstdint>
+
+// Persistent trees. A snapshot is a frozen copy of a node that shares its
+// children with the live tree instead of copying them. A live node that frozen
+// nodes refer to is shared: its owner is one of them rather than its live
+// parent. The binding calls prepareWrite before changing it, which unshares
+// it: the frozen nodes referring to it get a frozen copy of it, which in turn
+// shares its children. A change thus copies the path from the topmost shared
+// node down to the changed one, and nothing else.
+//
+// Layout doesn't change the style or structure of a shared node, only its
+// layout, so it doesn't unshare it either. Its owner makes Yoga ask the
+// config's clone callback before laying it out, and the callback lends it to
+// its live parent for the pass instead. Before a lent node is laid out, its
+// layout is captured in the frozen nodes above it whose versions reach it
+// through the live tree, and its children are lent in turn, so that Yoga
+// asks for them too if it descends. Only the nodes a pass visits are
+// captured; rounding leaves the layout of the others as it was.
+//
+// Live nodes keep their identity throughout, so JS wrappers, ids and binding
+// state stay with the live tree. Frozen nodes have a NodeContext of their own
+// carrying the id of the node they were copied from, and are reference counted
+// by the frozen nodes and versions referring to them.
+
+// Frozen nodes alive on this thread. While there are none, nothing is shared
+// and prepareWrite returns right away.
+extern thread_local size_t frozenNodeCount;
+
+// Returns a frozen copy of `node` sharing its children, owned by the caller.
+YGNodeRef freezeSnapshot(YGNodeRef node);
+
+// Drops a reference to a frozen node, freeing it along with the frozen nodes
+// only it referred to. Live nodes it shared are handed back to their parents.
+void releaseFrozen(YGNodeRef node);
+
+bool isShared(YGNodeConstRef node);
+
+// Counts unsharing, which changes the nodes versions are made of.
+extern thread_local uint64_t unshareCount;
+
+// Gives the nodes lent during a layout pass back to their owners. Called after
+// every YGNodeCalculateLayout.
+void returnLentNodes();
+
+// The layout `node` has in the versions reaching it through `boundary`, the
+// frozen node above the live part of their path, or its own layout if
+// `boundary` is NULL.
+LayoutRecord versionLayout(YGNodeConstRef node, YGNodeConstRef boundary);
+
+// The parent of `node` in the live tree, whether or not it is shared.
+YGNodeRef liveParent(YGNodeRef node);
+
+void unsharePath(YGNodeRef node);
+void unshareChildren(YGNodeRef node);
+
+// Unshares `node` and its ancestors, so it can be changed without changing
+// any version.
+inline void prepareWrite(YGNodeRef node) {
+  if (frozenNodeCount != 0) {
+    unsharePath(node);
+  }
+}
+
+// Like prepareWrite, and also unshares the children of `node`, for changes
+// that detach all of them.
+inline void prepareChildrenWrite(YGNodeRef node) {
+  if (frozenNodeCount != 0) {
+    unsharePath(node);
+    unshareChildren(node);
+  }
+}
+
+// The clone callback of every config made by the binding. Lends a shared node,
+// or a child of a lent one, about to be laid out under its live parent, after
+// capturing its layout, so that layout never changes a version.
+YGNodeRef cloneSharedNode(YGNodeConstRef oldNode, YGNodeConstRef owner,
+                          size_t childIndex);
@@ -0,0 +1,83 @@
+#include "pixel_grid.h"
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+// Yoga's tolerance for treating two layout values as equal.
+constexpr float kEpsilon = 0.0001f;
+
+inline bool inexactEquals(double a, double b) {
+  return std::fabs(a - b) < kEpsilon;
+}
+
+// A value rounds up when its fraction is above one half, or within tolerance
+// of it; fractions within tolerance of 0 or 1 snap the same way.
+inline float roundOne(float value, float scale) {
+  float scaled = value * scale;
+  float whole = std::floor(scaled);
+  return scaled - whole > 0.5f - kEpsilon ? whole + 1 : whole;
+}
+
+} // namespace
+
+void roundToPixelGrid(const float *in, float *out, size_t count, float scale) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  // SSE2 has no floor, so truncate and step down where that rounded up. That
+  // is exact for magnitudes below 2^31, far beyond any layout.
+  const __m128 scales = _mm_set1_ps(scale);
+  const __m128 half = _mm_set1_ps(0.5f - kEpsilon);
+  const __m128 one = _mm_set1_ps(1);
+  for (; i + 4 <= count; i += 4) {
+    __m128 scaled = _mm_mul_ps(_mm_loadu_ps(in + i), scales);
+    __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(scaled));
+    __m128 whole = _mm_sub_ps(
+        truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, scaled), one));
+    __m128 up = _mm_cmpgt_ps(_mm_sub_ps(scaled, whole), half);
+    __m128 rounded = _mm_add_ps(whole, _mm_and_ps(up, one));
+    __m128 ordered = _mm_cmpord_ps(scaled, scaled);
+    _mm_storeu_ps(out + i, _mm_or_ps(_mm_and_ps(ordered, rounded),
+                                     _mm_andnot_ps(ordered, scaled)));
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  // vrndmq_f32 rounds NaN to NaN, so no masking is needed.
+  const float32x4_t scales = vdupq_n_f32(scale);
+  const float32x4_t half = vdupq_n_f32(0.5f - kEpsilon);
+  const float32x4_t one = vdupq_n_f32(1);
+  for (; i + 4 <= count; i += 4) {
+    float32x4_t scaled = vmulq_f32(vld1q_f32(in + i), scales);
+    float32x4_t whole = vrndmq_f32(scaled);
+    uint32x4_t up = vcgtq_f32(vsubq_f32(scaled, whole), half);
+    float32x4_t step = vreinterpretq_f32_u32(
+        vandq_u32(up, vreinterpretq_u32_f32(one)));
+    vst1q_f32(out + i, vaddq_f32(whole, step));
+  }
+#endif
+  for (; i < count; i++) {
+    out[i] = roundOne(in[i], scale);
+  }
+}
+
+double roundScaled(double scaled, bool forceCeil, bool forceFloor) {
+  double fraction = scaled - std::floor(scaled);
+  if (inexactEquals(fraction, 0)) {
+    return scaled - fraction;
+  }
+  if (inexactEquals(fraction, 1)) {
+    return scaled - fraction + 1;
+  }
+  if (forceCeil) {
+    return std::ceil(scaled);
+  }
+  if (forceFloor) {
+    return std::floor(scaled);
+  }
+  return scaled - fraction +
+         (fraction > 0.5 || inexactEquals(fraction, 0.5) ? 1 : 0);
+}
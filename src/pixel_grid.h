@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+
+// Device pixel rounding following Yoga's pixel grid rules: a scaled value
+// within 0.0001 of a whole pixel snaps to it, anything else rounds half up.
+// Text nodes additionally force rounding up or down, see roundScaled.
+
+// Rounds `count` values scaled by `scale` to whole device pixels. `in` and
+// `out` may be the same buffer. NaN stays NaN.
+void roundToPixelGrid(const float *in, float *out, size_t count, float scale);
+
+// Rounds an already scaled value, forcing it up or down unless it is within
+// tolerance of a whole pixel.
+double roundScaled(double scaled, bool forceCeil, bool forceFloor);
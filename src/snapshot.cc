@@ -0,0 +1,456 @@
+#include "snapshot.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include "yoga/node/Node.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+using facebook::yoga::Dimension;
+using facebook::yoga::Gutter;
+using facebook::yoga::PhysicalEdge;
+
+namespace {
+
+constexpr char kMagic[4] = {'Y', 'G', 'S', 'N'};
+constexpr YGEdge kPhysicalEdges[] = {YGEdgeLeft, YGEdgeTop, YGEdgeRight,
+                                     YGEdgeBottom};
+constexpr YGGutter kGutters[] = {YGGutterColumn, YGGutterRow, YGGutterAll};
+
+enum NodeFlags : uint8_t {
+  kFlexGrowSet = 1 << 0,
+  kFlexShrinkSet = 1 << 1,
+  kReferenceBaseline = 1 << 2,
+  kAlwaysFormsContainingBlock = 1 << 3,
+  kHadOverflow = 1 << 4,
+};
+
+// Values are stored little-endian, big-endian hosts swap them in place.
+void toLittleEndian(uint8_t *bytes, size_t size) {
+  if constexpr (std::endian::native == std::endian::big) {
+    std::reverse(bytes, bytes + size);
+  }
+}
+
+// The public getter drops the unit of a gap.
+YGValue styleGap(YGNodeConstRef node, YGGutter gutter) {
+  return static_cast<YGValue>(facebook::yoga::resolveRef(node)->style().gap(
+      static_cast<Gutter>(gutter)));
+}
+
+class Writer {
+public:
+  explicit Writer(std::vector<uint8_t> &out) : out_(out) {}
+
+  template <typename T> void write(T value) {
+    size_t at = out_.size();
+    out_.resize(at + sizeof(T));
+    std::memcpy(out_.data() + at, &value, sizeof(T));
+    toLittleEndian(out_.data() + at, sizeof(T));
+  }
+
+  void writeValue(YGValue value) {
+    write<float>(value.value);
+    write<uint8_t>(value.unit);
+  }
+
+private:
+  std::vector<uint8_t> &out_;
+};
+
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T> T read() {
+    T value = {};
+    if (offset_ + sizeof(T) > size_) {
+      failed_ = true;
+      return value;
+    }
+    uint8_t bytes[sizeof(T)];
+    std::memcpy(bytes, data_ + offset_, sizeof(T));
+    toLittleEndian(bytes, sizeof(T));
+    std::memcpy(&value, bytes, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+  }
+
+  YGValue readValue() {
+    float value = read<float>();
+    uint8_t unit = read<uint8_t>();
+    if (unit > YGUnitAuto) {
+      failed_ = true;
+    }
+    return {value, static_cast<YGUnit>(unit)};
+  }
+
+  bool failed() const { return failed_; }
+  void fail() { failed_ = true; }
+
+private:
+  const uint8_t *data_;
+  size_t size_;
+  size_t offset_ = 0;
+  bool failed_ = false;
+};
+
+void writeStyle(Writer &writer, YGNodeConstRef node, uint8_t flags) {
+  writer.write<uint8_t>(YGNodeStyleGetDirection(node));
+  writer.write<uint8_t>(YGNodeStyleGetFlexDirection(node));
+  writer.write<uint8_t>(YGNodeStyleGetJustifyContent(node));
+  writer.write<uint8_t>(YGNodeStyleGetAlignContent(node));
+  writer.write<uint8_t>(YGNodeStyleGetAlignItems(node));
+  writer.write<uint8_t>(YGNodeStyleGetAlignSelf(node));
+  writer.write<uint8_t>(YGNodeStyleGetPositionType(node));
+  writer.write<uint8_t>(YGNodeStyleGetFlexWrap(node));
+  writer.write<uint8_t>(YGNodeStyleGetOverflow(node));
+  writer.write<uint8_t>(YGNodeStyleGetDisplay(node));
+
+  // Grow and shrink getters report defaults for unset values. Writing those
+  // back would shadow the `flex` shorthand, so they are only kept when `flex`
+  // is unset or they differ from what it resolves to.
+  float flex = YGNodeStyleGetFlex(node);
+  float flexGrow = YGNodeStyleGetFlexGrow(node);
+  float flexShrink = YGNodeStyleGetFlexShrink(node);
+  if (std::isnan(flex) || flexGrow != 0) {
+    flags |= kFlexGrowSet;
+  }
+  if (std::isnan(flex) || flexShrink != 0) {
+    flags |= kFlexShrinkSet;
+  }
+  if (YGNodeIsReferenceBaseline(node)) {
+    flags |= kReferenceBaseline;
+  }
+  if (YGNodeGetAlwaysFormsContainingBlock(node)) {
+    flags |= kAlwaysFormsContainingBlock;
+  }
+  writer.write<uint8_t>(flags);
+  writer.write<float>(flex);
+  writer.write<float>(flexGrow);
+  writer.write<float>(flexShrink);
+  writer.write<float>(YGNodeStyleGetAspectRatio(node));
+
+  writer.writeValue(YGNodeStyleGetFlexBasis(node));
+  writer.writeValue(YGNodeStyleGetWidth(node));
+  writer.writeValue(YGNodeStyleGetHeight(node));
+  writer.writeValue(YGNodeStyleGetMinWidth(node));
+  writer.writeValue(YGNodeStyleGetMinHeight(node));
+  writer.writeValue(YGNodeStyleGetMaxWidth(node));
+  writer.writeValue(YGNodeStyleGetMaxHeight(node));
+  for (int edge = YGEdgeLeft; edge <= YGEdgeAll; edge++) {
+    writer.writeValue(YGNodeStyleGetMargin(node, static_cast<YGEdge>(edge)));
+    writer.writeValue(YGNodeStyleGetPosition(node, static_cast<YGEdge>(edge)));
+    writer.writeValue(YGNodeStyleGetPadding(node, static_cast<YGEdge>(edge)));
+    writer.write<float>(YGNodeStyleGetBorder(node, static_cast<YGEdge>(edge)));
+  }
+  for (YGGutter gutter : kGutters) {
+    writer.writeValue(styleGap(node, gutter));
+  }
+}
+
+void writeNode(Writer &writer, YGNodeConstRef node,
+               LayoutRecord const &layout, MeasurePreset const &preset) {
+  writer.write<uint32_t>(YGNodeGetChildCount(node));
+  writeStyle(writer, node, layout.hadOverflow ? kHadOverflow : 0);
+
+  writer.write<uint8_t>(layout.direction);
+  writer.write<float>(layout.width);
+  writer.write<float>(layout.height);
+  for (float position : layout.position) {
+    writer.write<float>(position);
+  }
+  for (int edge = 0; edge < 4; edge++) {
+    writer.write<float>(layout.margin[edge]);
+    writer.write<float>(layout.border[edge]);
+    writer.write<float>(layout.padding[edge]);
+  }
+
+  writer.write<uint8_t>(preset.kind);
+  if (preset.kind != MeasurePreset::None) {
+    for (float value : preset.values) {
+      writer.write<float>(value);
+    }
+  }
+}
+
+template <typename Point, typename Percent>
+void applyValue(YGValue value, Point setPoint, Percent setPercent) {
+  if (value.unit == YGUnitPercent) {
+    setPercent(value.value);
+  } else {
+    setPoint(value.unit == YGUnitPoint ? value.value : YGUndefined);
+  }
+}
+
+void readNode(Reader &reader, YGNodeRef node) {
+  YGNodeStyleSetDirection(node,
+                          static_cast<YGDirection>(reader.read<uint8_t>()));
+  YGNodeStyleSetFlexDirection(
+      node, static_cast<YGFlexDirection>(reader.read<uint8_t>()));
+  YGNodeStyleSetJustifyContent(node,
+                               static_cast<YGJustify>(reader.read<uint8_t>()));
+  YGNodeStyleSetAlignContent(node,
+                             static_cast<YGAlign>(reader.read<uint8_t>()));
+  YGNodeStyleSetAlignItems(node, static_cast<YGAlign>(reader.read<uint8_t>()));
+  YGNodeStyleSetAlignSelf(node, static_cast<YGAlign>(reader.read<uint8_t>()));
+  YGNodeStyleSetPositionType(
+      node, static_cast<YGPositionType>(reader.read<uint8_t>()));
+  YGNodeStyleSetFlexWrap(node, static_cast<YGWrap>(reader.read<uint8_t>()));
+  YGNodeStyleSetOverflow(node,
+                         static_cast<YGOverflow>(reader.read<uint8_t>()));
+  YGNodeStyleSetDisplay(node, static_cast<YGDisplay>(reader.read<uint8_t>()));
+
+  uint8_t flags = reader.read<uint8_t>();
+  YGNodeStyleSetFlex(node, reader.read<float>());
+  float flexGrow = reader.read<float>();
+  float flexShrink = reader.read<float>();
+  if (flags & kFlexGrowSet) {
+    YGNodeStyleSetFlexGrow(node, flexGrow);
+  }
+  if (flags & kFlexShrinkSet) {
+    YGNodeStyleSetFlexShrink(node, flexShrink);
+  }
+  YGNodeStyleSetAspectRatio(node, reader.read<float>());
+  YGNodeSetIsReferenceBaseline(node, flags & kReferenceBaseline);
+  YGNodeSetAlwaysFormsContainingBlock(node,
+                                      flags & kAlwaysFormsContainingBlock);
+
+  YGValue flexBasis = reader.readValue();
+  if (flexBasis.unit == YGUnitAuto) {
+    YGNodeStyleSetFlexBasisAuto(node);
+  } else {
+    applyValue(
+        flexBasis, [&](float v) { YGNodeStyleSetFlexBasis(node, v); },
+        [&](float v) { YGNodeStyleSetFlexBasisPercent(node, v); });
+  }
+  YGValue width = reader.readValue();
+  if (width.unit == YGUnitAuto) {
+    YGNodeStyleSetWidthAuto(node);
+  } else {
+    applyValue(
+        width, [&](float v) { YGNodeStyleSetWidth(node, v); },
+        [&](float v) { YGNodeStyleSetWidthPercent(node, v); });
+  }
+  YGValue height = reader.readValue();
+  if (height.unit == YGUnitAuto) {
+    YGNodeStyleSetHeightAuto(node);
+  } else {
+    applyValue(
+        height, [&](float v) { YGNodeStyleSetHeight(node, v); },
+        [&](float v) { YGNodeStyleSetHeightPercent(node, v); });
+  }
+  applyValue(
+      reader.readValue(), [&](float v) { YGNodeStyleSetMinWidth(node, v); },
+      [&](float v) { YGNodeStyleSetMinWidthPercent(node, v); });
+  applyValue(
+      reader.readValue(), [&](float v) { YGNodeStyleSetMinHeight(node, v); },
+      [&](float v) { YGNodeStyleSetMinHeightPercent(node, v); });
+  applyValue(
+      reader.readValue(), [&](float v) { YGNodeStyleSetMaxWidth(node, v); },
+      [&](float v) { YGNodeStyleSetMaxWidthPercent(node, v); });
+  applyValue(
+      reader.readValue(), [&](float v) { YGNodeStyleSetMaxHeight(node, v); },
+      [&](float v) { YGNodeStyleSetMaxHeightPercent(node, v); });
+
+  for (int index = YGEdgeLeft; index <= YGEdgeAll; index++) {
+    YGEdge edge = static_cast<YGEdge>(index);
+    YGValue margin = reader.readValue();
+    if (margin.unit == YGUnitAuto) {
+      YGNodeStyleSetMarginAuto(node, edge);
+    } else {
+      applyValue(
+          margin, [&](float v) { YGNodeStyleSetMargin(node, edge, v); },
+          [&](float v) { YGNodeStyleSetMarginPercent(node, edge, v); });
+    }
+    applyValue(
+        reader.readValue(),
+        [&](float v) { YGNodeStyleSetPosition(node, edge, v); },
+        [&](float v) { YGNodeStyleSetPositionPercent(node, edge, v); });
+    applyValue(
+        reader.readValue(),
+        [&](float v) { YGNodeStyleSetPadding(node, edge, v); },
+        [&](float v) { YGNodeStyleSetPaddingPercent(node, edge, v); });
+    YGNodeStyleSetBorder(node, edge, reader.read<float>());
+  }
+  for (YGGutter gutter : kGutters) {
+    applyValue(
+        reader.readValue(),
+        [&](float v) { YGNodeStyleSetGap(node, gutter, v); },
+        [&](float v) { YGNodeStyleSetGapPercent(node, gutter, v); });
+  }
+
+  LayoutRecord layout = {};
+  layout.direction = reader.read<uint8_t>();
+  layout.width = reader.read<float>();
+  layout.height = reader.read<float>();
+  for (float &position : layout.position) {
+    position = reader.read<float>();
+  }
+  for (int edge = 0; edge < 4; edge++) {
+    layout.margin[edge] = reader.read<float>();
+    layout.border[edge] = reader.read<float>();
+    layout.padding[edge] = reader.read<float>();
+  }
+  layout.hadOverflow = flags & kHadOverflow;
+  restoreLayout(node, layout);
+}
+
+MeasurePreset readPreset(Reader &reader) {
+  MeasurePreset preset;
+  uint8_t kind = reader.read<uint8_t>();
+  if (kind > MeasurePreset::Clamp) {
+    reader.fail();
+    return preset;
+  }
+  preset.kind = static_cast<MeasurePreset::Kind>(kind);
+  if (preset.kind != MeasurePreset::None) {
+    for (float &value : preset.values) {
+      value = reader.read<float>();
+    }
+  }
+  return preset;
+}
+
+} // namespace
+
+LayoutRecord captureLayout(YGNodeConstRef node) {
+  LayoutRecord record = {};
+  record.width = YGNodeLayoutGetWidth(node);
+  record.height = YGNodeLayoutGetHeight(node);
+  record.position[0] = YGNodeLayoutGetLeft(node);
+  record.position[1] = YGNodeLayoutGetTop(node);
+  record.position[2] = YGNodeLayoutGetRight(node);
+  record.position[3] = YGNodeLayoutGetBottom(node);
+  for (int i = 0; i < 4; i++) {
+    record.margin[i] = YGNodeLayoutGetMargin(node, kPhysicalEdges[i]);
+    record.border[i] = YGNodeLayoutGetBorder(node, kPhysicalEdges[i]);
+    record.padding[i] = YGNodeLayoutGetPadding(node, kPhysicalEdges[i]);
+  }
+  record.direction = YGNodeLayoutGetDirection(node);
+  record.hadOverflow = YGNodeLayoutGetHadOverflow(node);
+  return record;
+}
+
+void restoreLayout(YGNodeRef nodeRef, LayoutRecord const &record) {
+  constexpr PhysicalEdge edges[] = {PhysicalEdge::Left, PhysicalEdge::Top,
+                                    PhysicalEdge::Right, PhysicalEdge::Bottom};
+  auto *node = facebook::yoga::resolveRef(nodeRef);
+  node->setLayoutDirection(
+      static_cast<facebook::yoga::Direction>(record.direction));
+  node->setLayoutDimension(record.width, Dimension::Width);
+  node->setLayoutDimension(record.height, Dimension::Height);
+  node->setLayoutMeasuredDimension(record.width, Dimension::Width);
+  node->setLayoutMeasuredDimension(record.height, Dimension::Height);
+  for (int i = 0; i < 4; i++) {
+    node->setLayoutPosition(record.position[i], edges[i]);
+    node->setLayoutMargin(record.margin[i], edges[i]);
+    node->setLayoutBorder(record.border[i], edges[i]);
+    node->setLayoutPadding(record.padding[i], edges[i]);
+  }
+  node->setLayoutHadOverflow(record.hadOverflow);
+}
+
+void serializeStyle(YGNodeConstRef node, std::vector<uint8_t> &out) {
+  Writer writer(out);
+  writeStyle(writer, node, 0);
+}
+
+void serializeTree(
+    YGNodeConstRef root, std::vector<uint8_t> &out,
+    std::function<MeasurePreset(YGNodeConstRef)> const &presetOf,
+    std::function<LayoutRecord(YGNodeConstRef)> const &layoutOf) {
+  Writer writer(out);
+  for (char c : kMagic) {
+    writer.write<char>(c);
+  }
+  writer.write<uint16_t>(kSnapshotVersion);
+  writer.write<uint16_t>(0);
+  size_t countOffset = out.size();
+  writer.write<uint32_t>(0);
+
+  uint32_t count = 0;
+  std::vector<YGNodeConstRef> stack = {root};
+  while (!stack.empty()) {
+    YGNodeConstRef node = stack.back();
+    stack.pop_back();
+    writeNode(writer, node, layoutOf(node), presetOf(node));
+    count++;
+    for (size_t i = YGNodeGetChildCount(node); i-- > 0;) {
+      stack.push_back(YGNodeGetChild(const_cast<YGNodeRef>(node), i));
+    }
+  }
+  std::memcpy(out.data() + countOffset, &count, sizeof(count));
+  toLittleEndian(out.data() + countOffset, sizeof(count));
+}
+
+bool deserializeTree(
+    const uint8_t *data, size_t size,
+    std::function<YGNodeRef()> const &createNode,
+    std::function<void(YGNodeRef, MeasurePreset const &)> const &setPreset,
+    std::vector<YGNodeRef> &nodes) {
+  Reader reader(data, size);
+  for (char c : kMagic) {
+    if (reader.read<char>() != c) {
+      return false;
+    }
+  }
+  if (reader.read<uint16_t>() != kSnapshotVersion) {
+    return false;
+  }
+  reader.read<uint16_t>();
+  uint32_t count = reader.read<uint32_t>();
+  if (reader.failed() || count == 0) {
+    return false;
+  }
+
+  // Each entry is a parent that still expects `remaining` children.
+  struct Open {
+    YGNodeRef node;
+    uint32_t remaining;
+  };
+  std::vector<Open> open;
+  size_t first = nodes.size();
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t childCount = reader.read<uint32_t>();
+    if (reader.failed() || (i > 0 && open.empty())) {
+      return false;
+    }
+    YGNodeRef node = createNode();
+    nodes.push_back(node);
+    readNode(reader, node);
+    MeasurePreset preset = readPreset(reader);
+    if (reader.failed()) {
+      return false;
+    }
+    // Measured nodes are leaves.
+    if (preset.kind != MeasurePreset::None) {
+      if (childCount > 0 || !isValidMeasurePreset(preset)) {
+        return false;
+      }
+      setPreset(node, preset);
+    }
+    if (!open.empty()) {
+      YGNodeRef parent = open.back().node;
+      YGNodeInsertChild(parent, node, YGNodeGetChildCount(parent));
+      if (--open.back().remaining == 0) {
+        open.pop_back();
+      }
+    }
+    if (childCount > 0) {
+      open.push_back({node, childCount});
+    }
+  }
+  if (!open.empty()) {
+    return false;
+  }
+
+  // Building the tree dirtied it; the restored layout is already valid.
+  for (size_t i = first; i < nodes.size(); i++) {
+    auto *node = facebook::yoga::resolveRef(nodes[i]);
+    node->setDirty(false);
+    node->setHasNewLayout(true);
+  }
+  return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "measure_preset.h"
+#include "yoga/YGConfig.h"
+#include "yoga/YGNode.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Binary snapshots of a laid-out subtree: structure, style and computed layout
+// in preorder. The format is versioned and little-endian:
+//
+//   header:  "YGSN" | u16 version | u16 reserved | u32 node count
+//   node:    u32 child count | style | layout | measure preset
+//
+// Measure presets, see measure_preset.h, are kept by the caller, so they are
+// read and restored through callbacks. JS measure functions, dirtied and
+// baseline functions are not part of the snapshot.
+
+constexpr uint16_t kSnapshotVersion = 3;
+
+// Computed layout of a single node. Edges are left, top, right, bottom.
+struct LayoutRecord {
+  float width;
+  float height;
+  float position[4];
+  float margin[4];
+  float border[4];
+  float padding[4];
+  uint8_t direction;
+  bool hadOverflow;
+};
+
+LayoutRecord captureLayout(YGNodeConstRef node);
+
+// Overwrites the computed layout of `node`; its dirty flag is left alone.
+void restoreLayout(YGNodeRef node, LayoutRecord const &record);
+
+// Appends the style of a single node in snapshot encoding.
+void serializeStyle(YGNodeConstRef node, std::vector<uint8_t> &out);
+
+// Presets are taken from `presetOf`, and layouts from `layoutOf`, which reads
+// the nodes' own by default.
+void serializeTree(
+    YGNodeConstRef root, std::vector<uint8_t> &out,
+    std::function<MeasurePreset(YGNodeConstRef)> const &presetOf,
+    std::function<LayoutRecord(YGNodeConstRef)> const &layoutOf =
+        captureLayout);
+
+// Rebuilds a serialized tree from nodes returned by `createNode`, appending
+// them to `nodes` in preorder, and hands the leaves measured with a preset to
+// `setPreset`. The restored nodes carry the serialized layout and are neither
+// dirty nor in need of a layout pass. Returns false if the data is truncated,
+// malformed or from an unknown version; nodes created before the error are
+// still appended so the caller can free them.
+bool deserializeTree(
+    const uint8_t *data, size_t size,
+    std::function<YGNodeRef()> const &createNode,
+    std::function<void(YGNodeRef, MeasurePreset const &)> const &setPreset,
+    std::vector<YGNodeRef> &nodes);
@@ -0,0 +1,164 @@
+#include "spatial_index.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include <algorithm>
+#include <limits>
+
+static constexpr uint32_t kLeafSize = 4;
+
+LayoutRect LayoutRect::intersect(LayoutRect const &other) const {
+  return {std::max(left, other.left), std::max(top, other.top),
+          std::min(right, other.right), std::min(bottom, other.bottom)};
+}
+
+LayoutRect LayoutRect::unite(LayoutRect const &other) const {
+  return {std::min(left, other.left), std::min(top, other.top),
+          std::max(right, other.right), std::max(bottom, other.bottom)};
+}
+
+void SpatialIndex::build(YGNodeRef root) {
+  entries_.clear();
+  branches_.clear();
+
+  struct Pending {
+    YGNodeRef node;
+    float originX;
+    float originY;
+    LayoutRect clip;
+  };
+
+  float infinity = std::numeric_limits<float>::infinity();
+  std::vector<Pending> stack = {
+      {root, 0, 0, {-infinity, -infinity, infinity, infinity}}};
+  uint32_t order = 0;
+  while (!stack.empty()) {
+    Pending pending = stack.back();
+    stack.pop_back();
+    YGNodeRef node = pending.node;
+    if (YGNodeStyleGetDisplay(node) == YGDisplayNone) {
+      continue;
+    }
+
+    float left = pending.originX + YGNodeLayoutGetLeft(node);
+    float top = pending.originY + YGNodeLayoutGetTop(node);
+    LayoutRect frame = {left, top, left + YGNodeLayoutGetWidth(node),
+                        top + YGNodeLayoutGetHeight(node)};
+    LayoutRect visible = frame.intersect(pending.clip);
+    if (!visible.isEmpty()) {
+      entries_.push_back({visible, node, order});
+    }
+    order++;
+
+    LayoutRect clip = pending.clip;
+    if (YGNodeStyleGetOverflow(node) != YGOverflowVisible) {
+      LayoutRect paddingBox = {
+          frame.left + YGNodeLayoutGetBorder(node, YGEdgeLeft),
+          frame.top + YGNodeLayoutGetBorder(node, YGEdgeTop),
+          frame.right - YGNodeLayoutGetBorder(node, YGEdgeRight),
+          frame.bottom - YGNodeLayoutGetBorder(node, YGEdgeBottom)};
+      clip = clip.intersect(paddingBox);
+    }
+
+    // Push in reverse so children are visited, and numbered, in order.
+    for (size_t i = YGNodeGetChildCount(node); i-- > 0;) {
+      stack.push_back({YGNodeGetChild(node, i), left, top, clip});
+    }
+  }
+
+  if (!entries_.empty()) {
+    branches_.reserve(2 * entries_.size() / kLeafSize + 1);
+    branches_.resize(1);
+    subdivide(0, 0, entries_.size());
+  }
+}
+
+void SpatialIndex::subdivide(uint32_t slot, uint32_t begin, uint32_t end) {
+  LayoutRect bounds = entries_[begin].rect;
+  for (uint32_t i = begin + 1; i < end; i++) {
+    bounds = bounds.unite(entries_[i].rect);
+  }
+  if (end - begin <= kLeafSize) {
+    branches_[slot] = {bounds, begin, end - begin};
+    return;
+  }
+
+  // Median split on the centers along the longer axis.
+  bool horizontal = bounds.right - bounds.left >= bounds.bottom - bounds.top;
+  uint32_t middle = begin + (end - begin) / 2;
+  std::nth_element(entries_.begin() + begin, entries_.begin() + middle,
+                   entries_.begin() + end,
+                   [horizontal](Entry const &a, Entry const &b) {
+                     return horizontal
+                                ? a.rect.left + a.rect.right <
+                                      b.rect.left + b.rect.right
+                                : a.rect.top + a.rect.bottom <
+                                      b.rect.top + b.rect.bottom;
+                   });
+
+  uint32_t first = branches_.size();
+  branches_.resize(first + 2);
+  branches_[slot] = {bounds, first, 0};
+  subdivide(first, begin, middle);
+  subdivide(first + 1, middle, end);
+}
+
+void SpatialIndex::query(LayoutRect const &rect,
+                         std::vector<YGNodeRef> &result) const {
+  if (branches_.empty()) {
+    return;
+  }
+  std::vector<uint32_t> matches;
+  std::vector<uint32_t> stack = {0};
+  while (!stack.empty()) {
+    Branch const &branch = branches_[stack.back()];
+    stack.pop_back();
+    if (!branch.bounds.intersects(rect)) {
+      continue;
+    }
+    if (branch.count == 0) {
+      stack.push_back(branch.first);
+      stack.push_back(branch.first + 1);
+      continue;
+    }
+    for (uint32_t i = branch.first; i < branch.first + branch.count; i++) {
+      if (entries_[i].rect.intersects(rect)) {
+        matches.push_back(i);
+      }
+    }
+  }
+  std::sort(matches.begin(), matches.end(), [this](uint32_t a, uint32_t b) {
+    return entries_[a].order < entries_[b].order;
+  });
+  for (uint32_t match : matches) {
+    result.push_back(entries_[match].node);
+  }
+}
+
+YGNodeRef SpatialIndex::hitTest(float x, float y) const {
+  if (branches_.empty()) {
+    return NULL;
+  }
+  // Later entries in document order paint above earlier ones.
+  Entry const *topmost = NULL;
+  std::vector<uint32_t> stack = {0};
+  while (!stack.empty()) {
+    Branch const &branch = branches_[stack.back()];
+    stack.pop_back();
+    if (!branch.bounds.contains(x, y)) {
+      continue;
+    }
+    if (branch.count == 0) {
+      stack.push_back(branch.first);
+      stack.push_back(branch.first + 1);
+      continue;
+    }
+    for (uint32_t i = branch.first; i < branch.first + branch.count; i++) {
+      Entry const &entry = entries_[i];
+      if (entry.rect.contains(x, y) &&
+          (topmost == NULL || entry.order > topmost->order)) {
+        topmost = &entry;
+      }
+    }
+  }
+  return topmost != NULL ? topmost->node : NULL;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "yoga/YGNode.h"
+#include <cstdint>
+#include <vector>
+
+struct LayoutRect {
+  float left;
+  float top;
+  float right;
+  float bottom;
+
+  bool isEmpty() const { return !(left < right && top < bottom); }
+
+  bool intersects(LayoutRect const &other) const {
+    return left < other.right && other.left < right && top < other.bottom &&
+           other.top < bottom;
+  }
+
+  bool contains(float x, float y) const {
+    return x >= left && x < right && y >= top && y < bottom;
+  }
+
+  LayoutRect intersect(LayoutRect const &other) const;
+  LayoutRect unite(LayoutRect const &other) const;
+};
+
+// Bounding-volume hierarchy over the computed layout of a subtree. Rects are
+// absolute (relative to the parent of the indexed root), clipped by every
+// ancestor with `overflow: hidden` or `overflow: scroll`, and nodes with
+// `display: none` are skipped together with their descendants.
+class SpatialIndex {
+public:
+  void build(YGNodeRef root);
+
+  // Appends every node whose visible rect intersects `rect`, in document order.
+  void query(LayoutRect const &rect, std::vector<YGNodeRef> &result) const;
+
+  // Returns the topmost node whose visible rect contains the point, or NULL.
+  YGNodeRef hitTest(float x, float y) const;
+
+  uint64_t generation = 0;
+
+private:
+  struct Entry {
+    LayoutRect rect;
+    YGNodeRef node;
+    uint32_t order;
+  };
+
+  struct Branch {
+    LayoutRect bounds;
+    // Leaves cover entries_[first, first + count), inner branches have
+    // count == 0 and their children at `first` and `first + 1`.
+    uint32_t first;
+    uint32_t count;
+  };
+
+  void subdivide(uint32_t slot, uint32_t begin, uint32_t end);
+
+  std::vector<Entry> entries_;
+  std::vector<Branch> branches_;
+};
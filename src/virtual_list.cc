@@ -0,0 +1,180 @@
+#include "virtual_list.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct MainAxis {
+  YGEdge leading;
+  YGEdge trailing;
+  YGGutter gutter;
+  bool horizontal;
+};
+
+MainAxis mainAxis(YGNodeConstRef node) {
+  switch (YGNodeStyleGetFlexDirection(node)) {
+  case YGFlexDirectionColumnReverse:
+    return {YGEdgeBottom, YGEdgeTop, YGGutterRow, false};
+  case YGFlexDirectionRow:
+    return {YGEdgeStart, YGEdgeEnd, YGGutterColumn, true};
+  case YGFlexDirectionRowReverse:
+    return {YGEdgeEnd, YGEdgeStart, YGGutterColumn, true};
+  default:
+    return {YGEdgeTop, YGEdgeBottom, YGGutterRow, false};
+  }
+}
+
+float mainGap(YGNodeConstRef node, MainAxis const &axis) {
+  float gap = YGNodeStyleGetGap(node, axis.gutter);
+  if (std::isnan(gap)) {
+    gap = YGNodeStyleGetGap(node, YGGutterAll);
+  }
+  return std::isnan(gap) ? 0 : gap;
+}
+
+// The padding that applies to `edge`, which may come from the edges it falls
+// back to.
+YGValue resolvedPadding(YGNodeConstRef node, YGEdge edge, bool horizontal) {
+  YGEdge edges[] = {edge, horizontal ? YGEdgeHorizontal : YGEdgeVertical,
+                    YGEdgeAll};
+  for (YGEdge each : edges) {
+    YGValue padding = YGNodeStyleGetPadding(node, each);
+    if (padding.unit != YGUnitUndefined) {
+      return padding;
+    }
+  }
+  return {YGUndefined, YGUnitUndefined};
+}
+
+bool setPadding(YGNodeRef node, YGEdge edge, float padding) {
+  YGValue current = YGNodeStyleGetPadding(node, edge);
+  if (current.unit == YGUnitPoint && current.value == padding) {
+    return false;
+  }
+  YGNodeStyleSetPadding(node, edge, padding);
+  return true;
+}
+
+} // namespace
+
+void FenwickTree::resize(size_t count, float value) {
+  values_.resize(count, value);
+  tree_.assign(count + 1, 0);
+  for (size_t i = 1; i <= count; i++) {
+    tree_[i] += values_[i - 1];
+    size_t parent = i + (i & -i);
+    if (parent <= count) {
+      tree_[parent] += tree_[i];
+    }
+  }
+}
+
+void FenwickTree::set(size_t index, float value) {
+  double delta = (double)value - values_[index];
+  values_[index] = value;
+  for (size_t i = index + 1; i < tree_.size(); i += i & -i) {
+    tree_[i] += delta;
+  }
+}
+
+double FenwickTree::prefix(size_t count) const {
+  double sum = 0;
+  for (size_t i = count; i > 0; i -= i & -i) {
+    sum += tree_[i];
+  }
+  return sum;
+}
+
+size_t FenwickTree::countBefore(double offset) const {
+  size_t count = 0;
+  size_t step = 1;
+  while (step * 2 <= values_.size()) {
+    step *= 2;
+  }
+  for (; step > 0; step /= 2) {
+    if (count + step <= values_.size() && tree_[count + step] <= offset) {
+      count += step;
+      offset -= tree_[count];
+    }
+  }
+  return count;
+}
+
+void VirtualList::updateRange() {
+  size_t count = sizes.size();
+  if (count == 0) {
+    start = end = 0;
+    return;
+  }
+  size_t first = std::min(sizes.countBefore(windowOffset), count - 1);
+  double windowEnd = (double)windowOffset + windowLength;
+  size_t last = sizes.countBefore(windowEnd);
+  if (last < count && sizes.prefix(last) < windowEnd) {
+    last++;
+  }
+  start = first > overscan ? first - overscan : 0;
+  end = std::min(count, std::max(last, first) + overscan);
+}
+
+double VirtualList::contentSize(YGNodeConstRef node) const {
+  if (sizes.size() == 0) {
+    return 0;
+  }
+  // The last item is not followed by a gap.
+  return sizes.total() - mainGap(node, mainAxis(node));
+}
+
+void VirtualList::savePadding(YGNodeConstRef node) {
+  MainAxis axis = mainAxis(node);
+  paddingEdges[0] = axis.leading;
+  paddingEdges[1] = axis.trailing;
+  for (int i = 0; i < 2; i++) {
+    userPadding[i] = YGNodeStyleGetPadding(node, paddingEdges[i]);
+    YGValue resolved =
+        resolvedPadding(node, paddingEdges[i], axis.horizontal);
+    basePadding[i] = resolved.unit == YGUnitPoint ? resolved.value : 0;
+  }
+}
+
+void VirtualList::restorePadding(YGNodeRef node) const {
+  for (int i = 0; i < 2; i++) {
+    if (userPadding[i].unit == YGUnitPercent) {
+      YGNodeStyleSetPaddingPercent(node, paddingEdges[i],
+                                   userPadding[i].value);
+    } else {
+      YGNodeStyleSetPadding(node, paddingEdges[i], userPadding[i].value);
+    }
+  }
+}
+
+bool VirtualList::applySpacers(YGNodeRef node) const {
+  bool changed = setPadding(node, paddingEdges[0],
+                            basePadding[0] + sizes.prefix(start));
+  changed |= setPadding(node, paddingEdges[1],
+                        basePadding[1] + sizes.total() -
+                            sizes.prefix(std::max(start, end)));
+  return changed;
+}
+
+void VirtualList::measureItems(YGNodeRef node) {
+  MainAxis axis = mainAxis(node);
+  float gap = mainGap(node, axis);
+  size_t count = std::min(YGNodeGetChildCount(node), end - start);
+  for (size_t i = 0; i < count; i++) {
+    YGNodeRef child = YGNodeGetChild(node, i);
+    if (YGNodeStyleGetDisplay(child) == YGDisplayNone) {
+      sizes.set(start + i, 0);
+      continue;
+    }
+    float size = axis.horizontal
+                     ? YGNodeLayoutGetWidth(child) +
+                           YGNodeLayoutGetMargin(child, YGEdgeLeft) +
+                           YGNodeLayoutGetMargin(child, YGEdgeRight)
+                     : YGNodeLayoutGetHeight(child) +
+                           YGNodeLayoutGetMargin(child, YGEdgeTop) +
+                           YGNodeLayoutGetMargin(child, YGEdgeBottom);
+    sizes.set(start + i, size + gap);
+  }
+}
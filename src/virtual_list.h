@@ -0,0 +1,78 @@
+#pragma once
+
+#include "yoga/YGNode.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Item sizes with O(log n) updates and prefix sums. Sums are kept in doubles
+// so offsets stay exact for very long lists.
+class FenwickTree {
+public:
+  size_t size() const { return values_.size(); }
+
+  // Resizes to `count` items. Existing items keep their size, new ones get
+  // `value`.
+  void resize(size_t count, float value);
+
+  float get(size_t index) const { return values_[index]; }
+  void set(size_t index, float value);
+
+  // Sum of the first `count` items.
+  double prefix(size_t count) const;
+  double total() const { return prefix(values_.size()); }
+
+  // The largest `count` with prefix(count) <= offset.
+  size_t countBefore(double offset) const;
+
+  size_t bytes() const {
+    return values_.capacity() * sizeof(float) +
+           tree_.capacity() * sizeof(double);
+  }
+
+private:
+  std::vector<float> values_;
+  std::vector<double> tree_;
+};
+
+// State of a node in virtual list mode. The list holds `count` items along its
+// main axis but only items [start, end) are children of the node; the space of
+// the others is reserved by main-axis padding on the list, added to the
+// padding the node had in points when it became a list.
+//
+// Item sizes include the item's main-axis margins and the gap that follows it.
+// They start out estimated and are replaced by measured sizes after every
+// layout, with child `i` taken to be item `start + i`.
+struct VirtualList {
+  FenwickTree sizes;
+  float windowOffset = 0;
+  float windowLength = 0;
+  uint32_t overscan = 0;
+  size_t start = 0;
+  size_t end = 0;
+
+  // The leading and trailing main-axis padding the node had as set, restored
+  // by restorePadding, and in points, as spacers are added to it.
+  YGEdge paddingEdges[2] = {YGEdgeTop, YGEdgeBottom};
+  YGValue userPadding[2] = {{YGUndefined, YGUnitUndefined},
+                            {YGUndefined, YGUnitUndefined}};
+  float basePadding[2] = {0, 0};
+
+  // Records the padding of `node` before spacers are first applied.
+  void savePadding(YGNodeConstRef node);
+  void restorePadding(YGNodeRef node) const;
+
+  // Recomputes [start, end) from the window and the current sizes.
+  void updateRange();
+
+  double contentSize(YGNodeConstRef node) const;
+
+  // Sets the padding that stands in for items outside of the range. Returns
+  // true if it changed.
+  bool applySpacers(YGNodeRef node) const;
+
+  // Replaces the sizes of laid out items with their measured sizes.
+  void measureItems(YGNodeRef node);
+
+  size_t bytes() const { return sizeof(VirtualList) + sizes.bytes(); }
+};
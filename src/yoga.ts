@@ -36,6 +36,13 @@ export type Size = {
   width: number;
   height: number;
 };
+/** Content widths of a subtree, with its heights at those widths. */
+export type IntrinsicSizes = {
+  minContentWidth: number;
+  minContentHeight: number;
+  maxContentWidth: number;
+  maxContentHeight: number;
+};
 export type Value = {
   unit: Unit;
   value: number;
@@ -53,7 +60,96 @@ export type Config = {
   useWebDefaults(): boolean;
   setUseWebDefaults(useWebDefaults: boolean): void;
 };
+export type LayoutCacheStats = {
+  hits: number;
+  misses: number;
+  size: number;
+  capacity: number;
+};
+export type MemoryStats = {
+  liveNodes: number;
+  liveConfigs: number;
+  freedNodes: number;
+  freedConfigs: number;
+  /** Configs whose wrapper was garbage collected without being freed. */
+  leakedConfigs: number;
+  /** Approximate native bytes held by live nodes and configs. */
+  bytes: number;
+  peakBytes: number;
+  /** Nodes held by tree versions, apart from those shared with live trees. */
+  frozenNodes: number;
+};
+export type CallProfileEntry = {
+  /** The binding function, e.g. "Node_setWidth". */
+  name: string;
+  calls: number;
+  /** Time spent in the calls, including binding calls made by callbacks. */
+  nanoseconds: number;
+  /** Bytes of array buffers returned to JS. */
+  bytes: number;
+};
+export type DirtyEvent = {
+  /** The node the call dirtied first, unless it was freed since. */
+  node: Node | undefined;
+  /** The method that dirtied it, e.g. "setWidth" or "insertChild". */
+  operation: string;
+  /** How many nodes the call dirtied, counting `node` and its ancestors. */
+  dirtiedNodes: number;
+  /** Where the call came from, if stacks are captured. */
+  stack?: string;
+};
+export type LayoutTrace = {
+  root: Node | undefined;
+  durationMs: number;
+  /** What dirtied the tree since its previous layout. */
+  events: DirtyEvent[];
+};
+/**
+ * The shape of a subtree in preorder: entry `i` describes the `i`th node,
+ * `parent[i]` is the index of its parent (-1 for the root).
+ */
+export type Topology = {
+  parent: Int32Array;
+  childCount: Uint32Array;
+  depth: Uint32Array;
+  ids: Uint32Array;
+  nodes?: Node[];
+};
+/**
+ * A read-only version of a subtree, made by `Node.snapshot`. It keeps the
+ * styles, structure and layout the subtree had at the time.
+ */
+export type TreeVersion = {
+  /**
+   * The layout of the root, or of the node with the id of `node`, if the
+   * version has one.
+   */
+  getComputedLayout(node?: Node): Layout | undefined;
+  /**
+   * Like `Node.exportTopology`, but `nodes` is always left out: versions hold
+   * no wrappers, so match `ids` against the live nodes instead.
+   */
+  exportTopology(includeNodes?: boolean): Topology;
+  exportLayout(scale?: number): Float32Array;
+  exportLayout(scale: number, asInt32: true): Int32Array;
+  serialize(): ArrayBuffer;
+  /** Releases the version. Versions are also released when collected. */
+  free(): void;
+};
 export type DirtiedFunction = (node: Node) => void;
+/**
+ * Measures a batch of nodes before a layout pass. Request `i` is for the node
+ * with id `ids[i]`; its width and height go to `results[2 * i]` and
+ * `results[2 * i + 1]`. Requests left at NaN are measured individually.
+ */
+export type BulkMeasureFunction = (
+  ids: Uint32Array,
+  widths: Float32Array,
+  widthModes: Uint8Array,
+  heights: Float32Array,
+  heightModes: Uint8Array,
+  results: Float32Array,
+) => void;
 export type MeasureFunction = (
   width: number,
   widthMode: MeasureMode,
@@ -66,6 +162,18 @@ export type Node = {
     height: number | "auto" | undefined,
     direction?: Direction,
   ): void;
+  /**
+   * Like `calculateLayout`, but stops once `budgetMs` is spent and returns
+   * false. Fixed-size subtrees are laid out first, one at a time, and the
+   * root pass runs last; calling again resumes where the previous call
+   * stopped. Layout results are only complete once it returns true.
+   */
+  calculateLayoutSliced(
+    width: number | undefined,
+    height: number | undefined,
+    direction: Direction | undefined,
+    budgetMs: number,
+  ): boolean;
   copyStyle(node: Node): void;
   free(): void;
   freeRecursive(): void;
@@ -83,6 +191,11 @@ export type Node = {
   getComputedLeft(): number;
   getComputedMargin(edge: Edge): number;
   getComputedPadding(edge: Edge): number;
+  /**
+   * Min-content and max-content widths, computed on a copy of the subtree
+   * without touching its layout. Results are kept until the node is dirtied.
+   */
+  getIntrinsicSizes(): IntrinsicSizes;
   getComputedRight(): number;
   getComputedTop(): number;
   getComputedWidth(): number;
@@ -94,6 +207,7 @@ export type Node = {
   getFlexShrink(): number;
   getFlexWrap(): Wrap;
   getHeight(): Value;
+  getId(): number;
   getJustifyContent(): Justify;
   getGap(gutter: Gutter): Value;
   getMargin(edge: Edge): Value;
@@ -108,18 +222,66 @@ export type Node = {
   getPositionType(): PositionType;
   getWidth(): Value;
   insertChild(child: Node, index: number): void;
+  insertChildren(children: Node[], index: number): void;
   isDirty(): boolean;
   isReferenceBaseline(): boolean;
   markDirty(): void;
   hasNewLayout(): boolean;
+  exportTopology(includeNodes?: boolean): Topology;
+  /**
+   * Left, top, width and height of every node, in the order of
+   * `exportTopology`. With a `scale`, frames are snapped to whole device
+   * pixels using Yoga's pixel grid rounding; lay out with a point scale
+   * factor of 0 to snap one layout for several densities.
+   */
+  exportLayout(scale?: number): Float32Array;
+  exportLayout(scale: number, asInt32: true): Int32Array;
+  /**
+   * Collects the areas whose layout changes, for incremental repaint. Enable
+   * on the node `calculateLayout` is called on; the current layout is the
+   * baseline.
+   */
+  setDamageTrackingEnabled(enabled: boolean): void;
+  /**
+   * Left, top, width and height of a few rectangles, relative to the parent
+   * of this node, that cover the old and new frames of every node that moved,
+   * resized, appeared or disappeared since the last call. Subtrees whose
+   * layout was marked seen and that didn't move are skipped when collecting.
+   */
+  takeDamage(): Float32Array;
+  /**
+   * Keeps the content sizes of scroll containers below this node up to date
+   * after every `calculateLayout` on it, so `getContentSize` is a lookup.
+   */
+  setContentSizeEnabled(enabled: boolean): void;
+  /**
+   * Size of the scrollable content of a node with `OVERFLOW_SCROLL`: its
+   * padding box together with the margin boxes of its descendants and its end
+   * padding. Undefined for other nodes.
+   */
+  getContentSize(): Size | undefined;
+  /**
+   * While frozen, this subtree keeps its last layout when an ancestor is laid
+   * out, unless the ancestor offers it a different size. Changes below it
+   * leave it dirty without dirtying its ancestors. Once unfrozen, the next
+   * layout catches up on them.
+   */
+  setLayoutFrozen(frozen: boolean): void;
+  isLayoutFrozen(): boolean;
+  hitTest(x: number, y: number): Node | undefined;
   markLayoutSeen(): void;
+  queryRect(x: number, y: number, width: number, height: number): Node[];
+  removeAllChildren(): void;
   removeChild(child: Node): void;
   reset(): void;
+  serialize(): ArrayBuffer;
   setAlignContent(alignContent: Align): void;
   setAlignItems(alignItems: Align): void;
   setAlignSelf(alignSelf: Align): void;
   setAspectRatio(aspectRatio: number | undefined): void;
   setBorder(edge: Edge, borderWidth: number | undefined): void;
+  setBulkMeasureFunc(bulkMeasureFunc: BulkMeasureFunction): void;
+  setChildren(children: Node[]): void;
   setDirection(direction: Direction): void;
   setDisplay(display: Display): void;
   setFlex(flex: number | undefined): void;
@@ -149,6 +311,34 @@ export type Node = {
   setMaxWidthPercent(maxWidth: number | undefined): void;
   setDirtiedFunc(dirtiedFunc: DirtiedFunction | null): void;
   setMeasureFunc(measureFunc: MeasureFunction | null): void;
+  /**
+   * Identifies what the measure function measures, e.g. a text run and font.
+   * Layouts of subtrees whose measured nodes have no key are never cached.
+   */
+  setMeasureCacheKey(key: string | undefined): void;
+  /**
+   * Tags the measured content, e.g. with a font id, for
+   * `Yoga.markDirtyByTag`. 0 removes the tag.
+   */
+  setMeasureTag(tag: number): void;
+  /**
+   * Measures the node natively at a fixed size, like an image or an icon.
+   * Replaces the measure function; `unsetMeasureFunc` removes it.
+   */
+  setIntrinsicSize(width: number, height: number): void;
+  /**
+   * Measures the node natively at `ratio` (width over height), taking the
+   * offered width within `minWidth` and `maxWidth`, or the width that fits an
+   * exact height.
+   */
+  setAspectMeasure(ratio: number, minWidth?: number, maxWidth?: number): void;
+  /** Measures the node natively at the offered size, within bounds. */
+  setClampMeasure(
+    minWidth?: number,
+    minHeight?: number,
+    maxWidth?: number,
+    maxHeight?: number,
+  ): void;
   setMinHeight(minHeight: number | `${number}%` | undefined): void;
   setMinHeightPercent(minHeight: number | undefined): void;
   setMinWidth(minWidth: number | `${number}%` | undefined): void;
@@ -162,9 +352,34 @@ export type Node = {
   setWidth(width: number | "auto" | `${number}%` | undefined): void;
   setWidthAuto(): void;
   setWidthPercent(width: number | undefined): void;
+  /**
+   * Turns the node into a virtual list of `count` items along its main axis.
+   * Only the items in `getVirtualRange()` are expected as children; the space
+   * of the others is reserved by main-axis padding, which the list owns.
+   * Item sizes include main-axis margins and gap, start at
+   * `estimatedItemSize` and are replaced by measured sizes after each layout.
+   */
+  setVirtualItemCount(count: number, estimatedItemSize: number): void;
+  setVirtualItemSize(index: number, size: number): void;
+  /**
+   * Selects the items overlapping [offset, offset + length) plus `overscan`
+   * items on either side.
+   */
+  setVirtualWindow(offset: number, length: number, overscan?: number): void;
+  getVirtualRange(): { start: number; end: number };
+  getVirtualContentSize(): number;
+  getVirtualItemOffset(index: number): number;
+  unsetVirtualList(): void;
+  unsetBulkMeasureFunc(): void;
   unsetDirtiedFunc(): void;
   unsetMeasureFunc(): void;
   setAlwaysFormsContainingBlock(alwaysFormsContainingBlock: boolean): void;
+  /**
+   * Freezes the subtree as it is, so it can be read while the live tree is
+   * changed and laid out again. The version shares its nodes with the live
+   * tree; changing a node copies the path from it up to the root, once.
+   */
+  snapshot(): TreeVersion;
 };
 export type Yoga = {
   Config: {
@@ -175,6 +390,45 @@ export type Yoga = {
     create(config?: Config): Node;
     createDefault(): Node;
     createWithConfig(config: Config): Node;
+    deserialize(snapshot: ArrayBuffer | ArrayBufferView, config?: Config): Node;
     destroy(node: Node): void;
+    fromId(id: number): Node | undefined;
   };
+  setDirtiedQueueEnabled(enabled: boolean): void;
+  drainDirtiedQueue(): Uint32Array;
+  /**
+   * Keeps up to `capacity` finished layouts, keyed by the content of the laid
+   * out subtree and its constraints, and copies them onto matching subtrees
+   * instead of laying them out again. 0 disables the cache.
+   */
+  setLayoutCacheCapacity(capacity: number): void;
+  clearLayoutCache(): void;
+  /**
+   * Dirties every measured node under `root` tagged with `tag`, e.g. once a
+   * font has loaded, so they are measured again. Returns how many matched.
+   */
+  markDirtyByTag(root: Node, tag: number): number;
+  getLayoutCacheStats(): LayoutCacheStats;
+  getMemoryStats(): MemoryStats;
+  /**
+   * Records what dirties nodes, for debugging unexpected relayouts. Stacks
+   * are costly to capture and off by default. Disabling drops the records.
+   */
+  setDirtyTracingEnabled(enabled: boolean, captureStacks?: boolean): void;
+  /** Returns and clears the traces of layouts that had dirty nodes. */
+  takeDirtyTrace(): LayoutTrace[];
+  /**
+   * Records every binding call, with the nodes it creates and the results of
+   * measure functions, for replay with `yoga_replay`. Start before building
+   * the trees to capture.
+   */
+  startRecording(): void;
+  /** Stops recording and returns the trace. */
+  stopRecording(): ArrayBuffer | undefined;
+  /**
+   * Calls per binding function since the last reset, most expensive first.
+   * Throws unless the binding was built with `-DYOGA_NODE_API_PROFILE=ON`.
+   */
+  getCallProfile(): CallProfileEntry[];
+  resetCallProfile(): void;
 } & typeof YGEnums;
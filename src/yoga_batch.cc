@@ -0,0 +1,549 @@
+#include "json_tree.h"
+#include "snapshot.h"
+#include "yoga/YGConfig.h"
+#include "yoga/YGNode.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/node/Node.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headless batch layout. Reads layout documents from files or stdin, lays them
+// out on all cores and writes the frames of every node.
+//
+// Each input is one of:
+//
+//   - a single snapshot, as written by `Node.serialize`
+//   - a stream of snapshots, each prefixed by its u32 byte length
+//   - newline-delimited JSON trees, see json_tree.h
+//
+// and documents are numbered across inputs in the order they are read. The
+// output is little-endian and frames are written in document order:
+//
+//   header:  "YGFR" | u16 version | u16 reserved
+//   frame:   u32 document | u32 node count | node count * f32 left, top,
+//            width, height
+//
+// Nodes are in preorder and positions are relative to the parent, as with
+// `getComputedLayout`. A document that fails to load gets a frame without
+// nodes and an error on stderr.
+
+namespace {
+
+constexpr char kFrameMagic[4] = {'Y', 'G', 'F', 'R'};
+constexpr uint16_t kFrameVersion = 1;
+constexpr size_t kDocumentsPerThread = 256;
+
+const char *kUsage =
+    "Usage: yoga_batch [options] [files...]\n"
+    "\n"
+    "Reads from stdin if no files (or \"-\") are given.\n"
+    "\n"
+    "  -o, --output <file>  write frames to <file> instead of stdout\n"
+    "  -j, --threads <n>    worker threads (default: all cores)\n"
+    "  --width <points>     available width (default: undefined)\n"
+    "  --height <points>    available height (default: undefined)\n"
+    "  --rtl                lay out right-to-left\n"
+    "  --scale <factor>     point scale factor (default: 1)\n"
+    "  -q, --quiet          don't print statistics\n";
+
+struct Options {
+  float width = YGUndefined;
+  float height = YGUndefined;
+  YGDirection direction = YGDirectionLTR;
+  float pointScaleFactor = 1;
+  unsigned threads = 0;
+  bool quiet = false;
+  const char *output = NULL;
+  std::vector<const char *> inputs;
+};
+
+enum class Format { Snapshot, SnapshotStream, Json };
+
+struct Document {
+  uint32_t index;
+  Format format;
+  std::string data;
+  std::vector<uint8_t> frame;
+  uint32_t nodeCount;
+  std::string error;
+};
+
+// Buffered reading with enough lookahead to detect the format of an input.
+class Input {
+public:
+  explicit Input(FILE *file) : file_(file), buffer_(1 << 20) {}
+
+  // Makes at least `count` bytes available unless the input ends first.
+  size_t available(size_t count) {
+    if (end_ - pos_ < count) {
+      std::memmove(buffer_.data(), buffer_.data() + pos_, end_ - pos_);
+      end_ -= pos_;
+      pos_ = 0;
+      if (buffer_.size() < count) {
+        buffer_.resize(count);
+      }
+      while (end_ < count) {
+        size_t read =
+            std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+        if (read == 0) {
+          break;
+        }
+        end_ += read;
+      }
+    }
+    return end_ - pos_;
+  }
+
+  const char *data() const { return buffer_.data() + pos_; }
+
+  bool read(std::string &out, size_t count) {
+    out.clear();
+    while (out.size() < count) {
+      size_t size = available(1);
+      if (size == 0) {
+        return false;
+      }
+      size = std::min(size, count - out.size());
+      out.append(data(), size);
+      pos_ += size;
+    }
+    return true;
+  }
+
+  bool readLine(std::string &out) {
+    out.clear();
+    while (available(1) > 0) {
+      const char *start = data();
+      const char *newline = (const char *)std::memchr(start, '\n', end_ - pos_);
+      size_t size = newline != NULL ? newline - start : end_ - pos_;
+      out.append(start, size);
+      pos_ += size;
+      if (newline != NULL) {
+        pos_++;
+        return true;
+      }
+    }
+    return !out.empty();
+  }
+
+  void readAll(std::string &out) {
+    out.clear();
+    while (available(1) > 0) {
+      out.append(data(), end_ - pos_);
+      pos_ = end_;
+    }
+  }
+
+private:
+  FILE *file_;
+  std::vector<char> buffer_;
+  size_t pos_ = 0;
+  size_t end_ = 0;
+};
+
+Format detectFormat(Input &input) {
+  size_t size = input.available(8);
+  const char *data = input.data();
+  if (size >= 4 && std::memcmp(data, "YGSN", 4) == 0) {
+    return Format::Snapshot;
+  }
+  if (size >= 8 && std::memcmp(data + 4, "YGSN", 4) == 0) {
+    return Format::SnapshotStream;
+  }
+  return Format::Json;
+}
+
+// Reads documents from the inputs in order.
+class DocumentReader {
+public:
+  explicit DocumentReader(std::vector<const char *> const &paths)
+      : paths_(paths) {}
+
+  ~DocumentReader() { close(); }
+
+  bool failed() const { return failed_; }
+
+  bool next(Document &document) {
+    while (true) {
+      if (input_ == NULL && !open()) {
+        return false;
+      }
+      if (readDocument(document)) {
+        document.index = count_++;
+        return true;
+      }
+      close();
+    }
+  }
+
+private:
+  bool open() {
+    if (next_ >= paths_.size()) {
+      return false;
+    }
+    const char *path = paths_[next_++];
+    file_ = std::strcmp(path, "-") == 0 ? stdin : std::fopen(path, "rb");
+    if (file_ == NULL) {
+      std::fprintf(stderr, "yoga_batch: can't open %s\n", path);
+      failed_ = true;
+      return open();
+    }
+    input_ = std::make_unique<Input>(file_);
+    format_ = detectFormat(*input_);
+    return true;
+  }
+
+  void close() {
+    input_.reset();
+    if (file_ != NULL && file_ != stdin) {
+      std::fclose(file_);
+    }
+    file_ = NULL;
+  }
+
+  bool readDocument(Document &document) {
+    document.format = format_;
+    switch (format_) {
+    case Format::Snapshot:
+      input_->readAll(document.data);
+      // Nothing is left, which reads as the end of a stream.
+      format_ = Format::SnapshotStream;
+      return !document.data.empty();
+    case Format::SnapshotStream: {
+      uint32_t size = 0;
+      if (input_->available(sizeof(size)) < sizeof(size)) {
+        return false;
+      }
+      std::string prefix;
+      input_->read(prefix, sizeof(size));
+      std::memcpy(&size, prefix.data(), sizeof(size));
+      if (!input_->read(document.data, size)) {
+        std::fprintf(stderr, "yoga_batch: truncated snapshot stream\n");
+        failed_ = true;
+        return false;
+      }
+      return true;
+    }
+    case Format::Json:
+      while (input_->readLine(document.data)) {
+        if (document.data.find_first_not_of(" \t\r") != std::string::npos) {
+          return true;
+        }
+      }
+      return false;
+    }
+    return false;
+  }
+
+  std::vector<const char *> const &paths_;
+  size_t next_ = 0;
+  FILE *file_ = NULL;
+  std::unique_ptr<Input> input_;
+  Format format_ = Format::Json;
+  uint32_t count_ = 0;
+  bool failed_ = false;
+};
+
+// Runs batches of tasks on a fixed set of threads. Tasks are claimed one at a
+// time, so uneven documents don't leave threads idle.
+class WorkerPool {
+public:
+  using Task = std::function<void(unsigned worker, size_t index)>;
+
+  explicit WorkerPool(unsigned count) {
+    for (unsigned i = 0; i < count; i++) {
+      threads_.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread : threads_) {
+      thread.join();
+    }
+  }
+
+  // Starts running `task` for indexes [0, count) and returns right away.
+  void start(size_t count, Task task) {
+    auto batch = std::make_shared<Batch>();
+    batch->task = std::move(task);
+    batch->count = count;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batch_ = batch;
+      pending_ = count;
+    }
+    wake_.notify_all();
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return pending_ == 0; });
+  }
+
+private:
+  // Workers that finish late may still claim from a batch after it's done,
+  // so each batch has its own counter.
+  struct Batch {
+    Task task;
+    size_t count;
+    std::atomic<size_t> next{0};
+  };
+
+  void work(unsigned worker) {
+    std::shared_ptr<Batch> seen;
+    while (true) {
+      std::shared_ptr<Batch> batch;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&] { return stopping_ || batch_ != seen; });
+        if (stopping_) {
+          return;
+        }
+        batch = seen = batch_;
+      }
+      size_t finished = 0;
+      for (size_t i; (i = batch->next.fetch_add(1)) < batch->count;) {
+        batch->task(worker, i);
+        finished++;
+      }
+      if (finished > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ -= finished;
+        if (pending_ == 0) {
+          done_.notify_all();
+        }
+      }
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  std::shared_ptr<Batch> batch_;
+  size_t pending_ = 0;
+  bool stopping_ = false;
+};
+
+template <typename T> void append(std::vector<uint8_t> &out, T value) {
+  size_t offset = out.size();
+  out.resize(offset + sizeof(T));
+  std::memcpy(out.data() + offset, &value, sizeof(T));
+}
+
+void layoutDocument(Document &document, YGConfigConstRef config,
+                    Options const &options) {
+  std::deque<MeasurePreset> presets;
+  std::vector<YGNodeRef> nodes;
+  bool loaded;
+  document.error.clear();
+  if (document.format == Format::Json) {
+    loaded =
+        parseJsonTree(document.data, config, nodes, presets, document.error);
+  } else {
+    loaded = deserializeTree(
+        (const uint8_t *)document.data.data(), document.data.size(),
+        [config] { return YGNodeNewWithConfig(config); },
+        [&presets](YGNodeRef node, MeasurePreset const &preset) {
+          presets.push_back(preset);
+          YGNodeSetContext(node, &presets.back());
+          YGNodeSetMeasureFunc(node, &measureJsonPreset);
+        },
+        nodes);
+    if (!loaded) {
+      document.error = "malformed snapshot";
+    }
+  }
+
+  document.nodeCount = loaded ? nodes.size() : 0;
+  document.frame.clear();
+  append(document.frame, document.index);
+  append(document.frame, document.nodeCount);
+  if (!loaded) {
+    // The tree may be incomplete, so free the nodes one by one.
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+      YGNodeFree(*it);
+    }
+    return;
+  }
+
+  // Snapshots come with a layout, which has to be redone for these options.
+  for (YGNodeRef node : nodes) {
+    facebook::yoga::resolveRef(node)->setDirty(true);
+  }
+  YGNodeCalculateLayout(nodes[0], options.width, options.height,
+                        options.direction);
+  document.frame.reserve(document.frame.size() +
+                         nodes.size() * 4 * sizeof(float));
+  for (YGNodeRef node : nodes) {
+    append(document.frame, YGNodeLayoutGetLeft(node));
+    append(document.frame, YGNodeLayoutGetTop(node));
+    append(document.frame, YGNodeLayoutGetWidth(node));
+    append(document.frame, YGNodeLayoutGetHeight(node));
+  }
+  YGNodeFreeRecursive(nodes[0]);
+}
+
+bool parseFloat(const char *text, float &value) {
+  char *end = NULL;
+  value = std::strtof(text, &end);
+  return *text != '\0' && *end == '\0';
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+    auto takesValue = [&](const char *name) {
+      if (arg != name) {
+        return false;
+      }
+      if (value == NULL) {
+        std::fprintf(stderr, "yoga_batch: %s needs a value\n", name);
+        std::exit(2);
+      }
+      i++;
+      return true;
+    };
+    bool valid = true;
+    if (arg == "-h" || arg == "--help") {
+      std::fputs(kUsage, stdout);
+      std::exit(0);
+    } else if (takesValue("-o") || takesValue("--output")) {
+      options.output = value;
+    } else if (takesValue("-j") || takesValue("--threads")) {
+      options.threads = std::strtoul(value, NULL, 10);
+      valid = options.threads > 0;
+    } else if (takesValue("--width")) {
+      valid = parseFloat(value, options.width);
+    } else if (takesValue("--height")) {
+      valid = parseFloat(value, options.height);
+    } else if (takesValue("--scale")) {
+      valid = parseFloat(value, options.pointScaleFactor);
+    } else if (arg == "--rtl") {
+      options.direction = YGDirectionRTL;
+    } else if (arg == "-q" || arg == "--quiet") {
+      options.quiet = true;
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      std::fprintf(stderr, "yoga_batch: unknown option %s\n\n%s", arg.c_str(),
+                   kUsage);
+      return false;
+    } else {
+      options.inputs.push_back(argv[i]);
+    }
+    if (!valid) {
+      std::fprintf(stderr, "yoga_batch: invalid value for %s\n", arg.c_str());
+      return false;
+    }
+  }
+  if (options.inputs.empty()) {
+    options.inputs.push_back("-");
+  }
+  if (options.threads == 0) {
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 2;
+  }
+
+  FILE *output = options.output != NULL ? std::fopen(options.output, "wb")
+                                        : stdout;
+  if (output == NULL) {
+    std::fprintf(stderr, "yoga_batch: can't write %s\n", options.output);
+    return 2;
+  }
+  std::fwrite(kFrameMagic, 1, sizeof(kFrameMagic), output);
+  uint16_t header[2] = {kFrameVersion, 0};
+  std::fwrite(header, sizeof(uint16_t), 2, output);
+
+  std::vector<YGConfigRef> configs;
+  for (unsigned i = 0; i < options.threads; i++) {
+    YGConfigRef config = YGConfigNew();
+    YGConfigSetPointScaleFactor(config, options.pointScaleFactor);
+    configs.push_back(config);
+  }
+
+  // The next batch is read while the current one is laid out.
+  size_t batchSize = kDocumentsPerThread * options.threads;
+  std::vector<Document> current, next;
+  DocumentReader reader(options.inputs);
+  WorkerPool pool(options.threads);
+  size_t documents = 0, nodes = 0, failures = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  auto readBatch = [&](std::vector<Document> &batch) {
+    batch.resize(batchSize);
+    size_t count = 0;
+    while (count < batchSize && reader.next(batch[count])) {
+      count++;
+    }
+    batch.resize(count);
+  };
+
+  readBatch(current);
+  while (!current.empty()) {
+    pool.start(current.size(), [&](unsigned worker, size_t i) {
+      layoutDocument(current[i], configs[worker], options);
+    });
+    readBatch(next);
+    pool.wait();
+    for (Document const &document : current) {
+      if (!document.error.empty()) {
+        std::fprintf(stderr, "yoga_batch: document %u: %s\n", document.index,
+                     document.error.c_str());
+        failures++;
+      }
+      std::fwrite(document.frame.data(), 1, document.frame.size(), output);
+      nodes += document.nodeCount;
+    }
+    documents += current.size();
+    current.swap(next);
+  }
+
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  if (!options.quiet) {
+    std::fprintf(stderr,
+                 "yoga_batch: %zu documents, %zu nodes in %.3fs "
+                 "(%.0f documents/s on %u threads)\n",
+                 documents, nodes, elapsed.count(),
+                 documents / elapsed.count(), options.threads);
+  }
+
+  for (YGConfigRef config : configs) {
+    YGConfigFree(config);
+  }
+  bool written = std::fflush(output) == 0;
+  if (output != stdout) {
+    written = std::fclose(output) == 0 && written;
+  }
+  if (!written) {
+    std::fprintf(stderr, "yoga_batch: failed to write the output\n");
+    return 1;
+  }
+  return failures > 0 || reader.failed() ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+#include "napi_util.h"
+#include "node_context.h"
+#include "persistent_tree.h"
+#include "yoga/YGNode.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include <initializer_list>
+
+// Flat C exports for Deno FFI. Nodes are addressed by their registry id and
+// every parameter is a number (or a buffer), so the calls qualify for V8 fast
+// calls. Fast calls must not re-enter JS: dirtied callbacks triggered by a
+// setter are deferred, and setters return how many are pending so the caller
+// can deliver them through the N-API `flushDeferredDirtied`. Each setter is
+// recorded as the current call, so dirty tracing attributes it correctly, and
+// call traces record it as the N-API method it stands in for.
+//
+// Anything that may call into JS, such as calculateLayout with measure
+// functions, stays on the N-API path.
+
+template <typename Fn>
+static uint32_t mutate(const char *name, const char *napiName, uint32_t id,
+                       std::initializer_list<double> args, Fn fn) {
+  YGNodeRef node = nodeRegistry.get(id);
+  if (node == NULL) {
+    return 0;
+  }
+  NapiCallScope callScope(name);
+  if (ffiCallHook != NULL && callScope.previous == NULL) {
+    ffiCallHook(napiName, id, args.begin(), args.size());
+  }
+  prepareWrite(node);
+  deferDirtiedCallbacks = true;
+  fn(node);
+  deferDirtiedCallbacks = false;
+  return deferredDirtied.size();
+}
+
+#define FFI_SETTER(name, call)                                                 \
+  extern "C" uint32_t YGFFI_##name(uint32_t id, double value) {                \
+    return mutate(__func__, "Node_" #name, id, {value},                        \
+                  [&](YGNodeRef node) { call(node, value); });                 \
+  }
+
+#define FFI_AUTO_SETTER(name, call)                                            \
+  extern "C" uint32_t YGFFI_##name(uint32_t id) {                              \
+    return mutate(__func__, "Node_" #name, id, {},                             \
+                  [&](YGNodeRef node) { call(node); });                        \
+  }
+
+#define FFI_ENUM_SETTER(name, call, type)                                      \
+  extern "C" uint32_t YGFFI_##name(uint32_t id, int32_t value) {               \
+    return mutate(__func__, "Node_" #name, id, {(double)value},                \
+                  [&](YGNodeRef node) {                                        \
+                    call(node, static_cast<type>(value));                      \
+                  });                                                          \
+  }
+
+#define FFI_EDGE_SETTER(name, call, type)                                      \
+  extern "C" uint32_t YGFFI_##name(uint32_t id, int32_t edge, double value) {  \
+    return mutate(__func__, "Node_" #name, id, {(double)edge, value},          \
+                  [&](YGNodeRef node) {                                        \
+                    call(node, static_cast<type>(edge), value);                \
+                  });                                                          \
+  }
+
+#define FFI_EDGE_AUTO_SETTER(name, call)                                       \
+  extern "C" uint32_t YGFFI_##name(uint32_t id, int32_t edge) {                \
+    return mutate(__func__, "Node_" #name, id, {(double)edge},                 \
+                  [&](YGNodeRef node) {                                        \
+                    call(node, static_cast<YGEdge>(edge));                     \
+                  });                                                          \
+  }
+
+#define FFI_LAYOUT_GETTER(name, call)                                          \
+  extern "C" double YGFFI_##name(uint32_t id) {                                \
+    YGNodeRef node = nodeRegistry.get(id);                                     \
+    return node != NULL ? call(node) : YGUndefined;                            \
+  }
+
+FFI_SETTER(setWidth, YGNodeStyleSetWidth)
+FFI_SETTER(setWidthPercent, YGNodeStyleSetWidthPercent)
+FFI_AUTO_SETTER(setWidthAuto, YGNodeStyleSetWidthAuto)
+FFI_SETTER(setHeight, YGNodeStyleSetHeight)
+FFI_SETTER(setHeightPercent, YGNodeStyleSetHeightPercent)
+FFI_AUTO_SETTER(setHeightAuto, YGNodeStyleSetHeightAuto)
+FFI_SETTER(setMinWidth, YGNodeStyleSetMinWidth)
+FFI_SETTER(setMinWidthPercent, YGNodeStyleSetMinWidthPercent)
+FFI_SETTER(setMinHeight, YGNodeStyleSetMinHeight)
+FFI_SETTER(setMinHeightPercent, YGNodeStyleSetMinHeightPercent)
+FFI_SETTER(setMaxWidth, YGNodeStyleSetMaxWidth)
+FFI_SETTER(setMaxWidthPercent, YGNodeStyleSetMaxWidthPercent)
+FFI_SETTER(setMaxHeight, YGNodeStyleSetMaxHeight)
+FFI_SETTER(setMaxHeightPercent, YGNodeStyleSetMaxHeightPercent)
+FFI_SETTER(setFlexBasis, YGNodeStyleSetFlexBasis)
+FFI_SETTER(setFlexBasisPercent, YGNodeStyleSetFlexBasisPercent)
+FFI_AUTO_SETTER(setFlexBasisAuto, YGNodeStyleSetFlexBasisAuto)
+FFI_SETTER(setFlex, YGNodeStyleSetFlex)
+FFI_SETTER(setFlexGrow, YGNodeStyleSetFlexGrow)
+FFI_SETTER(setFlexShrink, YGNodeStyleSetFlexShrink)
+FFI_SETTER(setAspectRatio, YGNodeStyleSetAspectRatio)
+
+FFI_EDGE_SETTER(setMargin, YGNodeStyleSetMargin, YGEdge)
+FFI_EDGE_SETTER(setMarginPercent, YGNodeStyleSetMarginPercent, YGEdge)
+FFI_EDGE_AUTO_SETTER(setMarginAuto, YGNodeStyleSetMarginAuto)
+FFI_EDGE_SETTER(setPadding, YGNodeStyleSetPadding, YGEdge)
+FFI_EDGE_SETTER(setPaddingPercent, YGNodeStyleSetPaddingPercent, YGEdge)
+FFI_EDGE_SETTER(setPosition, YGNodeStyleSetPosition, YGEdge)
+FFI_EDGE_SETTER(setPositionPercent, YGNodeStyleSetPositionPercent, YGEdge)
+FFI_EDGE_SETTER(setBorder, YGNodeStyleSetBorder, YGEdge)
+FFI_EDGE_SETTER(setGap, YGNodeStyleSetGap, YGGutter)
+FFI_EDGE_SETTER(setGapPercent, YGNodeStyleSetGapPercent, YGGutter)
+
+FFI_ENUM_SETTER(setDirection, YGNodeStyleSetDirection, YGDirection)
+FFI_ENUM_SETTER(setFlexDirection, YGNodeStyleSetFlexDirection,
+                YGFlexDirection)
+FFI_ENUM_SETTER(setJustifyContent, YGNodeStyleSetJustifyContent, YGJustify)
+FFI_ENUM_SETTER(setAlignContent, YGNodeStyleSetAlignContent, YGAlign)
+FFI_ENUM_SETTER(setAlignItems, YGNodeStyleSetAlignItems, YGAlign)
+FFI_ENUM_SETTER(setAlignSelf, YGNodeStyleSetAlignSelf, YGAlign)
+FFI_ENUM_SETTER(setPositionType, YGNodeStyleSetPositionType, YGPositionType)
+FFI_ENUM_SETTER(setFlexWrap, YGNodeStyleSetFlexWrap, YGWrap)
+FFI_ENUM_SETTER(setOverflow, YGNodeStyleSetOverflow, YGOverflow)
+FFI_ENUM_SETTER(setDisplay, YGNodeStyleSetDisplay, YGDisplay)
+
+FFI_LAYOUT_GETTER(getComputedLeft, YGNodeLayoutGetLeft)
+FFI_LAYOUT_GETTER(getComputedRight, YGNodeLayoutGetRight)
+FFI_LAYOUT_GETTER(getComputedTop, YGNodeLayoutGetTop)
+FFI_LAYOUT_GETTER(getComputedBottom, YGNodeLayoutGetBottom)
+FFI_LAYOUT_GETTER(getComputedWidth, YGNodeLayoutGetWidth)
+FFI_LAYOUT_GETTER(getComputedHeight, YGNodeLayoutGetHeight)
+
+// Writes left, right, top, bottom, width and height to `out`.
+extern "C" void YGFFI_getComputedLayout(uint32_t id, double *out) {
+  YGNodeRef node = nodeRegistry.get(id);
+  if (node == NULL) {
+    return;
+  }
+  out[0] = YGNodeLayoutGetLeft(node);
+  out[1] = YGNodeLayoutGetRight(node);
+  out[2] = YGNodeLayoutGetTop(node);
+  out[3] = YGNodeLayoutGetBottom(node);
+  out[4] = YGNodeLayoutGetWidth(node);
+  out[5] = YGNodeLayoutGetHeight(node);
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+// deno-lint-ignore-file no-explicit-any
+
+// Deno FFI backend: style setters and layout getters are routed through the
+// flat `YGFFI_*` exports of the library, which take node ids and numbers and
+// so qualify for V8 fast calls. Everything else keeps using N-API.
+
+const value = { parameters: ["u32", "f64"], result: "u32" } as const;
+const auto = { parameters: ["u32"], result: "u32" } as const;
+const enumValue = { parameters: ["u32", "i32"], result: "u32" } as const;
+const edgeValue = { parameters: ["u32", "i32", "f64"], result: "u32" } as const;
+const edgeAuto = { parameters: ["u32", "i32"], result: "u32" } as const;
+const getter = { parameters: ["u32"], result: "f64" } as const;
+
+const setters = {
+  setWidth: value,
+  setWidthPercent: value,
+  setWidthAuto: auto,
+  setHeight: value,
+  setHeightPercent: value,
+  setHeightAuto: auto,
+  setMinWidth: value,
+  setMinWidthPercent: value,
+  setMinHeight: value,
+  setMinHeightPercent: value,
+  setMaxWidth: value,
+  setMaxWidthPercent: value,
+  setMaxHeight: value,
+  setMaxHeightPercent: value,
+  setFlexBasis: value,
+  setFlexBasisPercent: value,
+  setFlexBasisAuto: auto,
+  setFlex: value,
+  setFlexGrow: value,
+  setFlexShrink: value,
+  setAspectRatio: value,
+  setMargin: edgeValue,
+  setMarginPercent: edgeValue,
+  setMarginAuto: edgeAuto,
+  setPadding: edgeValue,
+  setPaddingPercent: edgeValue,
+  setPosition: edgeValue,
+  setPositionPercent: edgeValue,
+  setBorder: edgeValue,
+  setGap: edgeValue,
+  setGapPercent: edgeValue,
+  setDirection: enumValue,
+  setFlexDirection: enumValue,
+  setJustifyContent: enumValue,
+  setAlignContent: enumValue,
+  setAlignItems: enumValue,
+  setAlignSelf: enumValue,
+  setPositionType: enumValue,
+  setFlexWrap: enumValue,
+  setOverflow: enumValue,
+  setDisplay: enumValue,
+} as const;
+
+const getters = {
+  getComputedLeft: getter,
+  getComputedRight: getter,
+  getComputedTop: getter,
+  getComputedBottom: getter,
+  getComputedWidth: getter,
+  getComputedHeight: getter,
+} as const;
+
+export const ffiSymbols = Object.fromEntries(
+  [
+    ...Object.entries({ ...setters, ...getters }),
+    ["getComputedLayout", { parameters: ["u32", "buffer"], result: "void" }],
+  ].map(([name, signature]) => [`YGFFI_${name}`, signature]),
+) as Record<string, Deno.ForeignFunction>;
+
+type Methods = Record<string, (this: any, ...args: any[]) => any>;
+
+// The Node methods of each backend, e.g. for comparing them side by side.
+// `ffi` stays undefined unless the FFI backend was installed.
+export const backends: { napi: Methods; ffi?: Methods } = { napi: {} };
+
+export function installFFIBackend(lib: any, path: string): boolean {
+  if (
+    typeof Deno?.dlopen !== "function" ||
+    Deno.permissions.querySync?.({ name: "ffi" }).state !== "granted"
+  ) {
+    return false;
+  }
+
+  let symbols: Record<string, (...args: any[]) => any>;
+  try {
+    symbols = Deno.dlopen(path, ffiSymbols).symbols as any;
+  } catch {
+    return false;
+  }
+
+  const prototype = lib.Node.prototype;
+  const getId = prototype.getId;
+  const flushDeferredDirtied = lib.flushDeferredDirtied;
+  const id = (node: any): number => node._id ?? (node._id = getId.call(node));
+
+  const ffi: Methods = {};
+  for (const [name, signature] of Object.entries(setters)) {
+    const fn = symbols[`YGFFI_${name}`];
+    // A non-zero result means dirtied callbacks are waiting to be delivered.
+    switch (signature) {
+      case value:
+        ffi[name] = function (this: any, v: number) {
+          if (fn(id(this), v ?? NaN) !== 0) flushDeferredDirtied();
+        };
+        break;
+      case auto:
+        ffi[name] = function (this: any) {
+          if (fn(id(this)) !== 0) flushDeferredDirtied();
+        };
+        break;
+      case edgeValue:
+        ffi[name] = function (this: any, edge: number, v: number) {
+          if (fn(id(this), edge, v ?? NaN) !== 0) flushDeferredDirtied();
+        };
+        break;
+      default:
+        ffi[name] = function (this: any, v: number) {
+          if (fn(id(this), v) !== 0) flushDeferredDirtied();
+        };
+    }
+  }
+  for (const name of Object.keys(getters)) {
+    const fn = symbols[`YGFFI_${name}`];
+    ffi[name] = function (this: any) {
+      return fn(id(this));
+    };
+  }
+  const layout = new Float64Array(6);
+  const getComputedLayout = symbols.YGFFI_getComputedLayout;
+  ffi.getComputedLayout = function (this: any) {
+    getComputedLayout(id(this), layout);
+    return {
+      left: layout[0],
+      right: layout[1],
+      top: layout[2],
+      bottom: layout[3],
+      width: layout[4],
+      height: layout[5],
+    };
+  };
+
+  for (const [name, fn] of Object.entries(ffi)) {
+    backends.napi[name] = prototype[name];
+    prototype[name] = fn;
+  }
+  backends.ffi = ffi;
+  return true;
+}
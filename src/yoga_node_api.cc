@@ -1,12 +1,38 @@
+#include "call_trace.h"
+#include "content_size.h"
+#include "damage.h"
+#include "intrinsic_sizes.h"
 #include "js_native_api.h"
 #include "js_native_api_types.h"
+#include "layout_cache.h"
+#include "measure_preset.h"
 #include "napi_util.h"
+#include "node_context.h"
+#include "persistent_tree.h"
+#include "pixel_grid.h"
+#include "snapshot.h"
+#include "spatial_index.h"
+#include "virtual_list.h"
 #include "yoga/YGConfig.h"
 #include "yoga/YGNode.h"
 #include "yoga/YGNodeLayout.h"
 #include "yoga/YGNodeStyle.h"
+#include "yoga/config/Config.h"
+#include "yoga/node/Node.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstddef>
 #include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+using facebook::yoga::resolveRef;
 
 // Objects
 
@@ -18,36 +44,436 @@ inline napi_value YGValueToJS(napi_env env, YGValue const &value) {
   return obj;
 }
 
+// Native memory owned by the binding. It is reported to the engine as external
+// memory, so that garbage collection is scheduled with it in mind.
+
+struct MemoryStats {
+  int64_t liveNodes;
+  int64_t liveConfigs;
+  int64_t freedNodes;
+  int64_t freedConfigs;
+  // Configs whose wrapper was collected without them being freed.
+  int64_t leakedConfigs;
+  int64_t bytes;
+  int64_t peakBytes;
+};
+
+thread_local MemoryStats memoryStats = {};
+
+constexpr int64_t kNodeBytes =
+    sizeof(facebook::yoga::Node) + sizeof(NodeContext);
+constexpr int64_t kConfigBytes = sizeof(facebook::yoga::Config);
+
+static void adjustNativeMemory(napi_env env, int64_t delta) {
+  memoryStats.bytes += delta;
+  memoryStats.peakBytes = std::max(memoryStats.peakBytes, memoryStats.bytes);
+  int64_t adjusted;
+  napi_adjust_external_memory(env, delta, &adjusted);
+}
+
+// Spatial indexes are keyed by their root and rebuilt lazily whenever a layout
+// ran or a node was freed since they were built.
+
+thread_local uint64_t layoutGeneration = 1;
+thread_local std::unordered_map<YGNodeRef, SpatialIndex> spatialIndexes;
+
+inline void invalidateLayoutQueries() { layoutGeneration++; }
+
+static void forgetSpatialIndex(YGNodeRef node) {
+  if (!spatialIndexes.empty()) {
+    spatialIndexes.erase(node);
+  }
+}
+
+static SpatialIndex &spatialIndexFor(YGNodeRef root) {
+  SpatialIndex &index = spatialIndexes[root];
+  if (index.generation != layoutGeneration) {
+    index.build(root);
+    index.generation = layoutGeneration;
+  }
+  return index;
+}
+
+// Damage tracking. Roots with tracking enabled collect the old and new frames
+// of every node whose frame changed in a layout, see damage.h. Nodes leaving a
+// tracked tree leave their last frame behind.
+
+thread_local std::unordered_map<YGNodeRef, DamageRegion> damageRegions;
+
+// Returns the region of the nearest tracked node at or above `node`.
+static DamageRegion *trackedDamageRegion(YGNodeRef node) {
+  if (damageRegions.empty()) {
+    return NULL;
+  }
+  for (; node != NULL; node = liveParent(node)) {
+    auto found = damageRegions.find(node);
+    if (found != damageRegions.end()) {
+      return &found->second;
+    }
+  }
+  return NULL;
+}
+
+static void damageDetached(YGNodeRef node) {
+  DamageRegion *region = trackedDamageRegion(liveParent(node));
+  if (region != NULL) {
+    forgetDamageFrame(node, *region);
+  }
+}
+
+// Content sizes. Roots with content sizes enabled update the content extents
+// of their nodes after every layout, see content_size.h. Elsewhere they are
+// computed when asked for.
+
+thread_local std::unordered_set<YGNodeRef> contentSizeRoots;
+
+static bool hasCurrentContentExtent(YGNodeRef node) {
+  if (contentSizeRoots.empty() || !nodeContext(node)->hasContentExtent) {
+    return false;
+  }
+  for (YGNodeRef at = node; at != NULL; at = liveParent(at)) {
+    if (contentSizeRoots.count(at) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+thread_local NodeRegistry nodeRegistry;
+thread_local LayoutCache layoutCache;
+
+inline napi_value nodeToJS(napi_env env, YGNodeRef node) {
+  NodeContext *ctx = nodeContext(node);
+  if (ctx == NULL || ctx->frozen) {
+    return NULL;
+  }
+  napi_value jsNode = NULL;
+  napi_get_reference_value(env, ctx->ref, &jsNode);
+  return jsNode;
+}
+
+// Dirtied notifications are either delivered to `_dirtiedFunc` right away or,
+// once the queue is enabled, recorded here (at most once per node) until
+// drained.
+
+thread_local bool dirtiedQueueEnabled = false;
+thread_local std::vector<uint32_t> dirtiedQueue;
+thread_local bool deferDirtiedCallbacks = false;
+thread_local void (*ffiCallHook)(const char *name, uint32_t id,
+                                 double const *args, size_t argc) = NULL;
+thread_local std::vector<uint32_t> deferredDirtied;
+
+static void globalDirtiedFunc(YGNodeConstRef nodeRef);
+
+// Frozen layouts. A node with its layout frozen is kept dirty, so changes
+// below it stop there instead of dirtying its ancestors. Layouts of roots
+// above it mark it clean for the duration of the pass, so Yoga reuses its
+// last layout rather than descending into it.
+
+thread_local std::unordered_set<YGNodeRef> layoutFrozenNodes;
+
+// Sets the dirty flag of `node` alone, without dirtied callbacks.
+static void setDirtyQuietly(YGNodeRef node, bool dirty) {
+  YGNodeSetDirtiedFunc(node, NULL);
+  resolveRef(node)->setDirty(dirty);
+  YGNodeSetDirtiedFunc(node, &globalDirtiedFunc);
+}
+
+// Dirty tracing. While enabled, every call that dirties a clean node records
+// an event naming the node and the binding function, optionally with a JS
+// stack. The nodes a call dirties form a chain from that node towards the
+// root, so they are recorded as one event. Events are handed to the next
+// layout of a root containing their node.
+
+struct DirtyEvent {
+  uint32_t node;
+  uint32_t dirtiedNodes;
+  const char *operation;
+  std::string stack;
+  uint64_t serial;
+};
+
+struct LayoutTrace {
+  uint32_t root;
+  double durationMs;
+  std::vector<DirtyEvent> events;
+  uint64_t serial;
+};
+
+// Bounds the memory of a trace that is never taken.
+constexpr size_t kMaxDirtyEvents = 1 << 16;
+
+thread_local bool dirtyTracingEnabled = false;
+thread_local bool dirtyTracingStacks = false;
+thread_local std::vector<DirtyEvent> dirtyEvents;
+thread_local std::vector<LayoutTrace> layoutTraces;
+thread_local size_t tracedEventCount = 0;
+thread_local YGNodeConstRef lastTracedNode = NULL;
+thread_local uint64_t lastTracedCall = 0;
+
+// Freed nodes are retired rather than searched for, as ids are reused: events
+// and traces recorded before the serial a node was retired at refer to the
+// freed node, and are dropped or left without a node when they are handed
+// out.
+thread_local uint64_t tracedSerial = 0;
+thread_local std::unordered_map<uint32_t, uint64_t> retiredTracedNodes;
+
+static void forgetTracedNode(uint32_t id) {
+  if (tracedEventCount != 0) {
+    retiredTracedNodes[id] = ++tracedSerial;
+  }
+}
+
+static bool isRetired(uint32_t id, uint64_t serial) {
+  if (retiredTracedNodes.empty()) {
+    return false;
+  }
+  auto found = retiredTracedNodes.find(id);
+  return found != retiredTracedNodes.end() && serial < found->second;
+}
+
+static void clearDirtyTrace() {
+  dirtyEvents.clear();
+  layoutTraces.clear();
+  retiredTracedNodes.clear();
+  tracedEventCount = 0;
+  lastTracedNode = NULL;
+}
+
+// Nodes in virtual list mode, whose item sizes are updated after every layout
+// that includes them.
+
+thread_local std::unordered_set<YGNodeRef> virtualLists;
+
+static void dropVirtualList(napi_env env, YGNodeRef node) {
+  NodeContext *ctx = nodeContext(node);
+  if (ctx->virtualList != NULL) {
+    adjustNativeMemory(env, -(int64_t)ctx->virtualList->bytes());
+    virtualLists.erase(node);
+    delete ctx->virtualList;
+    ctx->virtualList = NULL;
+  }
+}
+
+// Measures the items of every virtual list below `root`. Returns true if that
+// moved any spacer, in which case `root` needs another layout pass.
+static bool measureVirtualLists(YGNodeRef root) {
+  bool changed = false;
+  for (YGNodeRef node : virtualLists) {
+    YGNodeRef top = node;
+    while (top != root && liveParent(top) != NULL) {
+      top = liveParent(top);
+    }
+    if (top == root) {
+      VirtualList *list = nodeContext(node)->virtualList;
+      list->measureItems(node);
+      list->updateRange();
+      prepareWrite(node);
+      changed |= list->applySpacers(node);
+    }
+  }
+  return changed;
+}
+
+// Call recording. While recording, every binding call made from JS is
+// appended to a call trace, followed by the nodes it created and the results
+// of the measure functions it ran, see call_trace.h. Configs are numbered in
+// the order the trace first refers to them.
+
+struct CallRecorder {
+  TraceWriter writer;
+  std::unordered_map<YGConfigConstRef, uint32_t> configs;
+};
+
+thread_local std::unique_ptr<CallRecorder> callRecorder;
+
+// Tells config wrappers apart from node wrappers.
+constexpr napi_type_tag kConfigTypeTag = {0x6ee5a2f0c1d34b17,
+                                          0x9a3f52c8e07d41b6};
+
+// Bounds the nesting of recorded arrays, deeper ones are recorded as opaque.
+constexpr size_t kMaxTraceValueDepth = 15;
+
+static uint32_t traceConfigId(YGConfigConstRef config) {
+  auto [it, added] = callRecorder->configs.try_emplace(
+      config, callRecorder->configs.size() + 1);
+  if (added) {
+    callRecorder->writer.writeConfigCreated(it->second);
+  }
+  return it->second;
+}
+
+static TraceValue traceValue(napi_env env, napi_value value, size_t depth);
+
+static TraceValue traceObject(napi_env env, napi_value value, size_t depth) {
+  TraceValue result;
+  bool isArray = false;
+  napi_is_array(env, value, &isArray);
+  void *data = NULL;
+  size_t length = 0;
+  if (isArray && depth < kMaxTraceValueDepth) {
+    uint32_t count = 0;
+    napi_get_array_length(env, value, &count);
+    result.type = TraceValue::Array;
+    result.elements.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      napi_value element;
+      napi_get_element(env, value, i, &element);
+      result.elements.push_back(traceValue(env, element, depth + 1));
+    }
+  } else if (js_buffer_data(env, value, &data, &length)) {
+    result.type = TraceValue::Buffer;
+    result.bytes.assign((const char *)data, length);
+  } else if (napi_unwrap(env, value, &data) == napi_ok && data != NULL) {
+    bool isConfig = false;
+    napi_check_object_type_tag(env, value, &kConfigTypeTag, &isConfig);
+    result.type = isConfig ? TraceValue::Config : TraceValue::Node;
+    result.id = isConfig ? traceConfigId((YGConfigConstRef)data)
+                         : nodeContext((YGNodeConstRef)data)->id;
+  } else {
+    result.type = TraceValue::Other;
+  }
+  return result;
+}
+
+static TraceValue traceValue(napi_env env, napi_value value, size_t depth) {
+  TraceValue result;
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+  switch (type) {
+  case napi_undefined:
+    result.type = TraceValue::Undefined;
+    break;
+  case napi_null:
+    result.type = TraceValue::Null;
+    break;
+  case napi_number:
+    result.type = TraceValue::Number;
+    napi_get_value_double(env, value, &result.number);
+    break;
+  case napi_boolean: {
+    bool flag = false;
+    napi_get_value_bool(env, value, &flag);
+    result.type = TraceValue::Bool;
+    result.number = flag;
+    break;
+  }
+  case napi_string: {
+    size_t length;
+    napi_get_value_string_utf8(env, value, NULL, 0, &length);
+    std::vector<char> bytes(length + 1);
+    napi_get_value_string_utf8(env, value, bytes.data(), bytes.size(),
+                               &length);
+    result.type = TraceValue::String;
+    result.bytes.assign(bytes.data(), length);
+    break;
+  }
+  case napi_function:
+    result.type = TraceValue::Function;
+    break;
+  case napi_object:
+    return traceObject(env, value, depth);
+  default:
+    result.type = TraceValue::Other;
+    break;
+  }
+  return result;
+}
+
+static void recordCall(napi_env env, const char *name, napi_value self,
+                       size_t argc, napi_value *argv) {
+  std::vector<TraceValue> args;
+  args.reserve(argc);
+  for (size_t i = 0; i < argc; i++) {
+    args.push_back(traceValue(env, argv[i], 0));
+  }
+  callRecorder->writer.writeCall(name, traceValue(env, self, 0), args);
+}
+
+static void recordFFICall(const char *name, uint32_t id, double const *args,
+                          size_t argc) {
+  TraceValue self;
+  self.type = TraceValue::Node;
+  self.id = id;
+  std::vector<TraceValue> values(argc);
+  for (size_t i = 0; i < argc; i++) {
+    values[i].type = TraceValue::Number;
+    values[i].number = args[i];
+  }
+  callRecorder->writer.writeCall(name, self, values);
+}
+
 // class Config {
 
+// Shared between a config and its wrapper, so the wrapper's finalizer can tell
+// whether the config was freed.
+struct ConfigState {
+  bool freed = false;
+};
+
+static NAPI_FINALIZER(Config_finalize) {
+  ConfigState *state = (ConfigState *)hint;
+  if (!state->freed) {
+    memoryStats.leakedConfigs++;
+  }
+  delete state;
+}
+
 NAPI_FUNCTION(Config_constructor) {
+  NapiCallScope napiCallScope(__func__);
   napi_value jsThis;
   napi_get_cb_info(env, cbinfo, NULL, NULL, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, 0, NULL);
   YGConfigRef config = YGConfigNew();
-  napi_wrap(env, jsThis, config, NULL, NULL, NULL);
+  ConfigState *state = new ConfigState();
+  YGConfigSetContext(config, state);
+  YGConfigSetCloneNodeFunc(config, &cloneSharedNode);
+  napi_wrap(env, jsThis, config, Config_finalize, state, NULL);
+  napi_type_tag_object(env, jsThis, &kConfigTypeTag);
+  if (callRecorder != NULL) {
+    traceConfigId(config);
+  }
+  memoryStats.liveConfigs++;
+  adjustNativeMemory(env, kConfigBytes);
   return jsThis;
 }
 
+static void freeConfig(napi_env env, YGConfigRef config) {
+  if (callRecorder != NULL) {
+    callRecorder->configs.erase(config);
+  }
+  ((ConfigState *)YGConfigGetContext(config))->freed = true;
+  YGConfigFree(config);
+  memoryStats.liveConfigs--;
+  memoryStats.freedConfigs++;
+  adjustNativeMemory(env, -kConfigBytes);
+}
+
 NAPI_FUNCTION(Config_create) {
+  NapiCallScope napiCallScope(__func__);
   napi_value jsThis;
   napi_get_cb_info(env, cbinfo, NULL, NULL, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, 0, NULL);
   napi_value instance;
   napi_new_instance(env, jsThis, 0, NULL, &instance);
   return instance;
 }
 
 NAPI_FUNCTION(Config_destroy) {
+  NapiCallScope napiCallScope(__func__);
+  napi_value jsThis;
   napi_value arg;
   size_t argc = 1;
-  napi_get_cb_info(env, cbinfo, &argc, &arg, NULL, NULL);
+  napi_get_cb_info(env, cbinfo, &argc, &arg, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)1), &arg);
   YGConfigRef config = (YGConfigRef)unwrap(env, arg);
-  YGConfigFree(config);
+  freeConfig(env, config);
   return NULL;
 }
 
 NAPI_FUNCTION(Config_free) {
   NAPI_METHOD_HEADER_NO_ARGS(YGConfigRef, config);
-  YGConfigFree(config);
+  freeConfig(env, config);
   return NULL;
 }
 
@@ -57,6 +483,7 @@ NAPI_FUNCTION(Config_setExperimentalFeatureEnabled) {
   NAPI_ARG_BOOL(enabled, 1);
   YGConfigSetExperimentalFeatureEnabled(
       config, static_cast<YGExperimentalFeature>(feature), enabled);
+  invalidateAllSubtreeHashes();
   return NULL;
 }
 
@@ -64,6 +491,7 @@ NAPI_FUNCTION(Config_setPointScaleFactor) {
   NAPI_METHOD_HEADER(YGConfigRef, config, 1);
   NAPI_ARG_DOUBLE(pixelsInPoint, 0);
   YGConfigSetPointScaleFactor(config, pixelsInPoint);
+  invalidateAllSubtreeHashes();
   return NULL;
 }
 
@@ -71,6 +499,7 @@ NAPI_FUNCTION(Config_setErrata) {
   NAPI_METHOD_HEADER(YGConfigRef, config, 1);
   NAPI_ARG_INT32(errata, 0);
   YGConfigSetErrata(config, static_cast<YGErrata>(errata));
+  invalidateAllSubtreeHashes();
   return NULL;
 }
 
@@ -78,6 +507,7 @@ NAPI_FUNCTION(Config_setUseWebDefaults) {
   NAPI_METHOD_HEADER(YGConfigRef, config, 1);
   NAPI_ARG_BOOL(useWebDefaults, 0);
   YGConfigSetUseWebDefaults(config, useWebDefaults);
+  invalidateAllSubtreeHashes();
   return NULL;
 }
 
@@ -105,65 +535,144 @@ NAPI_FUNCTION(Config_useWebDefaults) {
 
 // class Node {
 
+// Nodes created without a config get this one rather than Yoga's default,
+// which can't take the clone callback persistent trees rely on.
+thread_local YGConfigRef defaultConfig = NULL;
+
+static YGConfigRef bindingDefaultConfig() {
+  if (defaultConfig == NULL) {
+    defaultConfig = YGConfigNew();
+    YGConfigSetCloneNodeFunc(defaultConfig, &cloneSharedNode);
+  }
+  return defaultConfig;
+}
+
 NAPI_FUNCTION(Node_constructor) {
+  NapiCallScope napiCallScope(__func__);
   napi_value jsThis;
   size_t argc = 1;
   napi_value config;
   napi_get_cb_info(env, cbinfo, &argc, &config, &jsThis, NULL);
-  YGNodeRef node = argc == 1
-                       ? YGNodeNewWithConfig((YGConfigRef)unwrap(env, config))
-                       : YGNodeNew();
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)1), &config);
+  YGConfigRef configRef = argc == 1 ? (YGConfigRef)unwrap(env, config) : NULL;
+  YGNodeRef node = YGNodeNewWithConfig(
+      configRef != NULL ? configRef : bindingDefaultConfig());
   napi_wrap(env, jsThis, node, NULL, NULL, NULL);
-  napi_ref ref;
-  napi_create_reference(env, jsThis, 1, &ref);
-  YGNodeSetContext(node, (void *)ref);
+  NodeContext *ctx = new NodeContext();
+  napi_create_reference(env, jsThis, 1, &ctx->ref);
+  ctx->id = nodeRegistry.add(node);
+  YGNodeSetContext(node, ctx);
+  if (callRecorder != NULL) {
+    callRecorder->writer.writeNodeCreated(
+        ctx->id, configRef != NULL ? traceConfigId(configRef) : 0);
+  }
+  YGNodeSetDirtiedFunc(node, &globalDirtiedFunc);
+  memoryStats.liveNodes++;
+  adjustNativeMemory(env, kNodeBytes);
   return jsThis;
 }
 
 NAPI_FUNCTION(Node_createDefault) {
+  NapiCallScope napiCallScope(__func__);
   napi_value jsThis;
   napi_get_cb_info(env, cbinfo, NULL, NULL, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, 0, NULL);
   napi_value instance;
   napi_new_instance(env, jsThis, 0, NULL, &instance);
   return instance;
 }
 
 NAPI_FUNCTION(Node_createWithConfig) {
+  NapiCallScope napiCallScope(__func__);
   napi_value jsThis;
   napi_value arg;
   size_t argc = 1;
   napi_get_cb_info(env, cbinfo, &argc, &arg, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)1), &arg);
   napi_value result;
   napi_new_instance(env, jsThis, argc, &arg, &result);
   return result;
 }
 
+static void releaseNodeContext(napi_env env, YGNodeRef node) {
+  NodeContext *ctx = nodeContext(node);
+  napi_delete_reference(env, ctx->ref);
+  nodeRegistry.remove(ctx->id);
+  forgetSpatialIndex(node);
+  if (!damageRegions.empty()) {
+    damageRegions.erase(node);
+  }
+  if (!contentSizeRoots.empty()) {
+    contentSizeRoots.erase(node);
+  }
+  if (ctx->layoutFrozen) {
+    layoutFrozenNodes.erase(node);
+  }
+  dropVirtualList(env, node);
+  if (dirtyTracingEnabled) {
+    forgetTracedNode(ctx->id);
+  }
+  delete ctx;
+  memoryStats.liveNodes--;
+  memoryStats.freedNodes++;
+  adjustNativeMemory(env, -kNodeBytes);
+}
+
 NAPI_FUNCTION(Node_destroy) {
+  NapiCallScope napiCallScope(__func__);
+  napi_value jsThis;
   napi_value arg;
   size_t argc = 1;
-  napi_get_cb_info(env, cbinfo, &argc, &arg, NULL, NULL);
+  napi_get_cb_info(env, cbinfo, &argc, &arg, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)1), &arg);
   YGNodeRef node = (YGNodeRef)unwrap(env, arg);
-  napi_ref ref = (napi_ref)YGNodeGetContext(node);
-  napi_delete_reference(env, ref);
+  prepareChildrenWrite(node);
+  damageDetached(node);
+  releaseNodeContext(env, node);
+  invalidateLayoutQueries();
   YGNodeFree(node);
   return NULL;
 }
 
 NAPI_FUNCTION(Node_free) {
   NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  napi_ref ref = (napi_ref)YGNodeGetContext(node);
-  napi_delete_reference(env, ref);
+  prepareChildrenWrite(node);
+  damageDetached(node);
+  releaseNodeContext(env, node);
+  invalidateLayoutQueries();
   YGNodeFree(node);
   return NULL;
 }
 
-void freeNodeRecursive(napi_env env, YGNodeRef node) {
-  for (unsigned t = 0, T = YGNodeGetChildCount(node); t < T; t++) {
-    freeNodeRecursive(env, YGNodeGetChild(node, 0));
+// Frees `root` and every node it owns. The subtree is walked with an explicit
+// stack and each node is finalized in place, without detaching it from its
+// owner or children first, so teardown is linear and does not depend on depth.
+// Children shared with tree versions are unshared first, leaving the versions
+// with copies of them.
+void freeNodeRecursive(napi_env env, YGNodeRef root) {
+  prepareWrite(root);
+  damageDetached(root);
+  YGNodeRef owner = YGNodeGetOwner(root);
+  if (owner != NULL) {
+    YGNodeRemoveChild(owner, root);
   }
-  napi_ref ref = (napi_ref)YGNodeGetContext(node);
-  napi_delete_reference(env, ref);
-  YGNodeFree(node);
+  std::vector<YGNodeRef> stack = {root};
+  while (!stack.empty()) {
+    YGNodeRef node = stack.back();
+    stack.pop_back();
+    if (frozenNodeCount != 0) {
+      unshareChildren(node);
+    }
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      YGNodeRef child = YGNodeGetChild(node, i);
+      if (YGNodeGetOwner(child) == node) {
+        stack.push_back(child);
+      }
+    }
+    releaseNodeContext(env, node);
+    YGNodeFinalize(node);
+  }
+  invalidateLayoutQueries();
 }
 
 NAPI_FUNCTION(Node_freeRecursive) {
@@ -172,20 +681,61 @@ NAPI_FUNCTION(Node_freeRecursive) {
   return NULL;
 }
 
+NAPI_FUNCTION(Node_fromId) {
+  NapiCallScope napiCallScope(__func__);
+  napi_value jsThis;
+  napi_value arg;
+  size_t argc = 1;
+  napi_get_cb_info(env, cbinfo, &argc, &arg, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)1), &arg);
+  uint32_t id = 0;
+  napi_get_value_uint32(env, arg, &id);
+  YGNodeRef node = nodeRegistry.get(id);
+  if (node == NULL) {
+    return NULL;
+  }
+  return nodeToJS(env, node);
+}
+
+NAPI_FUNCTION(Node_getId) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  napi_value result;
+  napi_create_uint32(env, nodeContext(node)->id, &result);
+  return result;
+}
+
 NAPI_FUNCTION(Node_reset) {
   NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  prepareWrite(node);
+  // Resetting wipes the context and callbacks, the binding state survives.
+  NodeContext *ctx = nodeContext(node);
+  dropVirtualList(env, node);
   YGNodeReset(node);
+  ctx->hasDirtiedFunc = false;
+  ctx->subtreeHashEpoch = 0;
+  ctx->hasMeasureCacheKey = false;
+  ctx->measureTag = 0;
+  ctx->measurePreset.kind = MeasurePreset::None;
+  ctx->hasIntrinsicSizes = false;
+  if (ctx->layoutFrozen) {
+    ctx->layoutFrozen = false;
+    layoutFrozenNodes.erase(node);
+  }
+  YGNodeSetContext(node, ctx);
+  YGNodeSetDirtiedFunc(node, &globalDirtiedFunc);
   return NULL;
 }
 
 NAPI_FUNCTION(Node_copyStyle) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   YGNodeCopyStyle(node, (YGNodeRef)unwrap(env, argv[0]));
   return NULL;
 }
 
 NAPI_FUNCTION(Node_setPositionType) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(positionType, 0);
   YGNodeStyleSetPositionType(node, static_cast<YGPositionType>(positionType));
   return NULL;
@@ -193,6 +743,7 @@ NAPI_FUNCTION(Node_setPositionType) {
 
 NAPI_FUNCTION(Node_setPosition) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   NAPI_ARG_DOUBLE(position, 1);
   YGNodeStyleSetPosition(node, static_cast<YGEdge>(edge), position);
@@ -201,6 +752,7 @@ NAPI_FUNCTION(Node_setPosition) {
 
 NAPI_FUNCTION(Node_setPositionPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   NAPI_ARG_DOUBLE(position, 1);
   YGNodeStyleSetPositionPercent(node, static_cast<YGEdge>(edge), position);
@@ -209,6 +761,7 @@ NAPI_FUNCTION(Node_setPositionPercent) {
 
 NAPI_FUNCTION(Node_setAlignContent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(alignContent, 0);
   YGNodeStyleSetAlignContent(node, static_cast<YGAlign>(alignContent));
   return NULL;
@@ -216,6 +769,7 @@ NAPI_FUNCTION(Node_setAlignContent) {
 
 NAPI_FUNCTION(Node_setAlignItems) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(alignItems, 0);
   YGNodeStyleSetAlignItems(node, static_cast<YGAlign>(alignItems));
   return NULL;
@@ -223,6 +777,7 @@ NAPI_FUNCTION(Node_setAlignItems) {
 
 NAPI_FUNCTION(Node_setAlignSelf) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(alignSelf, 0);
   YGNodeStyleSetAlignSelf(node, static_cast<YGAlign>(alignSelf));
   return NULL;
@@ -230,6 +785,7 @@ NAPI_FUNCTION(Node_setAlignSelf) {
 
 NAPI_FUNCTION(Node_setFlexDirection) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(flexDirection, 0);
   YGNodeStyleSetFlexDirection(node,
                               static_cast<YGFlexDirection>(flexDirection));
@@ -238,6 +794,7 @@ NAPI_FUNCTION(Node_setFlexDirection) {
 
 NAPI_FUNCTION(Node_setFlexWrap) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(flexWrap, 0);
   YGNodeStyleSetFlexWrap(node, static_cast<YGWrap>(flexWrap));
   return NULL;
@@ -245,6 +802,7 @@ NAPI_FUNCTION(Node_setFlexWrap) {
 
 NAPI_FUNCTION(Node_setJustifyContent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(justifyContent, 0);
   YGNodeStyleSetJustifyContent(node, static_cast<YGJustify>(justifyContent));
   return NULL;
@@ -252,6 +810,7 @@ NAPI_FUNCTION(Node_setJustifyContent) {
 
 NAPI_FUNCTION(Node_setMargin) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   NAPI_ARG_DOUBLE(margin, 1);
   YGNodeStyleSetMargin(node, static_cast<YGEdge>(edge), margin);
@@ -260,6 +819,7 @@ NAPI_FUNCTION(Node_setMargin) {
 
 NAPI_FUNCTION(Node_setMarginPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   NAPI_ARG_DOUBLE(margin, 1);
   YGNodeStyleSetMarginPercent(node, static_cast<YGEdge>(edge), margin);
@@ -268,6 +828,7 @@ NAPI_FUNCTION(Node_setMarginPercent) {
 
 NAPI_FUNCTION(Node_setMarginAuto) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   YGNodeStyleSetMarginAuto(node, static_cast<YGEdge>(edge));
   return NULL;
@@ -275,6 +836,7 @@ NAPI_FUNCTION(Node_setMarginAuto) {
 
 NAPI_FUNCTION(Node_setOverflow) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(overflow, 0);
   YGNodeStyleSetOverflow(node, static_cast<YGOverflow>(overflow));
   return NULL;
@@ -282,6 +844,7 @@ NAPI_FUNCTION(Node_setOverflow) {
 
 NAPI_FUNCTION(Node_setDisplay) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(display, 0);
   YGNodeStyleSetDisplay(node, static_cast<YGDisplay>(display));
   return NULL;
@@ -289,6 +852,7 @@ NAPI_FUNCTION(Node_setDisplay) {
 
 NAPI_FUNCTION(Node_setFlex) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(flex, 0);
   YGNodeStyleSetFlex(node, flex);
   return NULL;
@@ -296,6 +860,7 @@ NAPI_FUNCTION(Node_setFlex) {
 
 NAPI_FUNCTION(Node_setFlexBasis) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(flexBasis, 0);
   YGNodeStyleSetFlexBasis(node, flexBasis);
   return NULL;
@@ -303,6 +868,7 @@ NAPI_FUNCTION(Node_setFlexBasis) {
 
 NAPI_FUNCTION(Node_setFlexBasisPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(flexBasis, 0);
   YGNodeStyleSetFlexBasisPercent(node, flexBasis);
   return NULL;
@@ -310,12 +876,14 @@ NAPI_FUNCTION(Node_setFlexBasisPercent) {
 
 NAPI_FUNCTION(Node_setFlexBasisAuto) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 0);
+  prepareWrite(node);
   YGNodeStyleSetFlexBasisAuto(node);
   return NULL;
 }
 
 NAPI_FUNCTION(Node_setFlexGrow) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(flexGrow, 0);
   YGNodeStyleSetFlexGrow(node, flexGrow);
   return NULL;
@@ -323,6 +891,7 @@ NAPI_FUNCTION(Node_setFlexGrow) {
 
 NAPI_FUNCTION(Node_setFlexShrink) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(flexShrink, 0);
   YGNodeStyleSetFlexShrink(node, flexShrink);
   return NULL;
@@ -330,6 +899,7 @@ NAPI_FUNCTION(Node_setFlexShrink) {
 
 NAPI_FUNCTION(Node_setWidth) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(width, 0);
   YGNodeStyleSetWidth(node, width);
   return NULL;
@@ -337,6 +907,7 @@ NAPI_FUNCTION(Node_setWidth) {
 
 NAPI_FUNCTION(Node_setWidthPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(width, 0);
   YGNodeStyleSetWidthPercent(node, width);
   return NULL;
@@ -344,12 +915,14 @@ NAPI_FUNCTION(Node_setWidthPercent) {
 
 NAPI_FUNCTION(Node_setWidthAuto) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 0);
+  prepareWrite(node);
   YGNodeStyleSetWidthAuto(node);
   return NULL;
 }
 
 NAPI_FUNCTION(Node_setHeight) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(height, 0);
   YGNodeStyleSetHeight(node, height);
   return NULL;
@@ -357,6 +930,7 @@ NAPI_FUNCTION(Node_setHeight) {
 
 NAPI_FUNCTION(Node_setHeightPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(height, 0);
   YGNodeStyleSetHeightPercent(node, height);
   return NULL;
@@ -364,12 +938,14 @@ NAPI_FUNCTION(Node_setHeightPercent) {
 
 NAPI_FUNCTION(Node_setHeightAuto) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 0);
+  prepareWrite(node);
   YGNodeStyleSetHeightAuto(node);
   return NULL;
 }
 
 NAPI_FUNCTION(Node_setMinWidth) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(minWidth, 0);
   YGNodeStyleSetMinWidth(node, minWidth);
   return NULL;
@@ -377,6 +953,7 @@ NAPI_FUNCTION(Node_setMinWidth) {
 
 NAPI_FUNCTION(Node_setMinWidthPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(minWidth, 0);
   YGNodeStyleSetMinWidthPercent(node, minWidth);
   return NULL;
@@ -384,6 +961,7 @@ NAPI_FUNCTION(Node_setMinWidthPercent) {
 
 NAPI_FUNCTION(Node_setMinHeight) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(minHeight, 0);
   YGNodeStyleSetMinHeight(node, minHeight);
   return NULL;
@@ -391,6 +969,7 @@ NAPI_FUNCTION(Node_setMinHeight) {
 
 NAPI_FUNCTION(Node_setMinHeightPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(minHeight, 0);
   YGNodeStyleSetMinHeightPercent(node, minHeight);
   return NULL;
@@ -398,6 +977,7 @@ NAPI_FUNCTION(Node_setMinHeightPercent) {
 
 NAPI_FUNCTION(Node_setMaxWidth) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(maxWidth, 0);
   YGNodeStyleSetMaxWidth(node, maxWidth);
   return NULL;
@@ -405,6 +985,7 @@ NAPI_FUNCTION(Node_setMaxWidth) {
 
 NAPI_FUNCTION(Node_setMaxWidthPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(maxWidth, 0);
   YGNodeStyleSetMaxWidthPercent(node, maxWidth);
   return NULL;
@@ -412,6 +993,7 @@ NAPI_FUNCTION(Node_setMaxWidthPercent) {
 
 NAPI_FUNCTION(Node_setMaxHeight) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(maxHeight, 0);
   YGNodeStyleSetMaxHeight(node, maxHeight);
   return NULL;
@@ -419,6 +1001,7 @@ NAPI_FUNCTION(Node_setMaxHeight) {
 
 NAPI_FUNCTION(Node_setMaxHeightPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(maxHeight, 0);
   YGNodeStyleSetMaxHeightPercent(node, maxHeight);
   return NULL;
@@ -426,6 +1009,7 @@ NAPI_FUNCTION(Node_setMaxHeightPercent) {
 
 NAPI_FUNCTION(Node_setAspectRatio) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(aspectRatio, 0);
   YGNodeStyleSetAspectRatio(node, aspectRatio);
   return NULL;
@@ -433,6 +1017,7 @@ NAPI_FUNCTION(Node_setAspectRatio) {
 
 NAPI_FUNCTION(Node_setBorder) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   NAPI_ARG_DOUBLE(border, 1);
   YGNodeStyleSetBorder(node, static_cast<YGEdge>(edge), border);
@@ -441,6 +1026,7 @@ NAPI_FUNCTION(Node_setBorder) {
 
 NAPI_FUNCTION(Node_setPadding) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   NAPI_ARG_DOUBLE(padding, 1);
   YGNodeStyleSetPadding(node, static_cast<YGEdge>(edge), padding);
@@ -449,6 +1035,7 @@ NAPI_FUNCTION(Node_setPadding) {
 
 NAPI_FUNCTION(Node_setPaddingPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(edge, 0);
   NAPI_ARG_DOUBLE(padding, 1);
   YGNodeStyleSetPaddingPercent(node, static_cast<YGEdge>(edge), padding);
@@ -457,6 +1044,7 @@ NAPI_FUNCTION(Node_setPaddingPercent) {
 
 NAPI_FUNCTION(Node_setGap) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(gutter, 0);
   NAPI_ARG_DOUBLE(gapLength, 1);
   YGNodeStyleSetGap(node, static_cast<YGGutter>(gutter), gapLength);
@@ -465,6 +1053,7 @@ NAPI_FUNCTION(Node_setGap) {
 
 NAPI_FUNCTION(Node_setGapPercent) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_INT32(gutter, 0);
   NAPI_ARG_DOUBLE(gapLength, 1);
   YGNodeStyleSetGapPercent(node, static_cast<YGGutter>(gutter), gapLength);
@@ -473,6 +1062,7 @@ NAPI_FUNCTION(Node_setGapPercent) {
 
 NAPI_FUNCTION(Node_setDirection) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_INT32(direction, 0);
   YGNodeStyleSetDirection(node, static_cast<YGDirection>(direction));
   return NULL;
@@ -631,6 +1221,8 @@ NAPI_FUNCTION(Node_insertChild) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 2);
   YGNodeRef child = (YGNodeRef)unwrap(env, argv[0]);
   NAPI_ARG_INT32(index, 1);
+  prepareWrite(node);
+  prepareWrite(child);
   YGNodeInsertChild(node, child, index);
   return NULL;
 }
@@ -638,10 +1230,136 @@ NAPI_FUNCTION(Node_insertChild) {
 NAPI_FUNCTION(Node_removeChild) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
   YGNodeRef child = (YGNodeRef)unwrap(env, argv[0]);
+  prepareWrite(node);
+  prepareWrite(child);
+  if (YGNodeGetOwner(child) == node) {
+    damageDetached(child);
+  }
   YGNodeRemoveChild(node, child);
   return NULL;
 }
 
+// Reads a JS array of nodes. Throws and returns false if any child already
+// belongs to a node other than `owner`, or appears more than once.
+static bool unwrapChildren(napi_env env, napi_value array, YGNodeRef owner,
+                           std::vector<YGNodeRef> &children) {
+  uint32_t length = 0;
+  napi_get_array_length(env, array, &length);
+  children.reserve(length);
+  std::unordered_set<YGNodeRef> seen;
+  seen.reserve(length);
+  for (uint32_t i = 0; i < length; i++) {
+    napi_value element;
+    napi_get_element(env, array, i, &element);
+    YGNodeRef child = (YGNodeRef)unwrap(env, element);
+    if (child == NULL || !seen.insert(child).second) {
+      napi_throw_error(env, NULL, "Children must be distinct nodes");
+      return false;
+    }
+    YGNodeRef childOwner = liveParent(child);
+    if (childOwner != NULL && childOwner != owner) {
+      napi_throw_error(env, NULL,
+                       "Child already has an owner, it must be removed first");
+      return false;
+    }
+    children.push_back(child);
+  }
+  if (length > 0 && YGNodeHasMeasureFunc(owner)) {
+    napi_throw_error(env, NULL,
+                     "Nodes with measure functions cannot have children");
+    return false;
+  }
+  return true;
+}
+
+// Replaces the child list of `ownerRef` with `next` in a single linear pass.
+// Retained children keep their layout caches, dropped ones are detached and
+// reset the way YGNodeRemoveChild resets them, and the owner is dirtied once.
+// Retained children shared with tree versions stay shared.
+static void reconcileChildren(YGNodeRef ownerRef,
+                              std::vector<YGNodeRef> const &next) {
+  facebook::yoga::Node *owner = resolveRef(ownerRef);
+  auto const &current = owner->getChildren();
+  if (std::equal(current.begin(), current.end(), next.begin(), next.end())) {
+    return;
+  }
+
+  std::unordered_set<YGNodeRef> retained(next.begin(), next.end());
+  for (facebook::yoga::Node *child : current) {
+    if (liveParent(child) == owner && retained.count(child) == 0) {
+      prepareWrite(child);
+      damageDetached(child);
+      child->setLayout({});
+      child->setOwner(nullptr);
+    }
+  }
+
+  std::vector<facebook::yoga::Node *> children;
+  children.reserve(next.size());
+  for (YGNodeRef childRef : next) {
+    facebook::yoga::Node *child = resolveRef(childRef);
+    if (!isShared(child)) {
+      child->setOwner(owner);
+    }
+    children.push_back(child);
+  }
+  owner->setChildren(children);
+  owner->markDirtyAndPropagate();
+}
+
+NAPI_FUNCTION(Node_setChildren) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
+  std::vector<YGNodeRef> children;
+  if (!unwrapChildren(env, argv[0], node, children)) {
+    return NULL;
+  }
+  reconcileChildren(node, children);
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_insertChildren) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  NAPI_ARG_INT32(index, 1);
+  prepareWrite(node);
+  std::vector<YGNodeRef> inserted;
+  if (!unwrapChildren(env, argv[0], node, inserted)) {
+    return NULL;
+  }
+  for (YGNodeRef child : inserted) {
+    if (liveParent(child) != NULL) {
+      napi_throw_error(env, NULL,
+                       "Child already has an owner, it must be removed first");
+      return NULL;
+    }
+  }
+  if (inserted.empty()) {
+    return NULL;
+  }
+
+  auto const &current = resolveRef(node)->getChildren();
+  size_t at = std::clamp<size_t>(index < 0 ? 0 : index, 0, current.size());
+  std::vector<YGNodeRef> children;
+  children.reserve(current.size() + inserted.size());
+  children.insert(children.end(), current.begin(), current.begin() + at);
+  children.insert(children.end(), inserted.begin(), inserted.end());
+  children.insert(children.end(), current.begin() + at, current.end());
+  reconcileChildren(node, children);
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_removeAllChildren) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  prepareChildrenWrite(node);
+  if (DamageRegion *region = trackedDamageRegion(node)) {
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      forgetDamageFrame(YGNodeGetChild(node, i), *region);
+    }
+  }
+  YGNodeRemoveAllChildren(node);
+  return NULL;
+}
+
 NAPI_FUNCTION(Node_getChildCount) {
   NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
   unsigned count = YGNodeGetChildCount(node);
@@ -650,17 +1368,11 @@ NAPI_FUNCTION(Node_getChildCount) {
 
 NAPI_FUNCTION(Node_getParent) {
   NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  YGNodeRef parent = YGNodeGetParent(node);
+  YGNodeRef parent = liveParent(node);
   if (parent == NULL) {
     return NULL;
   }
-  napi_ref ref = (napi_ref)YGNodeGetContext(parent);
-  if (ref == NULL) {
-    return NULL;
-  }
-  napi_value jsParent = NULL;
-  napi_get_reference_value(env, ref, &jsParent);
-  return jsParent;
+  return nodeToJS(env, parent);
 }
 
 NAPI_FUNCTION(Node_getChild) {
@@ -670,19 +1382,15 @@ NAPI_FUNCTION(Node_getChild) {
   if (child == NULL) {
     return NULL;
   }
-  napi_ref ref = (napi_ref)YGNodeGetContext(child);
-  if (ref == NULL) {
-    return NULL;
-  }
-  napi_value jsChild = NULL;
-  napi_get_reference_value(env, ref, &jsChild);
-  return jsChild;
+  return nodeToJS(env, child);
 }
 
 NAPI_FUNCTION(Node_setAlwaysFormsContainingBlock) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_BOOL(always, 0);
   YGNodeSetAlwaysFormsContainingBlock(node, always);
+  invalidateSubtreeHash(node);
   return NULL;
 }
 
@@ -694,6 +1402,7 @@ NAPI_FUNCTION(Node_isReferenceBaseline) {
 
 NAPI_FUNCTION(Node_setIsReferenceBaseline) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   NAPI_ARG_BOOL(isReferenceBaseline, 0);
   YGNodeSetIsReferenceBaseline(node, isReferenceBaseline);
   return NULL;
@@ -701,13 +1410,20 @@ NAPI_FUNCTION(Node_setIsReferenceBaseline) {
 
 thread_local napi_env global_env;
 
-static YGSize globalMeasureFunc(YGNodeConstRef nodeRef, float width,
-                                YGMeasureMode widthMode, float height,
-                                YGMeasureMode heightMode) {
-  napi_ref ref = (napi_ref)(YGNodeGetContext(nodeRef));
+static YGSize measureNode(YGNodeConstRef nodeRef, float width,
+                          YGMeasureMode widthMode, float height,
+                          YGMeasureMode heightMode) {
+  NodeContext *ctx = nodeContext(nodeRef);
+  for (uint8_t i = 0; i < ctx->predictedCount; i++) {
+    if (ctx->predicted[i].matches(width, widthMode, height, heightMode)) {
+      ctx->lastMeasure = ctx->predicted[i];
+      ctx->hasLastMeasure = true;
+      return ctx->predicted[i].size;
+    }
+  }
 
   napi_value jsThis;
-  napi_get_reference_value(global_env, ref, &jsThis);
+  napi_get_reference_value(global_env, ctx->ref, &jsThis);
 
   napi_value measureFunc;
   napi_get_named_property(global_env, jsThis, "_measureFunc", &measureFunc);
@@ -729,119 +1445,1234 @@ static YGSize globalMeasureFunc(YGNodeConstRef nodeRef, float width,
   napi_get_value_double(global_env, widthValue, &dwidth);
   napi_get_value_double(global_env, heightValue, &dheight);
 
-  return {(float)dwidth, (float)dheight};
+  YGSize size = {(float)dwidth, (float)dheight};
+  ctx->lastMeasure = {width, height, widthMode, heightMode, size};
+  ctx->hasLastMeasure = true;
+  return size;
+}
+
+static YGSize globalMeasureFunc(YGNodeConstRef nodeRef, float width,
+                                YGMeasureMode widthMode, float height,
+                                YGMeasureMode heightMode) {
+  YGSize size = measureNode(nodeRef, width, widthMode, height, heightMode);
+  // Scratch copies have no id, see intrinsic_sizes.cc.
+  if (callRecorder != NULL && nodeContext(nodeRef)->id != 0) {
+    callRecorder->writer.writeMeasure(nodeContext(nodeRef)->id, width,
+                                      widthMode, height, heightMode,
+                                      size.width, size.height);
+  }
+  return size;
 }
 
 NAPI_FUNCTION(Node_setMeasureFunc) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
   global_env = env;
   napi_set_named_property(env, jsThis, "_measureFunc", argv[0]);
+  nodeContext(node)->measurePreset.kind = MeasurePreset::None;
   YGNodeSetMeasureFunc(node, &globalMeasureFunc);
+  invalidateSubtreeHash(node);
   return NULL;
 }
 
 NAPI_FUNCTION(Node_unsetMeasureFunc) {
   NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  prepareWrite(node);
   napi_value undefined;
   napi_get_undefined(env, &undefined);
   napi_set_named_property(env, jsThis, "_measureFunc", undefined);
+  nodeContext(node)->measurePreset.kind = MeasurePreset::None;
   YGNodeSetMeasureFunc(node, NULL);
+  invalidateSubtreeHash(node);
   return NULL;
 }
 
-static void globalDirtiedFunc(YGNodeConstRef nodeRef) {
-  napi_ref ref = (napi_ref)(YGNodeGetContext(nodeRef));
-
-  napi_value jsThis;
-  napi_get_reference_value(global_env, ref, &jsThis);
-
-  napi_value dirtiedFunc;
-  napi_get_named_property(global_env, jsThis, "_dirtiedFunc", &dirtiedFunc);
-
-  napi_value result;
-  napi_call_function(global_env, jsThis, dirtiedFunc, 0, NULL, &result);
-}
-
-NAPI_FUNCTION(Node_setDirtiedFunc) {
+// Groups measured nodes for Yoga.markDirtyByTag, e.g. by font. 0 is no tag.
+NAPI_FUNCTION(Node_setMeasureTag) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
-  global_env = env;
-  napi_set_named_property(env, jsThis, "_dirtiedFunc", argv[0]);
-  YGNodeSetDirtiedFunc(node, &globalDirtiedFunc);
+  uint32_t tag = 0;
+  napi_get_value_uint32(env, argv[0], &tag);
+  nodeContext(node)->measureTag = tag;
   return NULL;
 }
 
-NAPI_FUNCTION(Node_unsetDirtiedFunc) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  napi_value undefined;
-  napi_get_undefined(env, &undefined);
-  napi_set_named_property(env, jsThis, "_dirtiedFunc", undefined);
-  YGNodeSetDirtiedFunc(node, NULL);
+NAPI_FUNCTION(Node_setMeasureCacheKey) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
+  NodeContext *ctx = nodeContext(node);
+  napi_valuetype type;
+  napi_typeof(env, argv[0], &type);
+  if (type == napi_undefined || type == napi_null) {
+    ctx->hasMeasureCacheKey = false;
+  } else if (type == napi_string) {
+    size_t length;
+    napi_get_value_string_utf8(env, argv[0], NULL, 0, &length);
+    std::vector<char> key(length + 1);
+    napi_get_value_string_utf8(env, argv[0], key.data(), key.size(), &length);
+    ctx->hasMeasureCacheKey = true;
+    ctx->measureCacheKey = hashBytes(key.data(), length);
+  } else {
+    napi_throw_type_error(env, NULL, "Measure cache key must be a string");
+    return NULL;
+  }
+  // A new key means the measured content changed.
+  resolveRef(node)->markDirtyAndPropagate();
   return NULL;
 }
 
-NAPI_FUNCTION(Node_markDirty) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  YGNodeMarkDirty(node);
-  return NULL;
-}
+// Native measure presets. They replace any JS measure function, take no part
+// in bulk measurement and keep the node eligible for the layout cache.
 
-NAPI_FUNCTION(Node_isDirty) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  bool isDirty = YGNodeIsDirty(node);
-  return js_bool(env, isDirty);
+static YGSize presetMeasureFunc(YGNodeConstRef node, float width,
+                                YGMeasureMode widthMode, float height,
+                                YGMeasureMode heightMode) {
+  return measureWithPreset(nodeContext(node)->measurePreset, width, widthMode,
+                           height, heightMode);
 }
 
-NAPI_FUNCTION(Node_markLayoutSeen) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  YGNodeSetHasNewLayout(node, false);
-  return NULL;
+static double numberOr(napi_env env, napi_value value, double fallback) {
+  double number;
+  return napi_get_value_double(env, value, &number) == napi_ok &&
+                 !std::isnan(number)
+             ? number
+             : fallback;
 }
 
-NAPI_FUNCTION(Node_hasNewLayout) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  bool hasNewLayout = YGNodeGetHasNewLayout(node);
-  return js_bool(env, hasNewLayout);
+static void setMeasurePreset(napi_env env, napi_value jsThis, YGNodeRef node,
+                             MeasurePreset const &preset,
+                             const char *invalidMessage) {
+  if (!isValidMeasurePreset(preset)) {
+    napi_throw_range_error(env, NULL, invalidMessage);
+    return;
+  }
+  if (YGNodeGetChildCount(node) > 0) {
+    napi_throw_error(env, NULL,
+                     "Nodes with measure functions cannot have children");
+    return;
+  }
+  napi_value undefined;
+  napi_get_undefined(env, &undefined);
+  napi_set_named_property(env, jsThis, "_measureFunc", undefined);
+  NodeContext *ctx = nodeContext(node);
+  ctx->measurePreset = preset;
+  ctx->hasLastMeasure = false;
+  YGNodeSetMeasureFunc(node, &presetMeasureFunc);
+  invalidateSubtreeHash(node);
+  resolveRef(node)->markDirtyAndPropagate();
 }
 
-NAPI_FUNCTION(Node_calculateLayout) {
-  NAPI_METHOD_HEADER(YGNodeRef, node, 3);
+NAPI_FUNCTION(Node_setIntrinsicSize) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
   NAPI_ARG_DOUBLE(width, 0);
   NAPI_ARG_DOUBLE(height, 1);
-  NAPI_ARG_INT32(direction, 2);
-  YGNodeCalculateLayout(node, width, height,
-                        static_cast<YGDirection>(direction));
+  setMeasurePreset(env, jsThis, node,
+                   {MeasurePreset::IntrinsicSize,
+                    {(float)width, (float)height}},
+                   "Invalid intrinsic size");
   return NULL;
 }
 
-NAPI_FUNCTION(Node_getComputedLeft) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  float left = YGNodeLayoutGetLeft(node);
-  return js_double(env, left);
+NAPI_FUNCTION(Node_setAspectMeasure) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 3);
+  prepareWrite(node);
+  NAPI_ARG_DOUBLE(ratio, 0);
+  float minWidth = numberOr(env, argv[1], 0);
+  float maxWidth = numberOr(env, argv[2], INFINITY);
+  setMeasurePreset(env, jsThis, node,
+                   {MeasurePreset::AspectRatio,
+                    {(float)ratio, minWidth, maxWidth}},
+                   "Invalid aspect measure");
+  return NULL;
 }
 
-NAPI_FUNCTION(Node_getComputedRight) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  float right = YGNodeLayoutGetRight(node);
-  return js_double(env, right);
+NAPI_FUNCTION(Node_setClampMeasure) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 4);
+  prepareWrite(node);
+  float minWidth = numberOr(env, argv[0], 0);
+  float minHeight = numberOr(env, argv[1], 0);
+  float maxWidth = numberOr(env, argv[2], INFINITY);
+  float maxHeight = numberOr(env, argv[3], INFINITY);
+  setMeasurePreset(env, jsThis, node,
+                   {MeasurePreset::Clamp,
+                    {minWidth, minHeight, maxWidth, maxHeight}},
+                   "Invalid clamp measure");
+  return NULL;
 }
 
-NAPI_FUNCTION(Node_getComputedTop) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  float top = YGNodeLayoutGetTop(node);
-  return js_double(env, top);
+// Bulk measurement: before laying out a root that has a bulk measure function,
+// the dirty measured leaves below it are collected with the constraints they
+// will likely be measured under (the ones they were last measured with, and
+// an estimate from their ancestors' styles). A single JS call answers all of
+// them, and globalMeasureFunc only falls back to `_measureFunc` for requests
+// nobody predicted.
+
+struct BulkMeasureCandidate {
+  YGNodeRef node;
+  MeasureEntry entry;
+};
+
+static float resolveLength(YGValue value, float available) {
+  switch (value.unit) {
+  case YGUnitPoint:
+    return value.value;
+  case YGUnitPercent:
+    return available * value.value / 100;
+  default:
+    return YGUndefined;
+  }
 }
 
-NAPI_FUNCTION(Node_getComputedBottom) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  float bottom = YGNodeLayoutGetBottom(node);
-  return js_double(env, bottom);
+static float resolveEdge(YGNodeConstRef node, YGValue (*get)(YGNodeConstRef,
+                                                            YGEdge),
+                         YGEdge edge, YGEdge axis, float available) {
+  for (YGEdge candidate : {edge, axis, YGEdgeAll}) {
+    float value = resolveLength(get(node, candidate), available);
+    if (!std::isnan(value)) {
+      return value;
+    }
+  }
+  return 0;
 }
 
-NAPI_FUNCTION(Node_getComputedWidth) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
-  float width = YGNodeLayoutGetWidth(node);
-  return js_double(env, width);
-}
+static float resolveBorder(YGNodeConstRef node, YGEdge edge, YGEdge axis) {
+  for (YGEdge candidate : {edge, axis, YGEdgeAll}) {
+    float value = YGNodeStyleGetBorder(node, candidate);
+    if (!std::isnan(value)) {
+      return value;
+    }
+  }
+  return 0;
+}
+
+// Padding and border along one axis; percentages resolve against the width.
+static float insetAlong(YGNodeConstRef node, bool horizontal,
+                        float availableWidth) {
+  YGEdge leading = horizontal ? YGEdgeLeft : YGEdgeTop;
+  YGEdge trailing = horizontal ? YGEdgeRight : YGEdgeBottom;
+  YGEdge axis = horizontal ? YGEdgeHorizontal : YGEdgeVertical;
+  return resolveEdge(node, YGNodeStyleGetPadding, leading, axis,
+                     availableWidth) +
+         resolveEdge(node, YGNodeStyleGetPadding, trailing, axis,
+                     availableWidth) +
+         resolveBorder(node, leading, axis) +
+         resolveBorder(node, trailing, axis);
+}
+
+static float marginAlong(YGNodeConstRef node, bool horizontal,
+                         float availableWidth) {
+  YGEdge leading = horizontal ? YGEdgeLeft : YGEdgeTop;
+  YGEdge trailing = horizontal ? YGEdgeRight : YGEdgeBottom;
+  YGEdge axis = horizontal ? YGEdgeHorizontal : YGEdgeVertical;
+  return resolveEdge(node, YGNodeStyleGetMargin, leading, axis,
+                     availableWidth) +
+         resolveEdge(node, YGNodeStyleGetMargin, trailing, axis,
+                     availableWidth);
+}
+
+// Estimates the constraint along one axis: the styled size, the stretched
+// available size, or the available size as an upper bound.
+static void estimateAxis(float styled, float available, bool stretch,
+                         float inset, float &size, YGMeasureMode &mode) {
+  if (!std::isnan(styled)) {
+    size = styled;
+    mode = YGMeasureModeExactly;
+  } else if (std::isnan(available)) {
+    size = YGUndefined;
+    mode = YGMeasureModeUndefined;
+    return;
+  } else {
+    size = available;
+    mode = stretch ? YGMeasureModeExactly : YGMeasureModeAtMost;
+  }
+  size = std::max(0.0f, size - inset);
+}
+
+static void collectBulkMeasureCandidates(
+    YGNodeRef root, float width, float height,
+    std::vector<BulkMeasureCandidate> &candidates) {
+  struct Pending {
+    YGNodeRef node;
+    float availableWidth;
+    float availableHeight;
+    bool stretchWidth;
+    bool stretchHeight;
+  };
+
+  std::vector<Pending> stack = {{root, width, height, false, false}};
+  while (!stack.empty()) {
+    Pending pending = stack.back();
+    stack.pop_back();
+    YGNodeRef node = pending.node;
+    if (!YGNodeIsDirty(node) ||
+        YGNodeStyleGetDisplay(node) == YGDisplayNone) {
+      continue;
+    }
+
+    float availableWidth = pending.availableWidth;
+    float styledWidth =
+        resolveLength(YGNodeStyleGetWidth(node), availableWidth);
+    float styledHeight =
+        resolveLength(YGNodeStyleGetHeight(node), pending.availableHeight);
+    float insetWidth = insetAlong(node, true, availableWidth);
+    float insetHeight = insetAlong(node, false, availableWidth);
+
+    MeasureEntry estimate = {};
+    estimateAxis(styledWidth, availableWidth, pending.stretchWidth, insetWidth,
+                 estimate.width, estimate.widthMode);
+    estimateAxis(styledHeight, pending.availableHeight, pending.stretchHeight,
+                 insetHeight, estimate.height, estimate.heightMode);
+
+    if (YGNodeHasMeasureFunc(node)) {
+      NodeContext *ctx = nodeContext(node);
+      if (ctx->measurePreset.kind != MeasurePreset::None) {
+        continue;
+      }
+      if (ctx->hasLastMeasure) {
+        MeasureEntry const &last = ctx->lastMeasure;
+        candidates.push_back({node, last});
+        if (last.matches(estimate.width, estimate.widthMode, estimate.height,
+                         estimate.heightMode)) {
+          continue;
+        }
+      }
+      candidates.push_back({node, estimate});
+      continue;
+    }
+
+    YGFlexDirection direction = YGNodeStyleGetFlexDirection(node);
+    bool column = direction == YGFlexDirectionColumn ||
+                  direction == YGFlexDirectionColumnReverse;
+    YGAlign alignItems = YGNodeStyleGetAlignItems(node);
+    for (size_t i = YGNodeGetChildCount(node); i-- > 0;) {
+      YGNodeRef child = YGNodeGetChild(node, i);
+      YGAlign align = YGNodeStyleGetAlignSelf(child);
+      bool stretch =
+          (align == YGAlignAuto ? alignItems : align) == YGAlignStretch;
+      stack.push_back(
+          {child, estimate.width - marginAlong(child, true, estimate.width),
+           estimate.height - marginAlong(child, false, estimate.width),
+           column && stretch && estimate.widthMode == YGMeasureModeExactly,
+           !column && stretch &&
+               estimate.heightMode == YGMeasureModeExactly});
+    }
+  }
+}
+
+// Returns the contexts that received answers, so they can be cleared after the
+// layout pass.
+static std::vector<NodeContext *> prepareBulkMeasure(napi_env env,
+                                                     napi_value jsThis,
+                                                     YGNodeRef root,
+                                                     float width,
+                                                     float height) {
+  std::vector<BulkMeasureCandidate> candidates;
+  collectBulkMeasureCandidates(root, width, height, candidates);
+  std::vector<NodeContext *> prepared;
+  if (candidates.empty()) {
+    return prepared;
+  }
+
+  size_t count = candidates.size();
+  uint32_t *ids;
+  float *widths, *heights, *results;
+  uint8_t *widthModes, *heightModes;
+  napi_value argv[6];
+  argv[0] = js_typed_array(env, napi_uint32_array, count, sizeof(uint32_t),
+                           (void **)&ids);
+  argv[1] = js_typed_array(env, napi_float32_array, count, sizeof(float),
+                           (void **)&widths);
+  argv[2] = js_typed_array(env, napi_uint8_array, count, sizeof(uint8_t),
+                           (void **)&widthModes);
+  argv[3] = js_typed_array(env, napi_float32_array, count, sizeof(float),
+                           (void **)&heights);
+  argv[4] = js_typed_array(env, napi_uint8_array, count, sizeof(uint8_t),
+                           (void **)&heightModes);
+  argv[5] = js_typed_array(env, napi_float32_array, 2 * count, sizeof(float),
+                           (void **)&results);
+  for (size_t i = 0; i < count; i++) {
+    MeasureEntry const &entry = candidates[i].entry;
+    ids[i] = nodeContext(candidates[i].node)->id;
+    widths[i] = entry.width;
+    widthModes[i] = entry.widthMode;
+    heights[i] = entry.height;
+    heightModes[i] = entry.heightMode;
+    results[2 * i] = results[2 * i + 1] = YGUndefined;
+  }
+
+  napi_value bulkMeasureFunc, result;
+  napi_get_named_property(env, jsThis, "_bulkMeasureFunc", &bulkMeasureFunc);
+  if (napi_call_function(env, jsThis, bulkMeasureFunc, 6, argv, &result) !=
+      napi_ok) {
+    return prepared;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    YGSize size = {results[2 * i], results[2 * i + 1]};
+    NodeContext *ctx = nodeContext(candidates[i].node);
+    if (std::isnan(size.width) || std::isnan(size.height) ||
+        ctx->predictedCount == 2) {
+      continue;
+    }
+    if (ctx->predictedCount == 0) {
+      prepared.push_back(ctx);
+    }
+    ctx->predicted[ctx->predictedCount] = candidates[i].entry;
+    ctx->predicted[ctx->predictedCount].size = size;
+    ctx->predictedCount++;
+  }
+  return prepared;
+}
+
+NAPI_FUNCTION(Node_setBulkMeasureFunc) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  global_env = env;
+  napi_set_named_property(env, jsThis, "_bulkMeasureFunc", argv[0]);
+  nodeContext(node)->hasBulkMeasureFunc = true;
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_unsetBulkMeasureFunc) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  napi_value undefined;
+  napi_get_undefined(env, &undefined);
+  napi_set_named_property(env, jsThis, "_bulkMeasureFunc", undefined);
+  nodeContext(node)->hasBulkMeasureFunc = false;
+  return NULL;
+}
+
+// Captures the JS stack of the current call, without this frame.
+static std::string captureStack(napi_env env) {
+  napi_value message, error, stack;
+  napi_create_string_utf8(env, "", 0, &message);
+  napi_create_error(env, NULL, message, &error);
+  napi_get_named_property(env, error, "stack", &stack);
+  size_t length = 0;
+  if (napi_get_value_string_utf8(env, stack, NULL, 0, &length) != napi_ok) {
+    return std::string();
+  }
+  std::string result(length, '\0');
+  napi_get_value_string_utf8(env, stack, result.data(), length + 1, &length);
+  return result;
+}
+
+static void traceDirtied(YGNodeConstRef nodeRef, NodeContext *ctx) {
+  // Propagation within the same call extends the current event.
+  if (lastTracedNode != NULL && lastTracedCall == napiCallSerial &&
+      YGNodeGetOwner((YGNodeRef)lastTracedNode) == nodeRef) {
+    dirtyEvents.back().dirtiedNodes++;
+    lastTracedNode = nodeRef;
+    return;
+  }
+  lastTracedNode = NULL;
+  if (tracedEventCount >= kMaxDirtyEvents) {
+    return;
+  }
+  DirtyEvent event = {ctx->id, 1, currentNapiCall, std::string(),
+                      ++tracedSerial};
+  // FFI calls must not re-enter JS.
+  if (dirtyTracingStacks && !deferDirtiedCallbacks) {
+    event.stack = captureStack(global_env);
+  }
+  dirtyEvents.push_back(std::move(event));
+  tracedEventCount++;
+  lastTracedNode = nodeRef;
+  lastTracedCall = napiCallSerial;
+}
+
+static void deliverDirtied(NodeContext *ctx) {
+  if (!ctx->hasDirtiedFunc) {
+    return;
+  }
+  if (dirtiedQueueEnabled) {
+    if (!ctx->queuedDirtied) {
+      ctx->queuedDirtied = true;
+      dirtiedQueue.push_back(ctx->id);
+    }
+    return;
+  }
+  if (deferDirtiedCallbacks) {
+    deferredDirtied.push_back(ctx->id);
+    return;
+  }
+
+  napi_value jsThis;
+  napi_get_reference_value(global_env, ctx->ref, &jsThis);
+
+  napi_value dirtiedFunc;
+  napi_get_named_property(global_env, jsThis, "_dirtiedFunc", &dirtiedFunc);
+
+  napi_value result;
+  napi_call_function(global_env, jsThis, dirtiedFunc, 0, NULL, &result);
+}
+
+static void globalDirtiedFunc(YGNodeConstRef nodeRef) {
+  NodeContext *ctx = nodeContext(nodeRef);
+  if (ctx == NULL) {
+    return;
+  }
+  ctx->hasIntrinsicSizes = false;
+  // Layouts that skip hashSubtree clean the node without rehashing it.
+  ctx->subtreeHashEpoch = 0;
+  if (dirtyTracingEnabled) {
+    traceDirtied(nodeRef, ctx);
+  }
+  deliverDirtied(ctx);
+}
+
+NAPI_FUNCTION(Node_setDirtiedFunc) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  global_env = env;
+  napi_set_named_property(env, jsThis, "_dirtiedFunc", argv[0]);
+  nodeContext(node)->hasDirtiedFunc = true;
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_unsetDirtiedFunc) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  napi_value undefined;
+  napi_get_undefined(env, &undefined);
+  napi_set_named_property(env, jsThis, "_dirtiedFunc", undefined);
+  nodeContext(node)->hasDirtiedFunc = false;
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_markDirty) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  prepareWrite(node);
+  YGNodeMarkDirty(node);
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_isDirty) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  bool isDirty = YGNodeIsDirty(node);
+  return js_bool(env, isDirty);
+}
+
+NAPI_FUNCTION(Node_markLayoutSeen) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  YGNodeSetHasNewLayout(node, false);
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_hasNewLayout) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  bool hasNewLayout = YGNodeGetHasNewLayout(node);
+  return js_bool(env, hasNewLayout);
+}
+
+// Whether `node` is `root` or lies below it in the live tree.
+static bool isInSubtree(YGNodeRef node, YGNodeRef root) {
+  while (node != NULL && node != root) {
+    node = liveParent(node);
+  }
+  return node == root;
+}
+
+// Marks the frozen nodes below `root` clean for a layout of it, see
+// layoutFrozenNodes. Returns them for resumeFrozenLayouts.
+static std::vector<YGNodeRef> suspendFrozenLayouts(YGNodeRef root) {
+  std::vector<YGNodeRef> suspended;
+  for (YGNodeRef node : layoutFrozenNodes) {
+    if (node != root && isInSubtree(node, root)) {
+      setDirtyQuietly(node, false);
+      suspended.push_back(node);
+    }
+  }
+  return suspended;
+}
+
+static void resumeFrozenLayouts(std::vector<YGNodeRef> const &suspended) {
+  for (YGNodeRef node : suspended) {
+    setDirtyQuietly(node, true);
+  }
+}
+
+// Lays out the tree under `node` the way `calculateLayout` does: through the
+// layout cache if enabled, after preparing bulk measurements, and with virtual
+// lists measured and settled.
+static void runLayout(napi_env env, napi_value jsThis, YGNodeRef node,
+                      float width, float height, YGDirection direction) {
+  // Cached layouts are copied onto the nodes in place, which would change the
+  // tree versions sharing them, so the cache sits out while there are any.
+  // Frozen layouts would be overwritten the same way.
+  LayoutCacheKey cacheKey = {};
+  bool hashed = layoutCache.capacity() > 0 && frozenNodeCount == 0 &&
+                layoutFrozenNodes.empty();
+  bool cacheable = hashed && hashSubtree(node, cacheKey.subtreeHash);
+  if (!hashed) {
+    // The pass cleans nodes whose stored hashes predate their changes.
+    invalidateAllSubtreeHashes();
+  }
+  if (cacheable) {
+    cacheKey = layoutCacheKey(cacheKey.subtreeHash, width, height, direction);
+    if (layoutCache.apply(cacheKey, node)) {
+      invalidateLayoutQueries();
+      return;
+    }
+  }
+  std::vector<YGNodeRef> suspended;
+  if (!layoutFrozenNodes.empty()) {
+    suspended = suspendFrozenLayouts(node);
+  }
+  std::vector<NodeContext *> prepared;
+  if (nodeContext(node)->hasBulkMeasureFunc) {
+    prepared = prepareBulkMeasure(env, jsThis, node, width, height);
+    bool pending = false;
+    if (napi_is_exception_pending(env, &pending) == napi_ok && pending) {
+      resumeFrozenLayouts(suspended);
+      return;
+    }
+  }
+  YGNodeCalculateLayout(node, width, height, direction);
+  returnLentNodes();
+  if (!virtualLists.empty() && measureVirtualLists(node)) {
+    YGNodeCalculateLayout(node, width, height, direction);
+    returnLentNodes();
+  }
+  resumeFrozenLayouts(suspended);
+  for (NodeContext *ctx : prepared) {
+    ctx->predictedCount = 0;
+  }
+  if (cacheable) {
+    layoutCache.store(cacheKey, node);
+  }
+  invalidateLayoutQueries();
+}
+
+// Moves the pending dirty events of nodes under `root` into a trace of this
+// layout, dropping those of freed nodes. Layouts of clean trees aren't
+// recorded.
+static void traceLayout(YGNodeRef root, double durationMs) {
+  LayoutTrace trace = {nodeContext(root)->id, durationMs, {}, ++tracedSerial};
+  std::erase_if(dirtyEvents, [&](DirtyEvent &event) {
+    if (isRetired(event.node, event.serial)) {
+      tracedEventCount--;
+      return true;
+    }
+    if (!isInSubtree(nodeRegistry.get(event.node), root)) {
+      return false;
+    }
+    trace.events.push_back(std::move(event));
+    return true;
+  });
+  if (!trace.events.empty()) {
+    layoutTraces.push_back(std::move(trace));
+  }
+  lastTracedNode = NULL;
+}
+
+static void calculateLayout(napi_env env, napi_value jsThis, YGNodeRef node,
+                            float width, float height, YGDirection direction) {
+  if (!dirtyTracingEnabled) {
+    runLayout(env, jsThis, node, width, height, direction);
+  } else {
+    auto start = std::chrono::steady_clock::now();
+    runLayout(env, jsThis, node, width, height, direction);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    traceLayout(node, elapsed.count());
+  }
+  if (!damageRegions.empty()) {
+    auto found = damageRegions.find(node);
+    if (found != damageRegions.end()) {
+      collectDamage(node, &found->second);
+    }
+  }
+  if (!contentSizeRoots.empty() && contentSizeRoots.count(node) != 0) {
+    updateContentExtents(node, false);
+  }
+}
+
+NAPI_FUNCTION(Node_calculateLayout) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 3);
+  prepareWrite(node);
+  NAPI_ARG_DOUBLE(width, 0);
+  NAPI_ARG_DOUBLE(height, 1);
+  NAPI_ARG_INT32(direction, 2);
+  calculateLayout(env, jsThis, node, width, height,
+                  static_cast<YGDirection>(direction));
+  return NULL;
+}
+
+// Time-sliced layout. A dirty descendant with a fixed point width and height
+// that can't flex lays out the same wherever it sits, so it can be laid out
+// on its own ahead of the root pass, in the direction it inherits. Those
+// subtrees are laid out innermost first until the budget runs out; each one is
+// left clean with its results in Yoga's layout cache, which the final root
+// pass then reuses. Progress is kept in the tree itself, so the next call
+// picks up wherever this one stopped.
+//
+// Yoga's cache doesn't key on the size of the owner, so a slice must not
+// resolve percentages against it, and must be the containing block of its
+// absolute descendants rather than leaving them to an ancestor.
+
+static bool isPercent(YGValue value) { return value.unit == YGUnitPercent; }
+
+static bool isLayoutSlice(YGNodeConstRef node) {
+  if (YGNodeStyleGetWidth(node).unit != YGUnitPoint ||
+      YGNodeStyleGetHeight(node).unit != YGUnitPoint ||
+      YGNodeStyleGetFlexGrow(node) > 0 || YGNodeStyleGetFlexShrink(node) > 0 ||
+      YGNodeStyleGetFlex(node) > 0 || YGNodeStyleGetFlex(node) < 0 ||
+      YGNodeStyleGetFlexBasis(node).unit == YGUnitPoint ||
+      isPercent(YGNodeStyleGetFlexBasis(node)) ||
+      YGNodeStyleGetPositionType(node) == YGPositionTypeStatic ||
+      isPercent(YGNodeStyleGetMinWidth(node)) ||
+      isPercent(YGNodeStyleGetMinHeight(node)) ||
+      isPercent(YGNodeStyleGetMaxWidth(node)) ||
+      isPercent(YGNodeStyleGetMaxHeight(node))) {
+    return false;
+  }
+  for (int index = YGEdgeLeft; index <= YGEdgeAll; index++) {
+    YGEdge edge = static_cast<YGEdge>(index);
+    if (isPercent(YGNodeStyleGetMargin(node, edge)) ||
+        isPercent(YGNodeStyleGetPadding(node, edge)) ||
+        isPercent(YGNodeStyleGetPosition(node, edge))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void collectLayoutSlices(YGNodeRef root,
+                                std::vector<YGNodeRef> &slices) {
+  std::vector<YGNodeRef> stack = {root};
+  while (!stack.empty()) {
+    YGNodeRef node = stack.back();
+    stack.pop_back();
+    if (node != root && isLayoutSlice(node)) {
+      slices.push_back(node);
+    }
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      YGNodeRef child = YGNodeGetChild(node, i);
+      if (YGNodeIsDirty(child) && !nodeContext(child)->layoutFrozen &&
+          YGNodeStyleGetDisplay(child) != YGDisplayNone) {
+        stack.push_back(child);
+      }
+    }
+  }
+}
+
+// The direction `node` inherits from its owner in a layout of `root` in
+// `direction`.
+static YGDirection inheritedDirection(YGNodeRef node, YGNodeRef root,
+                                      YGDirection direction) {
+  for (YGNodeRef at = liveParent(node); at != NULL;
+       at = at == root ? NULL : liveParent(at)) {
+    YGDirection own = YGNodeStyleGetDirection(at);
+    if (own != YGDirectionInherit) {
+      return own;
+    }
+  }
+  return direction;
+}
+
+NAPI_FUNCTION(Node_calculateLayoutSliced) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 4);
+  prepareWrite(node);
+  NAPI_ARG_DOUBLE(width, 0);
+  NAPI_ARG_DOUBLE(height, 1);
+  NAPI_ARG_INT32(direction, 2);
+  NAPI_ARG_DOUBLE(budgetMs, 3);
+  auto deadline = std::chrono::steady_clock::now() +
+                  std::chrono::duration<double, std::milli>(budgetMs);
+
+  std::vector<YGNodeRef> slices;
+  if (YGNodeIsDirty(node)) {
+    collectLayoutSlices(node, slices);
+  }
+  // At least one step is taken per call, so that every call makes progress.
+  bool progressed = false;
+  for (auto it = slices.rbegin(); it != slices.rend(); ++it) {
+    if (progressed && std::chrono::steady_clock::now() >= deadline) {
+      invalidateLayoutQueries();
+      return js_bool(env, false);
+    }
+    if (YGNodeIsDirty(*it)) {
+      prepareWrite(*it);
+      YGNodeCalculateLayout(
+          *it, YGUndefined, YGUndefined,
+          inheritedDirection(*it, node, static_cast<YGDirection>(direction)));
+      returnLentNodes();
+      invalidateAllSubtreeHashes();
+      progressed = true;
+    }
+  }
+  if (progressed && std::chrono::steady_clock::now() >= deadline) {
+    invalidateLayoutQueries();
+    return js_bool(env, false);
+  }
+
+  calculateLayout(env, jsThis, node, width, height,
+                  static_cast<YGDirection>(direction));
+  return js_bool(env, true);
+}
+
+NAPI_FUNCTION(Node_queryRect) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 4);
+  NAPI_ARG_DOUBLE(x, 0);
+  NAPI_ARG_DOUBLE(y, 1);
+  NAPI_ARG_DOUBLE(width, 2);
+  NAPI_ARG_DOUBLE(height, 3);
+  std::vector<YGNodeRef> matches;
+  LayoutRect rect = {(float)x, (float)y, (float)(x + width),
+                     (float)(y + height)};
+  spatialIndexFor(node).query(rect, matches);
+  napi_value result;
+  napi_create_array_with_length(env, matches.size(), &result);
+  for (size_t i = 0; i < matches.size(); i++) {
+    napi_set_element(env, result, i, nodeToJS(env, matches[i]));
+  }
+  return result;
+}
+
+NAPI_FUNCTION(Node_hitTest) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  NAPI_ARG_DOUBLE(x, 0);
+  NAPI_ARG_DOUBLE(y, 1);
+  YGNodeRef hit = spatialIndexFor(node).hitTest(x, y);
+  if (hit == NULL) {
+    return NULL;
+  }
+  return nodeToJS(env, hit);
+}
+
+// Lists the subtree under `root` in preorder along with the index of each
+// node's parent (-1 for the root) and its depth.
+static void collectPreorder(YGNodeRef root, std::vector<YGNodeRef> &nodes,
+                            std::vector<int32_t> &parents,
+                            std::vector<uint32_t> &depths) {
+  struct Pending {
+    YGNodeRef node;
+    int32_t parent;
+    uint32_t depth;
+  };
+  std::vector<Pending> stack = {{root, -1, 0}};
+  while (!stack.empty()) {
+    Pending pending = stack.back();
+    stack.pop_back();
+    int32_t index = nodes.size();
+    nodes.push_back(pending.node);
+    parents.push_back(pending.parent);
+    depths.push_back(pending.depth);
+    for (size_t i = YGNodeGetChildCount(pending.node); i > 0; i--) {
+      stack.push_back(
+          {YGNodeGetChild(pending.node, i - 1), index, pending.depth + 1});
+    }
+  }
+}
+
+// Returns the shape of the subtree as parallel typed arrays in preorder, plus
+// the node wrappers themselves when asked for.
+NAPI_FUNCTION(Node_exportTopology) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  NAPI_ARG_BOOL(includeNodes, 0);
+
+  std::vector<YGNodeRef> nodes;
+  std::vector<int32_t> parents;
+  std::vector<uint32_t> depths;
+  collectPreorder(node, nodes, parents, depths);
+
+  size_t count = nodes.size();
+  int32_t *parentData;
+  uint32_t *childCountData, *depthData, *idData;
+  napi_value parent = js_typed_array(env, napi_int32_array, count,
+                                     sizeof(int32_t), (void **)&parentData);
+  napi_value childCount =
+      js_typed_array(env, napi_uint32_array, count, sizeof(uint32_t),
+                     (void **)&childCountData);
+  napi_value depth = js_typed_array(env, napi_uint32_array, count,
+                                    sizeof(uint32_t), (void **)&depthData);
+  napi_value ids = js_typed_array(env, napi_uint32_array, count,
+                                  sizeof(uint32_t), (void **)&idData);
+  for (size_t i = 0; i < count; i++) {
+    parentData[i] = parents[i];
+    childCountData[i] = YGNodeGetChildCount(nodes[i]);
+    depthData[i] = depths[i];
+    idData[i] = nodeContext(nodes[i])->id;
+  }
+
+  napi_value result;
+  napi_create_object(env, &result);
+  napi_set_named_property(env, result, "parent", parent);
+  napi_set_named_property(env, result, "childCount", childCount);
+  napi_set_named_property(env, result, "depth", depth);
+  napi_set_named_property(env, result, "ids", ids);
+  // Versions hold no wrappers; their ids match those of the live nodes.
+  if (includeNodes && !nodeContext(node)->frozen) {
+    napi_value wrappers;
+    napi_create_array_with_length(env, count, &wrappers);
+    for (size_t i = 0; i < count; i++) {
+      napi_set_element(env, wrappers, i, nodeToJS(env, nodes[i]));
+    }
+    napi_set_named_property(env, result, "nodes", wrappers);
+  }
+  return result;
+}
+
+// The frozen node above each node of a version in preorder, see versionLayout.
+static std::vector<YGNodeRef>
+versionBoundaries(std::vector<YGNodeRef> const &nodes,
+                  std::vector<int32_t> const &parents) {
+  std::vector<YGNodeRef> boundaries(nodes.size(), NULL);
+  for (size_t i = 1; i < nodes.size(); i++) {
+    if (!nodeContext(nodes[i])->frozen) {
+      YGNodeRef parent = nodes[parents[i]];
+      boundaries[i] =
+          nodeContext(parent)->frozen ? parent : boundaries[parents[i]];
+    }
+  }
+  return boundaries;
+}
+
+// Exports left, top, width and height of every node in the order of
+// exportTopology. With a `scale`, frames are converted to whole device pixels
+// the way Yoga's pixel grid rounding would: positions relative to the parent
+// are rounded on their own, and sizes are the distance between the rounded
+// absolute edges. The result is a Float32Array, or an Int32Array if `asInt32`
+// is set (undefined values become 0).
+//
+// Meant for layouts computed with a point scale factor of 0, so the same
+// layout can be snapped for several densities.
+NAPI_FUNCTION(Node_exportLayout) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  NAPI_ARG_DOUBLE(scale, 0);
+  NAPI_ARG_BOOL(asInt32, 1);
+  if (!(scale >= 0) || !std::isfinite(scale)) {
+    napi_throw_range_error(env, NULL, "Invalid pixel scale");
+    return NULL;
+  }
+
+  std::vector<YGNodeRef> nodes;
+  std::vector<int32_t> parents;
+  std::vector<uint32_t> depths;
+  collectPreorder(node, nodes, parents, depths);
+  size_t count = nodes.size();
+
+  std::vector<float> frames(count * 4);
+  if (nodeContext(node)->frozen) {
+    std::vector<YGNodeRef> boundaries = versionBoundaries(nodes, parents);
+    for (size_t i = 0; i < count; i++) {
+      LayoutRecord layout = versionLayout(nodes[i], boundaries[i]);
+      frames[i * 4] = layout.position[0];
+      frames[i * 4 + 1] = layout.position[1];
+      frames[i * 4 + 2] = layout.width;
+      frames[i * 4 + 3] = layout.height;
+    }
+  } else {
+    for (size_t i = 0; i < count; i++) {
+      frames[i * 4] = YGNodeLayoutGetLeft(nodes[i]);
+      frames[i * 4 + 1] = YGNodeLayoutGetTop(nodes[i]);
+      frames[i * 4 + 2] = YGNodeLayoutGetWidth(nodes[i]);
+      frames[i * 4 + 3] = YGNodeLayoutGetHeight(nodes[i]);
+    }
+  }
+
+  if (scale > 0) {
+    // Relative left and top, then absolute left, top, right and bottom, each
+    // as one run so they are rounded in a single pass.
+    std::vector<float> edges(count * 6);
+    float *left = edges.data(), *top = left + count;
+    float *absLeft = top + count, *absTop = absLeft + count;
+    float *absRight = absTop + count, *absBottom = absRight + count;
+    for (size_t i = 0; i < count; i++) {
+      int32_t parent = parents[i];
+      left[i] = frames[i * 4];
+      top[i] = frames[i * 4 + 1];
+      absLeft[i] = left[i] + (parent >= 0 ? absLeft[parent] : 0);
+      absTop[i] = top[i] + (parent >= 0 ? absTop[parent] : 0);
+      absRight[i] = absLeft[i] + frames[i * 4 + 2];
+      absBottom[i] = absTop[i] + frames[i * 4 + 3];
+    }
+    std::vector<float> rounded(edges.size());
+    roundToPixelGrid(edges.data(), rounded.data(), edges.size(), scale);
+    const float *rLeft = rounded.data(), *rTop = rLeft + count;
+    const float *rAbsLeft = rTop + count, *rAbsTop = rAbsLeft + count;
+    const float *rAbsRight = rAbsTop + count, *rAbsBottom = rAbsRight + count;
+    for (size_t i = 0; i < count; i++) {
+      frames[i * 4] = rLeft[i];
+      frames[i * 4 + 1] = rTop[i];
+      frames[i * 4 + 2] = rAbsRight[i] - rAbsLeft[i];
+      frames[i * 4 + 3] = rAbsBottom[i] - rAbsTop[i];
+    }
+
+    // Text rounds its leading edges down, and its trailing edges up if its
+    // size is fractional and down otherwise.
+    auto fractional = [scale](double size) {
+      double fraction = std::fmod(size * scale, 1.0);
+      return std::fabs(fraction) >= 0.0001 &&
+             std::fabs(fraction - 1.0) >= 0.0001;
+    };
+    for (size_t i = 0; i < count; i++) {
+      if (YGNodeGetNodeType(nodes[i]) != YGNodeTypeText) {
+        continue;
+      }
+      bool wide = fractional(absRight[i] - absLeft[i]);
+      bool tall = fractional(absBottom[i] - absTop[i]);
+      frames[i * 4] = roundScaled(left[i] * scale, false, true);
+      frames[i * 4 + 1] = roundScaled(top[i] * scale, false, true);
+      frames[i * 4 + 2] = roundScaled(absRight[i] * scale, wide, !wide) -
+                          roundScaled(absLeft[i] * scale, false, true);
+      frames[i * 4 + 3] = roundScaled(absBottom[i] * scale, tall, !tall) -
+                          roundScaled(absTop[i] * scale, false, true);
+    }
+  }
+
+  if (asInt32) {
+    int32_t *data;
+    napi_value result = js_typed_array(env, napi_int32_array, frames.size(),
+                                       sizeof(int32_t), (void **)&data);
+    for (size_t i = 0; i < frames.size(); i++) {
+      data[i] = std::isnan(frames[i]) ? 0 : (int32_t)std::lround(frames[i]);
+    }
+    return result;
+  }
+  float *data;
+  napi_value result = js_typed_array(env, napi_float32_array, frames.size(),
+                                     sizeof(float), (void **)&data);
+  std::copy(frames.begin(), frames.end(), data);
+  return result;
+}
+
+// The current layout is the baseline the next damage is measured against.
+NAPI_FUNCTION(Node_setDamageTrackingEnabled) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  NAPI_ARG_BOOL(enabled, 0);
+  if (!enabled) {
+    damageRegions.erase(node);
+  } else if (damageRegions.count(node) == 0) {
+    damageRegions[node];
+    collectDamage(node, NULL);
+  }
+  return NULL;
+}
+
+// Returns left, top, width and height of the damage rects collected since the
+// last call, and starts over.
+NAPI_FUNCTION(Node_takeDamage) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  auto found = damageRegions.find(node);
+  if (found == damageRegions.end()) {
+    napi_throw_error(env, NULL, "Damage tracking is not enabled");
+    return NULL;
+  }
+  std::vector<LayoutRect> const &rects = found->second.rects();
+  float *data;
+  napi_value result = js_typed_array(env, napi_float32_array, rects.size() * 4,
+                                     sizeof(float), (void **)&data);
+  for (LayoutRect const &rect : rects) {
+    *data++ = rect.left;
+    *data++ = rect.top;
+    *data++ = rect.right - rect.left;
+    *data++ = rect.bottom - rect.top;
+  }
+  found->second.clear();
+  return result;
+}
+
+NAPI_FUNCTION(Node_setContentSizeEnabled) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  NAPI_ARG_BOOL(enabled, 0);
+  if (!enabled) {
+    contentSizeRoots.erase(node);
+  } else if (contentSizeRoots.insert(node).second) {
+    updateContentExtents(node, true);
+  }
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_setLayoutFrozen) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  prepareWrite(node);
+  NAPI_ARG_BOOL(frozen, 0);
+  NodeContext *ctx = nodeContext(node);
+  if (frozen == ctx->layoutFrozen) {
+    return NULL;
+  }
+  ctx->layoutFrozen = frozen;
+  if (frozen) {
+    layoutFrozenNodes.insert(node);
+    setDirtyQuietly(node, true);
+    return NULL;
+  }
+  layoutFrozenNodes.erase(node);
+  // The node is still dirty, so the next layout reaching it catches up on
+  // whatever changed below it meanwhile.
+  YGNodeRef owner = YGNodeGetOwner(node);
+  if (owner != NULL) {
+    resolveRef(owner)->markDirtyAndPropagate();
+  }
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_isLayoutFrozen) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  return js_bool(env, nodeContext(node)->layoutFrozen);
+}
+
+// Returns the size of the scrollable content of a node with scroll overflow,
+// or undefined for other nodes.
+NAPI_FUNCTION(Node_getContentSize) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  if (YGNodeStyleGetOverflow(node) != YGOverflowScroll) {
+    return NULL;
+  }
+  if (!hasCurrentContentExtent(node)) {
+    updateContentExtents(node, true);
+  }
+  YGSize size = contentSize(node);
+  napi_value obj;
+  napi_create_object(env, &obj);
+  napi_set_named_property(env, obj, "width", js_double(env, size.width));
+  napi_set_named_property(env, obj, "height", js_double(env, size.height));
+  return obj;
+}
+
+static VirtualList *unwrapVirtualList(napi_env env, YGNodeRef node) {
+  VirtualList *list = nodeContext(node)->virtualList;
+  if (list == NULL) {
+    napi_throw_error(env, NULL, "Node is not a virtual list");
+  }
+  return list;
+}
+
+NAPI_FUNCTION(Node_setVirtualItemCount) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
+  NAPI_ARG_DOUBLE(count, 0);
+  NAPI_ARG_DOUBLE(estimatedItemSize, 1);
+  if (!(count >= 0) || !std::isfinite(estimatedItemSize)) {
+    napi_throw_range_error(env, NULL, "Invalid virtual list item count");
+    return NULL;
+  }
+  NodeContext *ctx = nodeContext(node);
+  if (ctx->virtualList == NULL) {
+    ctx->virtualList = new VirtualList();
+    ctx->virtualList->savePadding(node);
+    virtualLists.insert(node);
+    adjustNativeMemory(env, ctx->virtualList->bytes());
+  }
+  int64_t previousBytes = ctx->virtualList->bytes();
+  ctx->virtualList->sizes.resize(count, estimatedItemSize);
+  adjustNativeMemory(env, ctx->virtualList->bytes() - previousBytes);
+  ctx->virtualList->updateRange();
+  ctx->virtualList->applySpacers(node);
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_setVirtualItemSize) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 2);
+  prepareWrite(node);
+  NAPI_ARG_DOUBLE(index, 0);
+  NAPI_ARG_DOUBLE(size, 1);
+  VirtualList *list = unwrapVirtualList(env, node);
+  if (list == NULL) {
+    return NULL;
+  }
+  if (!(index >= 0 && index < list->sizes.size())) {
+    napi_throw_range_error(env, NULL, "Virtual list index out of range");
+    return NULL;
+  }
+  list->sizes.set(index, size);
+  list->applySpacers(node);
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_setVirtualWindow) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 3);
+  prepareWrite(node);
+  NAPI_ARG_DOUBLE(offset, 0);
+  NAPI_ARG_DOUBLE(length, 1);
+  NAPI_ARG_INT32(overscan, 2);
+  VirtualList *list = unwrapVirtualList(env, node);
+  if (list == NULL) {
+    return NULL;
+  }
+  list->windowOffset = offset;
+  list->windowLength = std::max(length, 0.0);
+  list->overscan = std::max(overscan, 0);
+  list->updateRange();
+  list->applySpacers(node);
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_getVirtualRange) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  VirtualList *list = unwrapVirtualList(env, node);
+  if (list == NULL) {
+    return NULL;
+  }
+  napi_value obj;
+  napi_create_object(env, &obj);
+  napi_set_named_property(env, obj, "start", js_double(env, list->start));
+  napi_set_named_property(env, obj, "end", js_double(env, list->end));
+  return obj;
+}
+
+NAPI_FUNCTION(Node_getVirtualContentSize) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  VirtualList *list = unwrapVirtualList(env, node);
+  if (list == NULL) {
+    return NULL;
+  }
+  return js_double(env, list->contentSize(node));
+}
+
+NAPI_FUNCTION(Node_getVirtualItemOffset) {
+  NAPI_METHOD_HEADER(YGNodeRef, node, 1);
+  NAPI_ARG_DOUBLE(index, 0);
+  VirtualList *list = unwrapVirtualList(env, node);
+  if (list == NULL) {
+    return NULL;
+  }
+  if (!(index >= 0 && index <= list->sizes.size())) {
+    napi_throw_range_error(env, NULL, "Virtual list index out of range");
+    return NULL;
+  }
+  return js_double(env, list->sizes.prefix(index));
+}
+
+NAPI_FUNCTION(Node_unsetVirtualList) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  prepareWrite(node);
+  VirtualList *list = nodeContext(node)->virtualList;
+  if (list != NULL) {
+    list->restorePadding(node);
+    dropVirtualList(env, node);
+  }
+  return NULL;
+}
+
+NAPI_FUNCTION(Node_getComputedLeft) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  float left = YGNodeLayoutGetLeft(node);
+  return js_double(env, left);
+}
+
+NAPI_FUNCTION(Node_getComputedRight) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  float right = YGNodeLayoutGetRight(node);
+  return js_double(env, right);
+}
+
+NAPI_FUNCTION(Node_getComputedTop) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  float top = YGNodeLayoutGetTop(node);
+  return js_double(env, top);
+}
+
+NAPI_FUNCTION(Node_getComputedBottom) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  float bottom = YGNodeLayoutGetBottom(node);
+  return js_double(env, bottom);
+}
+
+NAPI_FUNCTION(Node_getComputedWidth) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  float width = YGNodeLayoutGetWidth(node);
+  return js_double(env, width);
+}
 
 NAPI_FUNCTION(Node_getComputedHeight) {
   NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
@@ -849,8 +2680,7 @@ NAPI_FUNCTION(Node_getComputedHeight) {
   return js_double(env, height);
 }
 
-NAPI_FUNCTION(Node_getComputedLayout) {
-  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+static napi_value computedLayoutToJS(napi_env env, YGNodeRef node) {
   napi_value obj;
   napi_create_object(env, &obj);
   napi_set_named_property(env, obj, "left",
@@ -868,6 +2698,25 @@ NAPI_FUNCTION(Node_getComputedLayout) {
   return obj;
 }
 
+static napi_value computedLayoutToJS(napi_env env,
+                                     LayoutRecord const &layout) {
+  napi_value obj;
+  napi_create_object(env, &obj);
+  const char *edges[] = {"left", "top", "right", "bottom"};
+  for (int i = 0; i < 4; i++) {
+    napi_set_named_property(env, obj, edges[i],
+                            js_double(env, layout.position[i]));
+  }
+  napi_set_named_property(env, obj, "width", js_double(env, layout.width));
+  napi_set_named_property(env, obj, "height", js_double(env, layout.height));
+  return obj;
+}
+
+NAPI_FUNCTION(Node_getComputedLayout) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  return computedLayoutToJS(env, node);
+}
+
 NAPI_FUNCTION(Node_getComputedMargin) {
   NAPI_METHOD_HEADER(YGNodeRef, node, 1);
   NAPI_ARG_INT32(edge, 0);
@@ -889,14 +2738,515 @@ NAPI_FUNCTION(Node_getComputedPadding) {
   return js_double(env, padding);
 }
 
+// Runs on a copy of the subtree, so it doesn't need a layout and leaves the
+// current one alone. See intrinsic_sizes.h.
+NAPI_FUNCTION(Node_getIntrinsicSizes) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  global_env = env;
+  IntrinsicSizes const &sizes = intrinsicSizes(node);
+  napi_value obj;
+  napi_create_object(env, &obj);
+  napi_set_named_property(env, obj, "minContentWidth",
+                          js_double(env, sizes.minContentWidth));
+  napi_set_named_property(env, obj, "minContentHeight",
+                          js_double(env, sizes.minContentHeight));
+  napi_set_named_property(env, obj, "maxContentWidth",
+                          js_double(env, sizes.maxContentWidth));
+  napi_set_named_property(env, obj, "maxContentHeight",
+                          js_double(env, sizes.maxContentHeight));
+  return obj;
+}
+
 NAPI_FUNCTION(Node_getDirection) {
   NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
   int direction = YGNodeStyleGetDirection(node);
   return js_int32(env, direction);
 }
 
+NAPI_FUNCTION(Node_serialize) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  std::vector<uint8_t> bytes;
+  auto presetOf = [](YGNodeConstRef at) {
+    return nodeContext(at)->measurePreset;
+  };
+  if (nodeContext(node)->frozen) {
+    std::vector<YGNodeRef> nodes;
+    std::vector<int32_t> parents;
+    std::vector<uint32_t> depths;
+    collectPreorder(node, nodes, parents, depths);
+    std::vector<YGNodeRef> boundaries = versionBoundaries(nodes, parents);
+    // serializeTree visits the nodes in preorder.
+    size_t next = 0;
+    serializeTree(node, bytes, presetOf, [&](YGNodeConstRef at) {
+      return versionLayout(at, boundaries[next++]);
+    });
+  } else {
+    serializeTree(node, bytes, presetOf);
+  }
+  void *data;
+  napi_value result;
+  napi_create_arraybuffer(env, bytes.size(), &data, &result);
+  NAPI_PROFILE_BYTES(bytes.size());
+  std::copy(bytes.begin(), bytes.end(), (uint8_t *)data);
+  return result;
+}
+
+NAPI_FUNCTION(Node_deserialize) {
+  NapiCallScope napiCallScope(__func__);
+  napi_value jsThis;
+  size_t argc = 2;
+  napi_value argv[2];
+  napi_get_cb_info(env, cbinfo, &argc, argv, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)2), argv);
+  void *data = NULL;
+  size_t length = 0;
+  if (argc < 1 || !js_buffer_data(env, argv[0], &data, &length)) {
+    napi_throw_type_error(env, NULL, "Expected an ArrayBuffer or typed array");
+    return NULL;
+  }
+
+  // Wrappers are created through the constructor so the restored nodes are
+  // indistinguishable from ones built in JS.
+  napi_valuetype configType = napi_undefined;
+  if (argc > 1) {
+    napi_typeof(env, argv[1], &configType);
+  }
+  size_t configArgc = configType == napi_object ? 1 : 0;
+  std::vector<YGNodeRef> nodes;
+  bool ok = deserializeTree(
+      (const uint8_t *)data, length,
+      [&]() {
+        napi_value instance;
+        napi_new_instance(env, jsThis, configArgc, &argv[1], &instance);
+        return (YGNodeRef)unwrap(env, instance);
+      },
+      [](YGNodeRef node, MeasurePreset const &preset) {
+        nodeContext(node)->measurePreset = preset;
+        YGNodeSetMeasureFunc(node, &presetMeasureFunc);
+      },
+      nodes);
+  if (!ok) {
+    for (YGNodeRef node : nodes) {
+      releaseNodeContext(env, node);
+      YGNodeFinalize(node);
+    }
+    napi_throw_error(env, NULL, "Invalid or unsupported layout snapshot");
+    return NULL;
+  }
+  invalidateLayoutQueries();
+  return nodeToJS(env, nodes[0]);
+}
+
+// Tree versions wrap the frozen copy of their root, see persistent_tree.h. The
+// class isn't exported; versions are only made by `snapshot`, which hands the
+// root to the constructor here.
+thread_local napi_ref treeVersionConstructor = NULL;
+thread_local YGNodeRef pendingVersionRoot = NULL;
+
+NAPI_FUNCTION(Node_snapshot) {
+  NAPI_METHOD_HEADER_NO_ARGS(YGNodeRef, node);
+  napi_value constructor, version;
+  napi_get_reference_value(env, treeVersionConstructor, &constructor);
+  pendingVersionRoot = freezeSnapshot(node);
+  napi_new_instance(env, constructor, 0, NULL, &version);
+  return version;
+}
+
 // } /* class Node */
 
+// class TreeVersion {
+
+// The nodes of versions by id, with the frozen node above each, see
+// versionLayout. Built on first lookup and rebuilt once unsharing has changed
+// the nodes.
+struct VersionIndex {
+  uint64_t unshareCount;
+  std::unordered_map<uint32_t, std::pair<YGNodeRef, YGNodeRef>> nodes;
+};
+thread_local std::unordered_map<YGNodeRef, VersionIndex> versionIndexes;
+
+static void releaseVersion(YGNodeRef root) {
+  versionIndexes.erase(root);
+  releaseFrozen(root);
+}
+
+static NAPI_FINALIZER(TreeVersion_finalize) {
+  releaseVersion((YGNodeRef)data);
+}
+
+NAPI_FUNCTION(TreeVersion_constructor) {
+  napi_value jsThis;
+  napi_get_cb_info(env, cbinfo, NULL, NULL, &jsThis, NULL);
+  if (pendingVersionRoot == NULL) {
+    napi_throw_type_error(env, NULL, "Tree versions are made by snapshot()");
+    return NULL;
+  }
+  napi_wrap(env, jsThis, pendingVersionRoot, TreeVersion_finalize, NULL, NULL);
+  pendingVersionRoot = NULL;
+  return jsThis;
+}
+
+// Returns the node of the version with the given id and the frozen node above
+// it, or NULLs.
+static std::pair<YGNodeRef, YGNodeRef> versionNode(YGNodeRef root,
+                                                   uint32_t id) {
+  auto [it, added] = versionIndexes.try_emplace(root);
+  VersionIndex &index = it->second;
+  if (added || index.unshareCount != unshareCount) {
+    index.unshareCount = unshareCount;
+    index.nodes.clear();
+    std::vector<std::pair<YGNodeRef, YGNodeRef>> stack = {{root, NULL}};
+    while (!stack.empty()) {
+      auto [node, boundary] = stack.back();
+      stack.pop_back();
+      index.nodes.emplace(nodeContext(node)->id,
+                          std::make_pair(node, boundary));
+      YGNodeRef below = nodeContext(node)->frozen ? node : boundary;
+      for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+        stack.push_back({YGNodeGetChild(node, i), below});
+      }
+    }
+  }
+  auto found = index.nodes.find(id);
+  if (found == index.nodes.end()) {
+    return {NULL, NULL};
+  }
+  return found->second;
+}
+
+// Returns the layout of the root, or of the node of the version with the id of
+// the given node, if it has one.
+NAPI_FUNCTION(TreeVersion_getComputedLayout) {
+  NAPI_METHOD_HEADER(YGNodeRef, root, 1);
+  napi_valuetype type = napi_undefined;
+  if (argc > 0) {
+    napi_typeof(env, argv[0], &type);
+  }
+  if (type != napi_object) {
+    return computedLayoutToJS(env, root);
+  }
+  YGNodeRef node = (YGNodeRef)unwrap(env, argv[0]);
+  uint32_t id = nodeContext(node)->id;
+  auto [found, boundary] = versionNode(root, id);
+  if (found == NULL) {
+    return NULL;
+  }
+  return computedLayoutToJS(env, versionLayout(found, boundary));
+}
+
+// Freeing a version twice is harmless.
+NAPI_FUNCTION(TreeVersion_free) {
+  NapiCallScope napiCallScope(__func__);
+  napi_value jsThis;
+  napi_get_cb_info(env, cbinfo, NULL, NULL, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, 0, NULL);
+  void *root = NULL;
+  if (napi_remove_wrap(env, jsThis, &root) == napi_ok && root != NULL) {
+    releaseVersion((YGNodeRef)root);
+  }
+  return NULL;
+}
+
+// } /* class TreeVersion */
+
+// namespace Yoga {
+
+NAPI_FUNCTION(Yoga_setDirtiedQueueEnabled) {
+  napi_value arg;
+  size_t argc = 1;
+  napi_get_cb_info(env, cbinfo, &argc, &arg, NULL, NULL);
+  napi_get_value_bool(env, arg, &dirtiedQueueEnabled);
+  return NULL;
+}
+
+NAPI_FUNCTION(Yoga_drainDirtiedQueue) {
+  size_t count = 0;
+  for (uint32_t id : dirtiedQueue) {
+    // Skip nodes freed while queued, and ids already reused by another node.
+    YGNodeRef node = nodeRegistry.get(id);
+    if (node != NULL && nodeContext(node)->queuedDirtied) {
+      nodeContext(node)->queuedDirtied = false;
+      dirtiedQueue[count++] = id;
+    }
+  }
+  napi_value result = js_uint32_array(env, dirtiedQueue.data(), count);
+  dirtiedQueue.clear();
+  return result;
+}
+
+// Delivers the dirtied callbacks deferred by FFI calls.
+NAPI_FUNCTION(Yoga_flushDeferredDirtied) {
+  std::vector<uint32_t> ids;
+  ids.swap(deferredDirtied);
+  for (uint32_t id : ids) {
+    YGNodeRef node = nodeRegistry.get(id);
+    if (node != NULL) {
+      deliverDirtied(nodeContext(node));
+    }
+  }
+  return NULL;
+}
+
+// Dirties every measured node under `root` with the given measure tag and
+// forgets the measurements the binding kept for them. Returns how many nodes
+// matched.
+NAPI_FUNCTION(Yoga_markDirtyByTag) {
+  NapiCallScope napiCallScope(__func__);
+  napi_value jsThis;
+  napi_value argv[2];
+  size_t argc = 2;
+  napi_get_cb_info(env, cbinfo, &argc, argv, &jsThis, NULL);
+  NAPI_CALL_HOOK(jsThis, std::min(argc, (size_t)2), argv);
+  YGNodeRef root = NULL;
+  if (argc < 2 || napi_unwrap(env, argv[0], (void **)&root) != napi_ok ||
+      root == NULL) {
+    napi_throw_type_error(env, NULL, "Expected a node and a measure tag");
+    return NULL;
+  }
+  uint32_t tag = 0;
+  napi_get_value_uint32(env, argv[1], &tag);
+
+  uint32_t matched = 0;
+  bool hadCacheKey = false;
+  std::vector<YGNodeRef> stack = {root};
+  while (!stack.empty() && tag != 0) {
+    YGNodeRef node = stack.back();
+    stack.pop_back();
+    NodeContext *ctx = nodeContext(node);
+    if (ctx->measureTag == tag && YGNodeHasMeasureFunc(node)) {
+      prepareWrite(node);
+      ctx->hasLastMeasure = false;
+      ctx->predictedCount = 0;
+      ctx->hasIntrinsicSizes = false;
+      hadCacheKey |= ctx->hasMeasureCacheKey;
+      resolveRef(node)->markDirtyAndPropagate();
+      matched++;
+    }
+    for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+      stack.push_back(YGNodeGetChild(node, i));
+    }
+  }
+  // Cached layouts were keyed by the old measurements under the same cache
+  // keys, so they can't be told apart from the new ones.
+  if (hadCacheKey) {
+    layoutCache.clear();
+  }
+  return js_double(env, matched);
+}
+
+NAPI_FUNCTION(Yoga_setLayoutCacheCapacity) {
+  napi_value arg;
+  size_t argc = 1;
+  napi_get_cb_info(env, cbinfo, &argc, &arg, NULL, NULL);
+  uint32_t capacity = 0;
+  napi_get_value_uint32(env, arg, &capacity);
+  layoutCache.setCapacity(capacity);
+  return NULL;
+}
+
+NAPI_FUNCTION(Yoga_clearLayoutCache) {
+  layoutCache.clear();
+  return NULL;
+}
+
+NAPI_FUNCTION(Yoga_getLayoutCacheStats) {
+  const LayoutCacheStats &stats = layoutCache.stats();
+  napi_value obj;
+  napi_create_object(env, &obj);
+  napi_set_named_property(env, obj, "hits", js_double(env, stats.hits));
+  napi_set_named_property(env, obj, "misses", js_double(env, stats.misses));
+  napi_set_named_property(env, obj, "size",
+                          js_double(env, layoutCache.size()));
+  napi_set_named_property(env, obj, "capacity",
+                          js_double(env, layoutCache.capacity()));
+  return obj;
+}
+
+NAPI_FUNCTION(Yoga_getMemoryStats) {
+  napi_value obj;
+  napi_create_object(env, &obj);
+  std::pair<const char *, int64_t> fields[] = {
+      {"liveNodes", memoryStats.liveNodes},
+      {"liveConfigs", memoryStats.liveConfigs},
+      {"freedNodes", memoryStats.freedNodes},
+      {"freedConfigs", memoryStats.freedConfigs},
+      {"leakedConfigs", memoryStats.leakedConfigs},
+      {"bytes", memoryStats.bytes},
+      {"peakBytes", memoryStats.peakBytes},
+      {"frozenNodes", (int64_t)frozenNodeCount},
+  };
+  for (auto const &[name, value] : fields) {
+    napi_set_named_property(env, obj, name, js_double(env, value));
+  }
+  return obj;
+}
+
+// Returns the calls made to every binding function since the last reset, most
+// expensive first. Only builds with YOGA_NODE_API_PROFILE keep a profile.
+NAPI_FUNCTION(Yoga_getCallProfile) {
+#ifdef YOGA_NODE_API_PROFILE
+  std::vector<std::pair<const char *, CallProfileEntry>> entries;
+  for (auto const &[name, entry] : callProfile) {
+    if (entry.calls > 0) {
+      entries.push_back({name, entry});
+    }
+  }
+  std::sort(entries.begin(), entries.end(), [](auto const &a, auto const &b) {
+    return a.second.nanoseconds > b.second.nanoseconds;
+  });
+
+  napi_value result;
+  napi_create_array_with_length(env, entries.size(), &result);
+  for (size_t i = 0; i < entries.size(); i++) {
+    auto const &[name, entry] = entries[i];
+    napi_value row, jsName;
+    napi_create_object(env, &row);
+    napi_create_string_utf8(env, name, NAPI_AUTO_LENGTH, &jsName);
+    napi_set_named_property(env, row, "name", jsName);
+    napi_set_named_property(env, row, "calls", js_double(env, entry.calls));
+    napi_set_named_property(env, row, "nanoseconds",
+                            js_double(env, entry.nanoseconds));
+    napi_set_named_property(env, row, "bytes", js_double(env, entry.bytes));
+    napi_set_element(env, result, i, row);
+  }
+  return result;
+#else
+  napi_throw_error(env, NULL,
+                   "Call profiling needs a build with YOGA_NODE_API_PROFILE");
+  return NULL;
+#endif
+}
+
+// Entries are zeroed rather than dropped, as calls in progress point to them.
+NAPI_FUNCTION(Yoga_resetCallProfile) {
+#ifdef YOGA_NODE_API_PROFILE
+  for (auto &[name, entry] : callProfile) {
+    entry = {};
+  }
+#endif
+  return NULL;
+}
+
+// Enables dirty tracing, optionally with JS stacks. Disabling it drops
+// whatever was recorded.
+NAPI_FUNCTION(Yoga_setDirtyTracingEnabled) {
+  napi_value argv[2];
+  size_t argc = 2;
+  napi_get_cb_info(env, cbinfo, &argc, argv, NULL, NULL);
+  bool enabled = false, captureStacks = false;
+  napi_get_value_bool(env, argv[0], &enabled);
+  if (argc > 1) {
+    napi_get_value_bool(env, argv[1], &captureStacks);
+  }
+  if (!enabled) {
+    clearDirtyTrace();
+  }
+  dirtyTracingEnabled = enabled;
+  dirtyTracingStacks = enabled && captureStacks;
+  global_env = env;
+  return NULL;
+}
+
+static napi_value tracedNodeToJS(napi_env env, uint32_t id,
+                                 uint64_t serial) {
+  YGNodeRef node =
+      id != 0 && !isRetired(id, serial) ? nodeRegistry.get(id) : NULL;
+  napi_value result = node != NULL ? nodeToJS(env, node) : NULL;
+  if (result == NULL) {
+    napi_get_undefined(env, &result);
+  }
+  return result;
+}
+
+static napi_value dirtyEventToJS(napi_env env, DirtyEvent const &event) {
+  // Binding functions are named `Node_<method>` or `YGFFI_<method>`.
+  const char *operation = event.operation != NULL ? event.operation : "";
+  if (const char *method = std::strchr(operation, '_')) {
+    operation = method + 1;
+  }
+  napi_value obj, name;
+  napi_create_object(env, &obj);
+  napi_set_named_property(env, obj, "node",
+                          tracedNodeToJS(env, event.node, event.serial));
+  napi_create_string_utf8(env, operation, NAPI_AUTO_LENGTH, &name);
+  napi_set_named_property(env, obj, "operation", name);
+  napi_set_named_property(env, obj, "dirtiedNodes",
+                          js_double(env, event.dirtiedNodes));
+  if (!event.stack.empty()) {
+    napi_value stack;
+    napi_create_string_utf8(env, event.stack.data(), event.stack.size(),
+                            &stack);
+    napi_set_named_property(env, obj, "stack", stack);
+  }
+  return obj;
+}
+
+// Returns the traces of the layouts run since the last call, oldest first.
+NAPI_FUNCTION(Yoga_takeDirtyTrace) {
+  napi_value result;
+  napi_create_array_with_length(env, layoutTraces.size(), &result);
+  for (size_t i = 0; i < layoutTraces.size(); i++) {
+    LayoutTrace const &trace = layoutTraces[i];
+    napi_value obj, events;
+    napi_create_object(env, &obj);
+    napi_set_named_property(env, obj, "root",
+                            tracedNodeToJS(env, trace.root, trace.serial));
+    napi_set_named_property(env, obj, "durationMs",
+                            js_double(env, trace.durationMs));
+    napi_create_array_with_length(env, trace.events.size(), &events);
+    for (size_t j = 0; j < trace.events.size(); j++) {
+      napi_set_element(env, events, j, dirtyEventToJS(env, trace.events[j]));
+    }
+    napi_set_named_property(env, obj, "events", events);
+    napi_set_element(env, result, i, obj);
+    tracedEventCount -= trace.events.size();
+  }
+  layoutTraces.clear();
+  // Pending events of freed nodes are dropped here too, after which
+  // retirements older than every pending event matter no more.
+  if (!retiredTracedNodes.empty()) {
+    tracedEventCount -= std::erase_if(dirtyEvents, [](DirtyEvent &event) {
+      return isRetired(event.node, event.serial);
+    });
+    uint64_t oldest =
+        dirtyEvents.empty() ? UINT64_MAX : dirtyEvents.front().serial;
+    std::erase_if(retiredTracedNodes, [oldest](auto const &retired) {
+      return retired.second <= oldest;
+    });
+    lastTracedNode = NULL;
+  }
+  return result;
+}
+
+// Starts recording binding calls, discarding any recording in progress.
+// Nodes and configs created before are unknown to the trace, so recording
+// should start before the trees it is meant to capture are built.
+NAPI_FUNCTION(Yoga_startRecording) {
+  callRecorder = std::make_unique<CallRecorder>();
+  napiCallHook = &recordCall;
+  ffiCallHook = &recordFFICall;
+  return NULL;
+}
+
+// Stops recording and returns the trace, or undefined if nothing was being
+// recorded.
+NAPI_FUNCTION(Yoga_stopRecording) {
+  if (callRecorder == NULL) {
+    return NULL;
+  }
+  std::vector<uint8_t> const &bytes = callRecorder->writer.data();
+  void *data;
+  napi_value result;
+  napi_create_arraybuffer(env, bytes.size(), &data, &result);
+  std::copy(bytes.begin(), bytes.end(), (uint8_t *)data);
+  callRecorder.reset();
+  napiCallHook = NULL;
+  ffiCallHook = NULL;
+  return result;
+}
+
+// } /* namespace Yoga */
+
 // Setup the classes then export
 
 extern "C" napi_value napi_register_module_v1(napi_env env,
@@ -922,6 +3272,10 @@ extern "C" napi_value napi_register_module_v1(napi_env env,
       NAPI_STATIC_METHOD(Node, createDefault),
       NAPI_STATIC_METHOD(Node, createWithConfig),
       NAPI_STATIC_METHOD(Node, destroy),
+      NAPI_STATIC_METHOD(Node, fromId),
+      NAPI_STATIC_METHOD(Node, deserialize),
+      NAPI_METHOD(Node, serialize),
+      NAPI_METHOD(Node, getId),
       NAPI_METHOD(Node, free),
       NAPI_METHOD(Node, freeRecursive),
       NAPI_METHOD(Node, reset),
@@ -993,6 +3347,9 @@ extern "C" napi_value napi_register_module_v1(napi_env env,
       NAPI_METHOD(Node, getGap),
       NAPI_METHOD(Node, insertChild),
       NAPI_METHOD(Node, removeChild),
+      NAPI_METHOD(Node, setChildren),
+      NAPI_METHOD(Node, insertChildren),
+      NAPI_METHOD(Node, removeAllChildren),
       NAPI_METHOD(Node, getChildCount),
       NAPI_METHOD(Node, getParent),
       NAPI_METHOD(Node, getChild),
@@ -1001,6 +3358,13 @@ extern "C" napi_value napi_register_module_v1(napi_env env,
       NAPI_METHOD(Node, setIsReferenceBaseline),
       NAPI_METHOD(Node, setMeasureFunc),
       NAPI_METHOD(Node, unsetMeasureFunc),
+      NAPI_METHOD(Node, setIntrinsicSize),
+      NAPI_METHOD(Node, setAspectMeasure),
+      NAPI_METHOD(Node, setClampMeasure),
+      NAPI_METHOD(Node, setMeasureCacheKey),
+      NAPI_METHOD(Node, setMeasureTag),
+      NAPI_METHOD(Node, setBulkMeasureFunc),
+      NAPI_METHOD(Node, unsetBulkMeasureFunc),
       NAPI_METHOD(Node, setDirtiedFunc),
       NAPI_METHOD(Node, unsetDirtiedFunc),
       NAPI_METHOD(Node, markDirty),
@@ -1008,6 +3372,24 @@ extern "C" napi_value napi_register_module_v1(napi_env env,
       NAPI_METHOD(Node, markLayoutSeen),
       NAPI_METHOD(Node, hasNewLayout),
       NAPI_METHOD(Node, calculateLayout),
+      NAPI_METHOD(Node, calculateLayoutSliced),
+      NAPI_METHOD(Node, queryRect),
+      NAPI_METHOD(Node, hitTest),
+      NAPI_METHOD(Node, exportTopology),
+      NAPI_METHOD(Node, exportLayout),
+      NAPI_METHOD(Node, setDamageTrackingEnabled),
+      NAPI_METHOD(Node, takeDamage),
+      NAPI_METHOD(Node, setContentSizeEnabled),
+      NAPI_METHOD(Node, getContentSize),
+      NAPI_METHOD(Node, setLayoutFrozen),
+      NAPI_METHOD(Node, isLayoutFrozen),
+      NAPI_METHOD(Node, setVirtualItemCount),
+      NAPI_METHOD(Node, setVirtualItemSize),
+      NAPI_METHOD(Node, setVirtualWindow),
+      NAPI_METHOD(Node, getVirtualRange),
+      NAPI_METHOD(Node, getVirtualContentSize),
+      NAPI_METHOD(Node, getVirtualItemOffset),
+      NAPI_METHOD(Node, unsetVirtualList),
       NAPI_METHOD(Node, getComputedLeft),
       NAPI_METHOD(Node, getComputedRight),
       NAPI_METHOD(Node, getComputedTop),
@@ -1018,17 +3400,48 @@ extern "C" napi_value napi_register_module_v1(napi_env env,
       NAPI_METHOD(Node, getComputedMargin),
       NAPI_METHOD(Node, getComputedBorder),
       NAPI_METHOD(Node, getComputedPadding),
+      NAPI_METHOD(Node, getIntrinsicSizes),
       NAPI_METHOD(Node, getDirection),
+      NAPI_METHOD(Node, snapshot),
+  };
+
+  DEFINE_CLASS(Node, 135);
+
+  // Versions read their frozen nodes with the Node methods.
+  napi_property_descriptor TreeVersion_props[] = {
+      NAPI_METHOD(TreeVersion, getComputedLayout),
+      {"exportTopology", NULL, Node_exportTopology, NULL, NULL, NULL,
+       napi_writable, NULL},
+      {"exportLayout", NULL, Node_exportLayout, NULL, NULL, NULL,
+       napi_writable, NULL},
+      {"serialize", NULL, Node_serialize, NULL, NULL, NULL, napi_writable,
+       NULL},
+      NAPI_METHOD(TreeVersion, free),
   };
 
-  DEFINE_CLASS(Node, 101);
+  DEFINE_CLASS(TreeVersion, 5);
+  napi_create_reference(env, TreeVersion, 1, &treeVersionConstructor);
 
   napi_property_descriptor exports_props[] = {
       NAPI_VALUE(Config),
       NAPI_VALUE(Node),
+      NAPI_METHOD(Yoga, setDirtiedQueueEnabled),
+      NAPI_METHOD(Yoga, drainDirtiedQueue),
+      NAPI_METHOD(Yoga, setLayoutCacheCapacity),
+      NAPI_METHOD(Yoga, clearLayoutCache),
+      NAPI_METHOD(Yoga, markDirtyByTag),
+      NAPI_METHOD(Yoga, getLayoutCacheStats),
+      NAPI_METHOD(Yoga, getMemoryStats),
+      NAPI_METHOD(Yoga, flushDeferredDirtied),
+      NAPI_METHOD(Yoga, setDirtyTracingEnabled),
+      NAPI_METHOD(Yoga, takeDirtyTrace),
+      NAPI_METHOD(Yoga, startRecording),
+      NAPI_METHOD(Yoga, stopRecording),
+      NAPI_METHOD(Yoga, getCallProfile),
+      NAPI_METHOD(Yoga, resetCallProfile),
   };
 
-  napi_define_properties(env, exports, 2, exports_props);
+  napi_define_properties(env, exports, 16, exports_props);
 
   return exports;
 }
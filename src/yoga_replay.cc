@@ -0,0 +1,902 @@
+#include "call_trace.h"
+#include "measure_preset.h"
+#include "snapshot.h"
+#include "yoga/YGConfig.h"
+#include "yoga/YGNode.h"
+#include "yoga/YGNodeLayout.h"
+#include "yoga/YGNodeStyle.h"
+#include "yoga/node/Node.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Replays a call trace recorded by `Yoga.startRecording` against Yoga alone,
+// without a JS engine, to profile and debug layouts outside the app.
+//
+// Calls are executed in trace order. Measure functions answer with the
+// results recorded for the same node and constraints; a request the recording
+// never saw is answered with the node's last recorded size and counted as a
+// divergence. Queries are not replayed, nor are binding features without a
+// Yoga counterpart, like the layout cache, virtual lists and dirtied
+// callbacks. With --print-layouts, the layouts of the first run are printed
+// for comparison with the recording.
+
+using facebook::yoga::resolveRef;
+
+namespace {
+
+const char *kUsage = "Usage: yoga_replay [options] <trace>\n"
+                     "\n"
+                     "  -n, --repeat <n>  replay the trace <n> times "
+                     "(default: 1)\n"
+                     "  -q, --quiet       don't print statistics\n"
+                     "  -l, --print-layouts\n"
+                     "                    print the subtree of every layout "
+                     "of the first run\n";
+
+struct Options {
+  unsigned repeat = 1;
+  bool quiet = false;
+  bool printLayouts = false;
+  const char *input = NULL;
+};
+
+struct Stats {
+  size_t replayed = 0;
+  size_t skipped = 0;
+  size_t divergences = 0;
+  double layoutSeconds = 0;
+};
+
+// Attached to every replayed node through its context pointer.
+struct ReplayNode {
+  uint32_t id;
+  YGSize lastSize = {0, 0};
+  MeasurePreset preset;
+  uint32_t measureTag = 0;
+};
+
+inline ReplayNode *replayNode(YGNodeConstRef node) {
+  return (ReplayNode *)YGNodeGetContext(node);
+}
+
+// Matches with the same tolerance Yoga uses for its measurement cache.
+inline bool sameConstraint(float a, uint8_t aMode, float b, uint8_t bMode) {
+  return aMode == bMode &&
+         (aMode == YGMeasureModeUndefined || std::fabs(a - b) < 0.0001f);
+}
+
+YGSize replayMeasure(YGNodeConstRef node, float width, YGMeasureMode widthMode,
+                     float height, YGMeasureMode heightMode);
+
+class Replayer {
+public:
+  Replayer(std::vector<std::string> const &names,
+           std::vector<TraceRecord> const &records, Stats &stats,
+           FILE *layouts)
+      : names_(names), records_(records), stats_(stats), layouts_(layouts) {}
+
+  ~Replayer() { reset(); }
+
+  void run();
+
+  YGNodeRef findNode(uint32_t id) const {
+    auto it = nodes_.find(id);
+    return it != nodes_.end() ? it->second : NULL;
+  }
+
+  YGConfigRef findConfig(uint32_t id) const {
+    auto it = configs_.find(id);
+    return it != configs_.end() ? it->second : NULL;
+  }
+
+  YGNodeRef createNode(uint32_t id, uint32_t configId) {
+    // The id is only taken if the recorded node was freed by a call that
+    // wasn't replayed.
+    if (YGNodeRef stale = findNode(id)) {
+      freeNode(stale);
+    }
+    YGConfigRef config = findConfig(configId);
+    YGNodeRef node = config != NULL ? YGNodeNewWithConfig(config) : YGNodeNew();
+    YGNodeSetContext(node, new ReplayNode{id});
+    nodes_[id] = node;
+    return node;
+  }
+
+  void freeNode(YGNodeRef node) {
+    forgetNode(node);
+    YGNodeFree(node);
+  }
+
+  void freeNodeRecursive(YGNodeRef root) {
+    std::vector<YGNodeRef> stack = {root};
+    while (!stack.empty()) {
+      YGNodeRef node = stack.back();
+      stack.pop_back();
+      for (size_t i = 0, count = YGNodeGetChildCount(node); i < count; i++) {
+        YGNodeRef child = YGNodeGetChild(node, i);
+        if (YGNodeGetOwner(child) == node) {
+          stack.push_back(child);
+        }
+      }
+      forgetNode(node);
+    }
+    YGNodeFreeRecursive(root);
+  }
+
+  void createConfig(uint32_t id) {
+    freeConfig(id);
+    configs_[id] = YGConfigNew();
+  }
+
+  void freeConfig(uint32_t id) {
+    auto it = configs_.find(id);
+    if (it != configs_.end()) {
+      YGConfigFree(it->second);
+      configs_.erase(it);
+    }
+  }
+
+  void calculateLayout(YGNodeRef node, float width, float height,
+                       YGDirection direction) {
+    auto start = std::chrono::steady_clock::now();
+    YGNodeCalculateLayout(node, width, height, direction);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    stats_.layoutSeconds += elapsed.count();
+    if (layouts_ != NULL) {
+      printLayout(node);
+    }
+  }
+
+  // Rebuilds a snapshot from the node creations following the call at
+  // `index`, and returns the index of the last one.
+  size_t deserialize(size_t index, TraceValue const &snapshot, bool &ok);
+
+  YGSize measure(YGNodeConstRef node, float width, YGMeasureMode widthMode,
+                 float height, YGMeasureMode heightMode);
+
+private:
+  void forgetNode(YGNodeRef node) {
+    ReplayNode *ctx = replayNode(node);
+    if (ctx == NULL) {
+      return;
+    }
+    nodes_.erase(ctx->id);
+    delete ctx;
+    YGNodeSetContext(node, NULL);
+  }
+
+  // Frees everything the trace left alive, so every run starts afresh.
+  void reset() {
+    for (auto &[id, node] : nodes_) {
+      delete replayNode(node);
+      YGNodeFree(node);
+    }
+    nodes_.clear();
+    for (auto &[id, config] : configs_) {
+      YGConfigFree(config);
+    }
+    configs_.clear();
+  }
+
+  size_t call(size_t index);
+
+  // Prints `layout <root id>` followed by `<id> <left> <top> <width>
+  // <height>` for every node of the subtree in preorder.
+  void printLayout(YGNodeRef root) {
+    std::fprintf(layouts_, "layout %u\n", replayNode(root)->id);
+    std::vector<YGNodeRef> stack = {root};
+    while (!stack.empty()) {
+      YGNodeRef node = stack.back();
+      stack.pop_back();
+      ReplayNode *ctx = replayNode(node);
+      std::fprintf(layouts_, "%u %g %g %g %g\n", ctx != NULL ? ctx->id : 0,
+                   YGNodeLayoutGetLeft(node), YGNodeLayoutGetTop(node),
+                   YGNodeLayoutGetWidth(node), YGNodeLayoutGetHeight(node));
+      for (size_t i = YGNodeGetChildCount(node); i > 0; i--) {
+        stack.push_back(YGNodeGetChild(node, i - 1));
+      }
+    }
+  }
+
+  std::vector<std::string> const &names_;
+  std::vector<TraceRecord> const &records_;
+  Stats &stats_;
+  FILE *layouts_;
+  std::unordered_map<uint32_t, YGNodeRef> nodes_;
+  std::unordered_map<uint32_t, YGConfigRef> configs_;
+  // Measure results recorded for the current call, by node id.
+  std::unordered_map<uint32_t, std::vector<TraceRecord const *>> answers_;
+};
+
+// The replay in progress, for the measure function.
+Replayer *currentReplayer = NULL;
+
+YGSize replayMeasure(YGNodeConstRef node, float width, YGMeasureMode widthMode,
+                     float height, YGMeasureMode heightMode) {
+  return currentReplayer->measure(node, width, widthMode, height, heightMode);
+}
+
+// Presets are answered natively, as in the binding.
+YGSize replayPresetMeasure(YGNodeConstRef node, float width,
+                           YGMeasureMode widthMode, float height,
+                           YGMeasureMode heightMode) {
+  return measureWithPreset(replayNode(node)->preset, width, widthMode, height,
+                           heightMode);
+}
+
+// Receiver and arguments of a recorded call, converted the way the binding
+// converts them.
+struct Call {
+  Replayer &replayer;
+  TraceRecord const &record;
+  // The last record belonging to the call.
+  size_t last;
+
+  TraceValue const &arg(size_t index) const {
+    static const TraceValue undefined;
+    return index < record.args.size() ? record.args[index] : undefined;
+  }
+
+  double number(size_t index) const {
+    TraceValue const &value = arg(index);
+    return value.type == TraceValue::Number ? value.number : 0;
+  }
+
+  // Optional numbers fall back when missing or NaN.
+  float numberOr(size_t index, float fallback) const {
+    TraceValue const &value = arg(index);
+    return value.type == TraceValue::Number && !std::isnan(value.number)
+               ? value.number
+               : fallback;
+  }
+
+  int32_t int32(size_t index) const {
+    // Wraps like a JS ToInt32.
+    double value = std::trunc(number(index));
+    return std::isfinite(value)
+               ? (int32_t)(uint32_t)(int64_t)std::fmod(value, 4294967296.0)
+               : 0;
+  }
+
+  bool flag(size_t index) const {
+    TraceValue const &value = arg(index);
+    return value.type == TraceValue::Bool && value.number != 0;
+  }
+
+  YGNodeRef node(TraceValue const &value) const {
+    return value.type == TraceValue::Node ? replayer.findNode(value.id) : NULL;
+  }
+
+  YGNodeRef self() const { return node(record.self); }
+  YGNodeRef node(size_t index) const { return node(arg(index)); }
+
+  YGConfigRef config(TraceValue const &value) const {
+    return value.type == TraceValue::Config ? replayer.findConfig(value.id)
+                                            : NULL;
+  }
+};
+
+// Handlers return false if the call can't be replayed, because a node or
+// config it refers to is unknown to the trace.
+using Handler = bool (*)(Call &call);
+
+template <void (*F)(YGNodeRef)> bool nodeAction(Call &call) {
+  YGNodeRef node = call.self();
+  if (node == NULL) {
+    return false;
+  }
+  F(node);
+  return true;
+}
+
+template <void (*F)(YGNodeRef, float)> bool nodeFloat(Call &call) {
+  YGNodeRef node = call.self();
+  if (node == NULL) {
+    return false;
+  }
+  F(node, call.number(0));
+  return true;
+}
+
+template <void (*F)(YGNodeRef, bool)> bool nodeFlag(Call &call) {
+  YGNodeRef node = call.self();
+  if (node == NULL) {
+    return false;
+  }
+  F(node, call.flag(0));
+  return true;
+}
+
+template <typename T, void (*F)(YGNodeRef, T)> bool nodeEnum(Call &call) {
+  YGNodeRef node = call.self();
+  if (node == NULL) {
+    return false;
+  }
+  F(node, static_cast<T>(call.int32(0)));
+  return true;
+}
+
+template <typename T, void (*F)(YGNodeRef, T, float)>
+bool nodeEdge(Call &call) {
+  YGNodeRef node = call.self();
+  if (node == NULL) {
+    return false;
+  }
+  F(node, static_cast<T>(call.int32(0)), call.number(1));
+  return true;
+}
+
+template <void (*F)(YGConfigRef, float)> bool configFloat(Call &call) {
+  YGConfigRef config = call.config(call.record.self);
+  if (config == NULL) {
+    return false;
+  }
+  F(config, call.number(0));
+  return true;
+}
+
+template <void (*F)(YGConfigRef, bool)> bool configFlag(Call &call) {
+  YGConfigRef config = call.config(call.record.self);
+  if (config == NULL) {
+    return false;
+  }
+  F(config, call.flag(0));
+  return true;
+}
+
+bool nodePreset(Call &call, MeasurePreset const &preset) {
+  YGNodeRef node = call.self();
+  if (node == NULL || !isValidMeasurePreset(preset) ||
+      YGNodeGetChildCount(node) > 0) {
+    return false;
+  }
+  replayNode(node)->preset = preset;
+  YGNodeSetMeasureFunc(node, &replayPresetMeasure);
+  resolveRef(node)->markDirtyAndPropagate();
+  return true;
+}
+
+// Nodes and configs are created from the records that follow these calls.
+bool createdFromRecords(Call &call) { return true; }
+
+bool collectChildren(Call &call, std::vector<YGNodeRef> &children) {
+  TraceValue const &array = call.arg(0);
+  if (array.type != TraceValue::Array) {
+    return false;
+  }
+  for (TraceValue const &element : array.elements) {
+    YGNodeRef child = call.node(element);
+    if (child == NULL) {
+      return false;
+    }
+    children.push_back(child);
+  }
+  return true;
+}
+
+std::unordered_map<std::string_view, Handler> const &handlers() {
+  static const std::unordered_map<std::string_view, Handler> table = {
+      {"Config_constructor", createdFromRecords},
+      {"Config_create", createdFromRecords},
+      {"Config_free",
+       [](Call &call) {
+         TraceValue const &self = call.record.self;
+         if (call.config(self) == NULL) {
+           return false;
+         }
+         call.replayer.freeConfig(self.id);
+         return true;
+       }},
+      {"Config_destroy",
+       [](Call &call) {
+         if (call.config(call.arg(0)) == NULL) {
+           return false;
+         }
+         call.replayer.freeConfig(call.arg(0).id);
+         return true;
+       }},
+      {"Config_setExperimentalFeatureEnabled",
+       [](Call &call) {
+         YGConfigRef config = call.config(call.record.self);
+         if (config == NULL) {
+           return false;
+         }
+         YGConfigSetExperimentalFeatureEnabled(
+             config, static_cast<YGExperimentalFeature>(call.int32(0)),
+             call.flag(1));
+         return true;
+       }},
+      {"Config_setPointScaleFactor", configFloat<YGConfigSetPointScaleFactor>},
+      {"Config_setErrata",
+       [](Call &call) {
+         YGConfigRef config = call.config(call.record.self);
+         if (config == NULL) {
+           return false;
+         }
+         YGConfigSetErrata(config, static_cast<YGErrata>(call.int32(0)));
+         return true;
+       }},
+      {"Config_setUseWebDefaults", configFlag<YGConfigSetUseWebDefaults>},
+
+      {"Node_constructor", createdFromRecords},
+      {"Node_createDefault", createdFromRecords},
+      {"Node_createWithConfig", createdFromRecords},
+      {"Node_free",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         call.replayer.freeNode(node);
+         return true;
+       }},
+      {"Node_destroy",
+       [](Call &call) {
+         YGNodeRef node = call.node(0);
+         if (node == NULL) {
+           return false;
+         }
+         call.replayer.freeNode(node);
+         return true;
+       }},
+      {"Node_freeRecursive",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         call.replayer.freeNodeRecursive(node);
+         return true;
+       }},
+      {"Node_reset",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         void *ctx = YGNodeGetContext(node);
+         YGNodeReset(node);
+         YGNodeSetContext(node, ctx);
+         return true;
+       }},
+      {"Node_copyStyle",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         YGNodeRef source = call.node(0);
+         if (node == NULL || source == NULL) {
+           return false;
+         }
+         YGNodeCopyStyle(node, source);
+         return true;
+       }},
+      {"Node_deserialize",
+       [](Call &call) {
+         bool ok = false;
+         call.last = call.replayer.deserialize(call.last, call.arg(0), ok);
+         return ok;
+       }},
+
+      {"Node_setPositionType",
+       nodeEnum<YGPositionType, YGNodeStyleSetPositionType>},
+      {"Node_setPosition", nodeEdge<YGEdge, YGNodeStyleSetPosition>},
+      {"Node_setPositionPercent",
+       nodeEdge<YGEdge, YGNodeStyleSetPositionPercent>},
+      {"Node_setAlignContent", nodeEnum<YGAlign, YGNodeStyleSetAlignContent>},
+      {"Node_setAlignItems", nodeEnum<YGAlign, YGNodeStyleSetAlignItems>},
+      {"Node_setAlignSelf", nodeEnum<YGAlign, YGNodeStyleSetAlignSelf>},
+      {"Node_setFlexDirection",
+       nodeEnum<YGFlexDirection, YGNodeStyleSetFlexDirection>},
+      {"Node_setFlexWrap", nodeEnum<YGWrap, YGNodeStyleSetFlexWrap>},
+      {"Node_setJustifyContent",
+       nodeEnum<YGJustify, YGNodeStyleSetJustifyContent>},
+      {"Node_setMargin", nodeEdge<YGEdge, YGNodeStyleSetMargin>},
+      {"Node_setMarginPercent", nodeEdge<YGEdge, YGNodeStyleSetMarginPercent>},
+      {"Node_setMarginAuto", nodeEnum<YGEdge, YGNodeStyleSetMarginAuto>},
+      {"Node_setOverflow", nodeEnum<YGOverflow, YGNodeStyleSetOverflow>},
+      {"Node_setDisplay", nodeEnum<YGDisplay, YGNodeStyleSetDisplay>},
+      {"Node_setFlex", nodeFloat<YGNodeStyleSetFlex>},
+      {"Node_setFlexBasis", nodeFloat<YGNodeStyleSetFlexBasis>},
+      {"Node_setFlexBasisPercent", nodeFloat<YGNodeStyleSetFlexBasisPercent>},
+      {"Node_setFlexBasisAuto", nodeAction<YGNodeStyleSetFlexBasisAuto>},
+      {"Node_setFlexGrow", nodeFloat<YGNodeStyleSetFlexGrow>},
+      {"Node_setFlexShrink", nodeFloat<YGNodeStyleSetFlexShrink>},
+      {"Node_setWidth", nodeFloat<YGNodeStyleSetWidth>},
+      {"Node_setWidthPercent", nodeFloat<YGNodeStyleSetWidthPercent>},
+      {"Node_setWidthAuto", nodeAction<YGNodeStyleSetWidthAuto>},
+      {"Node_setHeight", nodeFloat<YGNodeStyleSetHeight>},
+      {"Node_setHeightPercent", nodeFloat<YGNodeStyleSetHeightPercent>},
+      {"Node_setHeightAuto", nodeAction<YGNodeStyleSetHeightAuto>},
+      {"Node_setMinWidth", nodeFloat<YGNodeStyleSetMinWidth>},
+      {"Node_setMinWidthPercent", nodeFloat<YGNodeStyleSetMinWidthPercent>},
+      {"Node_setMinHeight", nodeFloat<YGNodeStyleSetMinHeight>},
+      {"Node_setMinHeightPercent", nodeFloat<YGNodeStyleSetMinHeightPercent>},
+      {"Node_setMaxWidth", nodeFloat<YGNodeStyleSetMaxWidth>},
+      {"Node_setMaxWidthPercent", nodeFloat<YGNodeStyleSetMaxWidthPercent>},
+      {"Node_setMaxHeight", nodeFloat<YGNodeStyleSetMaxHeight>},
+      {"Node_setMaxHeightPercent", nodeFloat<YGNodeStyleSetMaxHeightPercent>},
+      {"Node_setAspectRatio", nodeFloat<YGNodeStyleSetAspectRatio>},
+      {"Node_setBorder", nodeEdge<YGEdge, YGNodeStyleSetBorder>},
+      {"Node_setPadding", nodeEdge<YGEdge, YGNodeStyleSetPadding>},
+      {"Node_setPaddingPercent",
+       nodeEdge<YGEdge, YGNodeStyleSetPaddingPercent>},
+      {"Node_setGap", nodeEdge<YGGutter, YGNodeStyleSetGap>},
+      {"Node_setGapPercent", nodeEdge<YGGutter, YGNodeStyleSetGapPercent>},
+      {"Node_setDirection", nodeEnum<YGDirection, YGNodeStyleSetDirection>},
+      {"Node_setAlwaysFormsContainingBlock",
+       nodeFlag<YGNodeSetAlwaysFormsContainingBlock>},
+      {"Node_setIsReferenceBaseline", nodeFlag<YGNodeSetIsReferenceBaseline>},
+
+      {"Node_insertChild",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         YGNodeRef child = call.node(0);
+         if (node == NULL || child == NULL) {
+           return false;
+         }
+         YGNodeInsertChild(node, child, call.int32(1));
+         return true;
+       }},
+      {"Node_removeChild",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         YGNodeRef child = call.node(0);
+         if (node == NULL || child == NULL) {
+           return false;
+         }
+         YGNodeRemoveChild(node, child);
+         return true;
+       }},
+      {"Node_setChildren",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         std::vector<YGNodeRef> children;
+         if (node == NULL || !collectChildren(call, children)) {
+           return false;
+         }
+         YGNodeSetChildren(node, children.data(), children.size());
+         return true;
+       }},
+      {"Node_insertChildren",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         std::vector<YGNodeRef> children;
+         if (node == NULL || !collectChildren(call, children)) {
+           return false;
+         }
+         size_t at = std::min<size_t>(std::max(call.int32(1), 0),
+                                      YGNodeGetChildCount(node));
+         for (YGNodeRef child : children) {
+           YGNodeInsertChild(node, child, at++);
+         }
+         return true;
+       }},
+      {"Node_removeAllChildren", nodeAction<YGNodeRemoveAllChildren>},
+
+      {"Node_setMeasureFunc",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         YGNodeSetMeasureFunc(node, &replayMeasure);
+         return true;
+       }},
+      {"Node_unsetMeasureFunc",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         YGNodeSetMeasureFunc(node, NULL);
+         return true;
+       }},
+      {"Node_setIntrinsicSize",
+       [](Call &call) {
+         return nodePreset(call, {MeasurePreset::IntrinsicSize,
+                                  {(float)call.number(0),
+                                   (float)call.number(1)}});
+       }},
+      {"Node_setAspectMeasure",
+       [](Call &call) {
+         return nodePreset(call, {MeasurePreset::AspectRatio,
+                                  {(float)call.number(0),
+                                   call.numberOr(1, 0),
+                                   call.numberOr(2, INFINITY)}});
+       }},
+      {"Node_setClampMeasure",
+       [](Call &call) {
+         return nodePreset(call, {MeasurePreset::Clamp,
+                                  {call.numberOr(0, 0), call.numberOr(1, 0),
+                                   call.numberOr(2, INFINITY),
+                                   call.numberOr(3, INFINITY)}});
+       }},
+      {"Node_setMeasureCacheKey",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         TraceValue::Type type = call.arg(0).type;
+         if (node == NULL ||
+             (type != TraceValue::String && type != TraceValue::Undefined &&
+              type != TraceValue::Null)) {
+           return false;
+         }
+         resolveRef(node)->markDirtyAndPropagate();
+         return true;
+       }},
+      {"Node_markDirty", nodeAction<YGNodeMarkDirty>},
+      {"Node_setMeasureTag",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         replayNode(node)->measureTag = (uint32_t)call.int32(0);
+         return true;
+       }},
+      {"Yoga_markDirtyByTag",
+       [](Call &call) {
+         YGNodeRef root = call.node(0);
+         if (root == NULL) {
+           return false;
+         }
+         uint32_t tag = (uint32_t)call.int32(1);
+         std::vector<YGNodeRef> stack = {root};
+         while (!stack.empty() && tag != 0) {
+           YGNodeRef node = stack.back();
+           stack.pop_back();
+           ReplayNode *ctx = replayNode(node);
+           if (ctx != NULL && ctx->measureTag == tag &&
+               YGNodeHasMeasureFunc(node)) {
+             resolveRef(node)->markDirtyAndPropagate();
+           }
+           for (size_t i = 0, count = YGNodeGetChildCount(node); i < count;
+                i++) {
+             stack.push_back(YGNodeGetChild(node, i));
+           }
+         }
+         return true;
+       }},
+      {"Node_markLayoutSeen",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         YGNodeSetHasNewLayout(node, false);
+         return true;
+       }},
+      // A sliced layout ends in the same layout, so it is replayed in one go.
+      {"Node_calculateLayout",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         call.replayer.calculateLayout(
+             node, call.number(0), call.number(1),
+             static_cast<YGDirection>(call.int32(2)));
+         return true;
+       }},
+      {"Node_calculateLayoutSliced",
+       [](Call &call) {
+         YGNodeRef node = call.self();
+         if (node == NULL) {
+           return false;
+         }
+         call.replayer.calculateLayout(
+             node, call.number(0), call.number(1),
+             static_cast<YGDirection>(call.int32(2)));
+         return true;
+       }},
+  };
+  return table;
+}
+
+void Replayer::run() {
+  currentReplayer = this;
+  for (size_t i = 0; i < records_.size(); i++) {
+    TraceRecord const &record = records_[i];
+    switch (record.kind) {
+    case TraceRecordKind::ConfigCreated:
+      createConfig(record.id);
+      break;
+    case TraceRecordKind::NodeCreated:
+      createNode(record.id, record.configId);
+      break;
+    case TraceRecordKind::Call:
+      i = call(i);
+      break;
+    default:
+      break;
+    }
+  }
+  reset();
+  currentReplayer = NULL;
+}
+
+// Executes the call at `index` and returns the index of its last record.
+size_t Replayer::call(size_t index) {
+  answers_.clear();
+  for (size_t i = index + 1;
+       i < records_.size() && records_[i].kind != TraceRecordKind::Call; i++) {
+    if (records_[i].kind == TraceRecordKind::Measure) {
+      answers_[records_[i].id].push_back(&records_[i]);
+    }
+  }
+
+  TraceRecord const &record = records_[index];
+  Call call = {*this, record, index};
+  auto const &table = handlers();
+  auto it = table.find(names_[record.name]);
+  if (it != table.end() && it->second(call)) {
+    stats_.replayed++;
+  } else {
+    stats_.skipped++;
+  }
+  return call.last;
+}
+
+size_t Replayer::deserialize(size_t index, TraceValue const &snapshot,
+                             bool &ok) {
+  std::vector<TraceRecord const *> created;
+  while (index + 1 < records_.size() &&
+         records_[index + 1].kind == TraceRecordKind::NodeCreated) {
+    created.push_back(&records_[++index]);
+  }
+  if (snapshot.type != TraceValue::Buffer) {
+    return index;
+  }
+
+  size_t used = 0;
+  std::vector<YGNodeRef> nodes;
+  ok = deserializeTree(
+      (const uint8_t *)snapshot.bytes.data(), snapshot.bytes.size(),
+      [&]() {
+        if (used == created.size()) {
+          return YGNodeNew();
+        }
+        TraceRecord const *record = created[used++];
+        return createNode(record->id, record->configId);
+      },
+      [](YGNodeRef node, MeasurePreset const &preset) {
+        if (ReplayNode *replayed = replayNode(node)) {
+          replayed->preset = preset;
+          YGNodeSetMeasureFunc(node, &replayPresetMeasure);
+        }
+      },
+      nodes);
+  if (!ok) {
+    // The binding threw and freed the nodes it had restored.
+    for (YGNodeRef node : nodes) {
+      if (replayNode(node) != NULL) {
+        forgetNode(node);
+      }
+      YGNodeFinalize(node);
+    }
+  }
+  return index;
+}
+
+YGSize Replayer::measure(YGNodeConstRef node, float width,
+                         YGMeasureMode widthMode, float height,
+                         YGMeasureMode heightMode) {
+  ReplayNode *ctx = replayNode(node);
+  auto it = answers_.find(ctx->id);
+  if (it != answers_.end()) {
+    std::vector<TraceRecord const *> &answers = it->second;
+    for (auto answer = answers.begin(); answer != answers.end(); ++answer) {
+      TraceRecord const &record = **answer;
+      if (sameConstraint(width, widthMode, record.availableWidth,
+                         record.widthMode) &&
+          sameConstraint(height, heightMode, record.availableHeight,
+                         record.heightMode)) {
+        ctx->lastSize = {record.width, record.height};
+        answers.erase(answer);
+        return ctx->lastSize;
+      }
+    }
+  }
+  stats_.divergences++;
+  return ctx->lastSize;
+}
+
+bool parseOptions(int argc, char **argv, Options &options) {
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "-h" || arg == "--help") {
+      std::fputs(kUsage, stdout);
+      std::exit(0);
+    } else if (arg == "-n" || arg == "--repeat") {
+      char *end = NULL;
+      const char *value = i + 1 < argc ? argv[++i] : "";
+      options.repeat = std::strtoul(value, &end, 10);
+      if (*value == '\0' || *end != '\0' || options.repeat == 0) {
+        std::fprintf(stderr, "yoga_replay: invalid value for %s\n",
+                     arg.c_str());
+        return false;
+      }
+    } else if (arg == "-q" || arg == "--quiet") {
+      options.quiet = true;
+    } else if (arg == "-l" || arg == "--print-layouts") {
+      options.printLayouts = true;
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      std::fprintf(stderr, "yoga_replay: unknown option %s\n\n%s", arg.c_str(),
+                   kUsage);
+      return false;
+    } else if (options.input == NULL) {
+      options.input = argv[i];
+    } else {
+      std::fprintf(stderr, "yoga_replay: only one trace can be replayed\n");
+      return false;
+    }
+  }
+  if (options.input == NULL) {
+    std::fputs(kUsage, stderr);
+    return false;
+  }
+  return true;
+}
+
+bool readFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *file = std::strcmp(path, "-") == 0 ? stdin : std::fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  uint8_t buffer[1 << 16];
+  size_t read;
+  while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + read);
+  }
+  bool ok = !std::ferror(file);
+  if (file != stdin) {
+    std::fclose(file);
+  }
+  return ok;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (!parseOptions(argc, argv, options)) {
+    return 2;
+  }
+
+  std::vector<uint8_t> data;
+  if (!readFile(options.input, data)) {
+    std::fprintf(stderr, "yoga_replay: can't read %s\n", options.input);
+    return 2;
+  }
+  std::vector<std::string> names;
+  std::vector<TraceRecord> records;
+  if (!readCallTrace(data.data(), data.size(), names, records)) {
+    std::fprintf(stderr, "yoga_replay: invalid or unsupported call trace\n");
+    return 1;
+  }
+
+  Stats stats;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i < options.repeat; i++) {
+    FILE *layouts = options.printLayouts && i == 0 ? stdout : NULL;
+    Replayer(names, records, stats, layouts).run();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  if (!options.quiet) {
+    std::fprintf(stderr,
+                 "yoga_replay: %zu calls replayed, %zu skipped in %.3fs "
+                 "(%.3fs laying out) over %u runs, %zu measure divergences\n",
+                 stats.replayed, stats.skipped, elapsed.count(),
+                 stats.layoutSeconds, options.repeat, stats.divergences);
+  }
+  return 0;
+}
@@ -9,8 +9,36 @@ import { getMeasureCounter } from "../tools/MeasureCounter.ts";
 import { YGBENCHMARK } from "../tools/globals.ts";
 
 import Yoga from "yoga-layout";
+import { backends } from "../../src/yoga_ffi.ts";
 
 const ITERATIONS = 2000;
+const TEARDOWN_NODES = 100000;
+const LIST_ITEMS = 10000;
+
+function buildFeed() {
+  const root = Yoga.Node.create();
+  root.setWidth(400);
+
+  const iterations = Math.pow(ITERATIONS, 1 / 2);
+
+  for (let i = 0; i < iterations; i++) {
+    const card = Yoga.Node.create();
+    card.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+    card.setPadding(Yoga.EDGE_ALL, 8);
+    card.setMargin(Yoga.EDGE_BOTTOM, 4);
+    root.insertChild(card, i);
+
+    for (let ii = 0; ii < iterations; ii++) {
+      const cell = Yoga.Node.create();
+      cell.setFlexGrow(1);
+      cell.setHeight(20);
+      cell.setMargin(Yoga.EDGE_RIGHT, 2);
+      card.insertChild(cell, ii);
+    }
+  }
+
+  return root;
+}
 
 YGBENCHMARK("Stack with flex", () => {
   const root = Yoga.Node.create();
@@ -112,3 +140,171 @@ YGBENCHMARK("Huge nested layout", () => {
   root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
   root.freeRecursive();
 });
+
+YGBENCHMARK("Free wide tree", () => {
+  const root = Yoga.Node.create();
+
+  for (let i = 0; i < TEARDOWN_NODES; i++) {
+    root.insertChild(Yoga.Node.create(), i);
+  }
+
+  root.freeRecursive();
+});
+
+YGBENCHMARK("Free deep tree", () => {
+  const root = Yoga.Node.create();
+
+  let parent = root;
+  for (let i = 0; i < TEARDOWN_NODES; i++) {
+    const child = Yoga.Node.create();
+    parent.insertChild(child, 0);
+    parent = child;
+  }
+
+  root.freeRecursive();
+});
+
+YGBENCHMARK("Reorder list with setChildren", () => {
+  const root = Yoga.Node.create();
+
+  const children = [];
+  for (let i = 0; i < LIST_ITEMS; i++) {
+    const child = Yoga.Node.create();
+    child.setHeight(20);
+    children.push(child);
+  }
+
+  root.setChildren(children);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  root.setChildren(children.reverse());
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  root.freeRecursive();
+});
+
+YGBENCHMARK("Build and layout feed", () => {
+  const root = buildFeed();
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  root.freeRecursive();
+});
+
+// Fixtures are built on first use inside the benchmarks, so that a backend
+// without snapshots reports those benchmarks as unsupported.
+let feedSnapshot: ArrayBuffer | undefined;
+
+function getFeedSnapshot() {
+  if (feedSnapshot === undefined) {
+    const root = buildFeed();
+    root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    try {
+      feedSnapshot = root.serialize();
+    } finally {
+      root.freeRecursive();
+    }
+  }
+  return feedSnapshot;
+}
+
+YGBENCHMARK("Deserialize feed snapshot", () => {
+  const root = Yoga.Node.deserialize(getFeedSnapshot());
+  root.getComputedLayout();
+  root.freeRecursive();
+});
+
+YGBENCHMARK("Layout identical feeds with layout cache", () => {
+  Yoga.setLayoutCacheCapacity(1);
+  const first = buildFeed();
+  const second = buildFeed();
+  first.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  first.freeRecursive();
+  second.freeRecursive();
+  Yoga.setLayoutCacheCapacity(0);
+});
+
+YGBENCHMARK("Scroll virtual list", () => {
+  const list = Yoga.Node.create();
+  list.setHeight(800);
+  list.setVirtualItemCount(TEARDOWN_NODES, 40);
+
+  const rows = [];
+  for (let offset = 0; offset < 100 * 800; offset += 800) {
+    list.setVirtualWindow(offset, 800, 4);
+    const { start, end } = list.getVirtualRange();
+    while (rows.length < end - start) {
+      const row = Yoga.Node.create();
+      row.setHeight(36);
+      rows.push(row);
+    }
+    list.setChildren(rows.slice(0, end - start));
+    list.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  }
+
+  list.removeAllChildren();
+  list.free();
+  for (const row of rows) {
+    row.free();
+  }
+});
+
+// Restores and lays out its own feed, as the body may run after this module
+// finished loading, e.g. as a Deno test.
+YGBENCHMARK("Restore unrounded feed and export it at three scales", () => {
+  const config = Yoga.Config.create();
+  config.setPointScaleFactor(0);
+  try {
+    const root = Yoga.Node.deserialize(getFeedSnapshot(), config);
+    root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    for (const scale of [1, 2, 3]) {
+      root.exportLayout(scale, true);
+    }
+    root.freeRecursive();
+  } finally {
+    config.free();
+  }
+});
+
+// N-API and FFI side by side, only when mod.ts installed the FFI backend.
+for (const [backend, methods] of Object.entries(backends)) {
+  if (methods === undefined || backends.ffi === undefined) {
+    continue;
+  }
+
+  YGBENCHMARK(`Set styles (${backend})`, () => {
+    const node = Yoga.Node.create();
+    for (let i = 0; i < LIST_ITEMS; i++) {
+      methods.setWidth.call(node, i);
+      methods.setMargin.call(node, Yoga.EDGE_LEFT, i);
+      methods.setFlexDirection.call(node, i % 4);
+    }
+    node.free();
+  });
+
+  YGBENCHMARK(`Read computed values (${backend})`, () => {
+    const node = Yoga.Node.create();
+    node.setWidth(100);
+    node.setHeight(100);
+    node.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    let sum = 0;
+    for (let i = 0; i < LIST_ITEMS; i++) {
+      sum += methods.getComputedWidth.call(node);
+      sum += methods.getComputedTop.call(node);
+    }
+    node.free();
+    return sum;
+  });
+
+  YGBENCHMARK(`Read back feed layout (${backend})`, () => {
+    const root = buildFeed();
+    root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    const stack = [root];
+    while (stack.length > 0) {
+      const node = stack.pop()!;
+      methods.getComputedLayout.call(node);
+      for (let i = 0; i < node.getChildCount(); i++) {
+        stack.push(node.getChild(i));
+      }
+    }
+    root.freeRecursive();
+  });
+}
@@ -0,0 +1,184 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+const BATCH = new URL("../build/yoga_batch", import.meta.url).pathname;
+
+type Frame = { document: number; nodes: number[][] };
+
+async function runBatch(input: Uint8Array, args: string[] = []) {
+  const process = new Deno.Command(BATCH, {
+    args: ["--quiet", ...args],
+    stdin: "piped",
+    stdout: "piped",
+    stderr: "piped",
+  }).spawn();
+  const writer = process.stdin.getWriter();
+  await writer.write(input);
+  await writer.close();
+  const { code, stdout, stderr } = await process.output();
+
+  const view = new DataView(stdout.buffer);
+  expect(new TextDecoder().decode(stdout.subarray(0, 4))).toBe("YGFR");
+  expect(view.getUint16(4, true)).toBe(1);
+  const frames: Frame[] = [];
+  for (let offset = 8; offset < stdout.length;) {
+    const document = view.getUint32(offset, true);
+    const count = view.getUint32(offset + 4, true);
+    offset += 8;
+    const nodes = [];
+    for (let i = 0; i < count; i++, offset += 16) {
+      nodes.push([0, 4, 8, 12].map((o) => view.getFloat32(offset + o, true)));
+    }
+    frames.push({ document, nodes });
+  }
+  return { code, frames, stderr: new TextDecoder().decode(stderr) };
+}
+
+function createTree(children: number) {
+  const root = Yoga.Node.create();
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setPadding(Yoga.EDGE_ALL, 5);
+  for (let i = 0; i < children; i++) {
+    const child = Yoga.Node.create();
+    child.setFlexGrow(i + 1);
+    child.setHeight(20);
+    root.insertChild(child, i);
+  }
+  return root;
+}
+
+function expectedFrame(root: ReturnType<typeof Yoga.Node.create>) {
+  const nodes = [];
+  const stack = [root];
+  while (stack.length > 0) {
+    const node = stack.pop()!;
+    const layout = node.getComputedLayout();
+    nodes.push([layout.left, layout.top, layout.width, layout.height]);
+    for (let i = node.getChildCount() - 1; i >= 0; i--) {
+      stack.push(node.getChild(i));
+    }
+  }
+  return nodes;
+}
+
+Deno.test("batch_layout_matches_binding_for_snapshot_stream", async () => {
+  const trees = [createTree(2), createTree(3)];
+  const parts = [];
+  for (const tree of trees) {
+    const snapshot = new Uint8Array(tree.serialize());
+    const prefix = new Uint8Array(4);
+    new DataView(prefix.buffer).setUint32(0, snapshot.length, true);
+    parts.push(prefix, snapshot);
+  }
+  const input = new Uint8Array(parts.reduce((n, part) => n + part.length, 0));
+  let offset = 0;
+  for (const part of parts) {
+    input.set(part, offset);
+    offset += part.length;
+  }
+
+  const { code, frames } = await runBatch(input, [
+    "--width",
+    "300",
+    "--threads",
+    "2",
+  ]);
+  expect(code).toBe(0);
+  expect(frames.map((frame) => frame.document)).toEqual([0, 1]);
+  for (let i = 0; i < trees.length; i++) {
+    trees[i].calculateLayout(300, undefined, Yoga.DIRECTION_LTR);
+    expect(frames[i].nodes).toEqual(expectedFrame(trees[i]));
+    trees[i].freeRecursive();
+  }
+});
+
+Deno.test("batch_layout_measures_snapshot_presets", async () => {
+  const root = createTree(1);
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  const icon = Yoga.Node.create();
+  icon.setIntrinsicSize(24, 16);
+  root.insertChild(icon, 1);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const snapshot = new Uint8Array(root.serialize());
+  const input = new Uint8Array(4 + snapshot.length);
+  new DataView(input.buffer).setUint32(0, snapshot.length, true);
+  input.set(snapshot, 4);
+
+  const { code, frames } = await runBatch(input, ["--width", "300"]);
+  expect(code).toBe(0);
+  root.calculateLayout(300, undefined, Yoga.DIRECTION_LTR);
+  expect(frames[0].nodes).toEqual(expectedFrame(root));
+  expect(frames[0].nodes[2]).toEqual([
+    icon.getComputedLeft(),
+    icon.getComputedTop(),
+    24,
+    16,
+  ]);
+  root.freeRecursive();
+});
+
+Deno.test("batch_layout_reads_ndjson_and_reports_errors", async () => {
+  const lines = [
+    JSON.stringify({
+      width: 100,
+      flexDirection: "row",
+      padding: { horizontal: 10 },
+      children: [{ flexGrow: 1, height: 10 }, { width: "50%", height: 20 }],
+    }),
+    "",
+    '{"width": "wide"}',
+    JSON.stringify({ height: 50, gap: { row: 5 }, children: [{}, {}] }),
+  ];
+  const input = new TextEncoder().encode(lines.join("\n"));
+
+  const { code, frames, stderr } = await runBatch(input);
+  expect(code).toBe(1);
+  expect(stderr).toContain('document 1: invalid length for "width"');
+  expect(frames).toEqual([
+    {
+      document: 0,
+      nodes: [[0, 0, 100, 20], [10, 0, 40, 10], [50, 0, 40, 20]],
+    },
+    { document: 1, nodes: [] },
+    {
+      document: 2,
+      nodes: [[0, 0, 0, 50], [0, 0, 0, 0], [0, 5, 0, 0]],
+    },
+  ]);
+});
+
+Deno.test("batch_layout_measures_presets", async () => {
+  const lines = [
+    JSON.stringify({
+      width: 200,
+      alignItems: "flex-start",
+      children: [
+        { intrinsicSize: [40, 30] },
+        { aspectMeasure: [2, 0, 100] },
+        { clampMeasure: [0, 20, 120, 50] },
+      ],
+    }),
+    JSON.stringify({ intrinsicSize: [10, 10], children: [{}] }),
+  ];
+  const input = new TextEncoder().encode(lines.join("\n"));
+
+  const { code, frames, stderr } = await runBatch(input);
+  expect(code).toBe(1);
+  expect(stderr).toContain(
+    "document 1: nodes with children cannot be measured",
+  );
+  expect(frames[0].nodes).toEqual([
+    [0, 0, 200, 130],
+    [0, 0, 40, 30],
+    [0, 30, 100, 50],
+    [0, 80, 120, 50],
+  ]);
+  expect(frames[1].nodes).toEqual([]);
+});
@@ -0,0 +1,87 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+import { getMeasureCounter } from "./tools/MeasureCounter.ts";
+
+Deno.test("bulk_measure_answers_predicted_requests", () => {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+
+  const counters = [];
+  for (let i = 0; i < 3; i++) {
+    const counter = getMeasureCounter(null, 100, 10);
+    const child = Yoga.Node.create();
+    child.setMeasureFunc(counter.inc);
+    root.insertChild(child, i);
+    counters.push(counter);
+  }
+
+  let batches = 0;
+  root.setBulkMeasureFunc(
+    (ids, widths, widthModes, _heights, _heightModes, results) => {
+      batches++;
+      expect(ids.length).toBe(3);
+      for (let i = 0; i < ids.length; i++) {
+        expect(widths[i]).toBe(100);
+        expect(widthModes[i]).toBe(Yoga.MEASURE_MODE_EXACTLY);
+        results[2 * i] = widths[i];
+        results[2 * i + 1] = 20;
+      }
+    },
+  );
+
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(batches).toBe(1);
+  expect(counters.map((counter) => counter.get())).toEqual([0, 0, 0]);
+  expect(root.getComputedHeight()).toBe(60);
+  expect(root.getChild(2).getComputedTop()).toBe(40);
+
+  root.freeRecursive();
+});
+
+Deno.test("bulk_measure_falls_back_to_measure_func", () => {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+
+  const counter = getMeasureCounter(null, 50, 10);
+  const child = Yoga.Node.create();
+  child.setMeasureFunc(counter.inc);
+  root.insertChild(child, 0);
+
+  // Leaving results at NaN means "not answered".
+  root.setBulkMeasureFunc(() => {});
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(counter.get()).toBe(1);
+  expect(root.getComputedHeight()).toBe(10);
+
+  root.freeRecursive();
+});
+
+Deno.test("bulk_measure_skips_clean_leaves", () => {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+
+  const [a, b] = [Yoga.Node.create(), Yoga.Node.create()];
+  a.setMeasureFunc(() => ({ width: 100, height: 10 }));
+  b.setMeasureFunc(() => ({ width: 100, height: 10 }));
+  root.insertChild(a, 0);
+  root.insertChild(b, 1);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  const requested: number[] = [];
+  root.setBulkMeasureFunc((ids) => requested.push(...ids));
+  b.markDirty();
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(requested).toEqual([b.getId()]);
+
+  root.freeRecursive();
+});
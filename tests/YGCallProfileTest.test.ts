@@ -0,0 +1,74 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+import { backends } from "../src/yoga_ffi.ts";
+
+function profilingBuilt() {
+  try {
+    Yoga.getCallProfile();
+    return true;
+  } catch (error) {
+    expect((error as Error).message).toContain("YOGA_NODE_API_PROFILE");
+    return false;
+  }
+}
+
+Deno.test("call_profile_counts_binding_calls", () => {
+  if (!profilingBuilt()) {
+    return;
+  }
+  Yoga.resetCallProfile();
+  const root = Yoga.Node.create();
+  for (let i = 0; i < 10; i++) {
+    root.setWidth(100 + i);
+  }
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  root.exportLayout();
+
+  const profile = Yoga.getCallProfile();
+  const byName = new Map(profile.map((entry) => [entry.name, entry]));
+  // Setters installed by the FFI backend are profiled under their export.
+  const setWidth = backends.ffi?.setWidth ? "YGFFI_setWidth" : "Node_setWidth";
+  expect(byName.get(setWidth)?.calls).toBe(10);
+  expect(byName.get("Node_calculateLayout")?.calls).toBe(1);
+  expect(byName.get("Node_exportLayout")?.bytes).toBeGreaterThan(0);
+  for (let i = 1; i < profile.length; i++) {
+    expect(profile[i - 1].nanoseconds).toBeGreaterThanOrEqual(
+      profile[i].nanoseconds,
+    );
+  }
+
+  Yoga.resetCallProfile();
+  expect(Yoga.getCallProfile()).toEqual([]);
+  root.free();
+});
+
+Deno.test("call_profile_counts_creation", () => {
+  if (!profilingBuilt()) {
+    return;
+  }
+  Yoga.resetCallProfile();
+  const config = Yoga.Config.create();
+  const root = Yoga.Node.create(config);
+  const child = Yoga.Node.createDefault();
+  expect(Yoga.Node.fromId(root.getId())).toBe(root);
+
+  const profile = Yoga.getCallProfile();
+  const byName = new Map(profile.map((entry) => [entry.name, entry]));
+  expect(byName.get("Config_create")?.calls).toBe(1);
+  expect(byName.get("Config_constructor")?.calls).toBe(1);
+  expect(byName.get("Node_createWithConfig")?.calls).toBe(1);
+  expect(byName.get("Node_createDefault")?.calls).toBe(1);
+  expect(byName.get("Node_constructor")?.calls).toBe(2);
+  expect(byName.get("Node_fromId")?.calls).toBe(1);
+
+  child.free();
+  root.free();
+  config.free();
+});
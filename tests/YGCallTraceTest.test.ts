@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+type Node = ReturnType<typeof Yoga.Node.create>;
+
+const REPLAY = new URL("../build/yoga_replay", import.meta.url).pathname;
+
+async function replay(trace: ArrayBuffer) {
+  const path = await Deno.makeTempFile({ suffix: ".ygtr" });
+  try {
+    await Deno.writeFile(path, new Uint8Array(trace));
+    const { code, stdout, stderr } = await new Deno.Command(REPLAY, {
+      args: ["--repeat", "2", "--print-layouts", path],
+      stdout: "piped",
+      stderr: "piped",
+    }).output();
+    return {
+      code,
+      stdout: new TextDecoder().decode(stdout),
+      stderr: new TextDecoder().decode(stderr),
+    };
+  } finally {
+    await Deno.remove(path);
+  }
+}
+
+// The layout of a subtree the way `yoga_replay --print-layouts` prints it.
+function printLayout(root: Node) {
+  let text = `layout ${root.getId()}\n`;
+  const visit = (node: Node) => {
+    const { left, top, width, height } = node.getComputedLayout();
+    text += `${node.getId()} ${left} ${top} ${width} ${height}\n`;
+    for (let i = 0; i < node.getChildCount(); i++) {
+      visit(node.getChild(i));
+    }
+  };
+  visit(root);
+  return text;
+}
+
+Deno.test("stop_recording_without_recording", () => {
+  expect(Yoga.stopRecording()).toBe(undefined);
+});
+
+Deno.test("recorded_trace_replays_natively", async () => {
+  Yoga.startRecording();
+  const config = Yoga.Config.create();
+  config.setPointScaleFactor(2);
+  const root = Yoga.Node.create(config);
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setWidth(200);
+  const text = Yoga.Node.create(config);
+  text.setMeasureFunc(() => ({ width: 50, height: 16 }));
+  const box = Yoga.Node.create(config);
+  box.setWidth("25%");
+  box.setHeight(10);
+  root.setChildren([text, box]);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  let layouts = printLayout(root);
+  box.setHeight(30);
+  box.setMargin(Yoga.EDGE_LEFT, 4);
+  root.setPadding(Yoga.EDGE_ALL, 2);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  layouts += printLayout(root);
+  root.freeRecursive();
+  config.free();
+  const trace = Yoga.stopRecording()!;
+
+  expect(new TextDecoder().decode(new Uint8Array(trace, 0, 4))).toBe("YGTR");
+  expect(Yoga.stopRecording()).toBe(undefined);
+
+  const { code, stdout, stderr } = await replay(trace);
+  expect(code).toBe(0);
+  expect(stderr).toContain("0 measure divergences");
+  expect(stdout).toBe(layouts);
+});
+
+Deno.test("replay_remeasures_nodes_dirtied_by_tag", async () => {
+  Yoga.startRecording();
+  let width = 40;
+  const root = Yoga.Node.create();
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  const text = Yoga.Node.create();
+  text.setMeasureFunc(() => ({ width, height: 10 }));
+  text.setMeasureTag(1);
+  root.insertChild(text, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  let layouts = printLayout(root);
+  width = 60;
+  Yoga.markDirtyByTag(root, 1);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  layouts += printLayout(root);
+  root.freeRecursive();
+  const trace = Yoga.stopRecording()!;
+
+  const { stdout, stderr } = await replay(trace);
+  expect(stderr).toContain("0 measure divergences");
+  expect(stdout).toBe(layouts);
+});
+
+Deno.test("replay_ignores_intrinsic_size_measurements", async () => {
+  Yoga.startRecording();
+  const root = Yoga.Node.create();
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  const text = Yoga.Node.create();
+  text.setMeasureFunc((width, widthMode) => ({
+    width: widthMode === Yoga.MEASURE_MODE_UNDEFINED ? 60 : Math.min(60, width),
+    height: 10,
+  }));
+  root.insertChild(text, 0);
+  root.calculateLayout(100, undefined, Yoga.DIRECTION_LTR);
+  let layouts = printLayout(root);
+  // Measures the copies at widths the live tree never asks for.
+  root.getIntrinsicSizes();
+  root.setPadding(Yoga.EDGE_ALL, 5);
+  root.calculateLayout(100, undefined, Yoga.DIRECTION_LTR);
+  layouts += printLayout(root);
+  root.freeRecursive();
+  const trace = Yoga.stopRecording()!;
+
+  const { stdout, stderr } = await replay(trace);
+  expect(stderr).toContain("0 measure divergences");
+  expect(stdout).toBe(layouts);
+});
+
+Deno.test("replay_rejects_malformed_trace", async () => {
+  const { code, stderr } = await replay(new Uint8Array([1, 2, 3]).buffer);
+  expect(code).toBe(1);
+  expect(stderr).toContain("invalid or unsupported call trace");
+});
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function buildScrollView() {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+  root.setHeight(100);
+
+  const scroll = Yoga.Node.create();
+  scroll.setOverflow(Yoga.OVERFLOW_SCROLL);
+  scroll.setHeight(50);
+  scroll.setPadding(Yoga.EDGE_ALL, 5);
+  scroll.setBorder(Yoga.EDGE_ALL, 1);
+  root.insertChild(scroll, 0);
+
+  for (let i = 0; i < 3; i++) {
+    const item = Yoga.Node.create();
+    item.setHeight(30);
+    item.setFlexShrink(0);
+    item.setMargin(Yoga.EDGE_BOTTOM, 2);
+    scroll.insertChild(item, i);
+  }
+  return { root, scroll };
+}
+
+Deno.test("content_size_covers_margin_boxes_and_end_padding", () => {
+  const { root, scroll } = buildScrollView();
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  // Items end at 5 + 3 * 32 inside the padding box, plus 5 of end padding.
+  expect(scroll.getContentSize()).toEqual({ width: 98, height: 106 });
+  expect(root.getContentSize()).toBeUndefined();
+
+  root.freeRecursive();
+});
+
+Deno.test("content_size_includes_visible_overflow_of_descendants", () => {
+  const { root, scroll } = buildScrollView();
+  const wide = Yoga.Node.create();
+  wide.setWidth(200);
+  wide.setHeight(10);
+  scroll.getChild(0).insertChild(wide, 0);
+  const clipped = Yoga.Node.create();
+  clipped.setOverflow(Yoga.OVERFLOW_HIDDEN);
+  scroll.getChild(1).insertChild(clipped, 0);
+  const hidden = Yoga.Node.create();
+  hidden.setWidth(500);
+  clipped.insertChild(hidden, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(scroll.getContentSize()?.width).toBe(210);
+
+  root.freeRecursive();
+});
+
+Deno.test("content_size_is_updated_by_layout_when_enabled", () => {
+  const { root, scroll } = buildScrollView();
+  root.setContentSizeEnabled(true);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(scroll.getContentSize()?.height).toBe(106);
+
+  root.markLayoutSeen();
+  scroll.getChild(2).setHeight(60);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(scroll.getContentSize()?.height).toBe(136);
+
+  scroll.removeChild(scroll.getChild(2));
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(scroll.getContentSize()?.height).toBe(74);
+
+  root.setContentSizeEnabled(false);
+  root.freeRecursive();
+});
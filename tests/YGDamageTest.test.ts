@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function buildColumn() {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+  root.setHeight(100);
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  for (let i = 0; i < 2; i++) {
+    const child = Yoga.Node.create();
+    child.setWidth(50);
+    child.setHeight(10);
+    root.insertChild(child, i);
+  }
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  return root;
+}
+
+Deno.test("damage_is_empty_without_changes", () => {
+  const root = buildColumn();
+  root.setDamageTrackingEnabled(true);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(root.takeDamage().length).toBe(0);
+  root.freeRecursive();
+});
+
+Deno.test("damage_covers_old_and_new_frames", () => {
+  const root = buildColumn();
+  root.setDamageTrackingEnabled(true);
+
+  root.getChild(0).setHeight(20);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(Array.from(root.takeDamage())).toEqual([0, 0, 50, 30]);
+  expect(root.takeDamage().length).toBe(0);
+  root.freeRecursive();
+});
+
+Deno.test("damage_includes_removed_nodes", () => {
+  const root = buildColumn();
+  root.setDamageTrackingEnabled(true);
+
+  const removed = root.getChild(0);
+  root.removeChild(removed);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(Array.from(root.takeDamage())).toEqual([0, 0, 50, 20]);
+  removed.free();
+  root.freeRecursive();
+});
+
+Deno.test("damage_is_merged_into_a_few_rects", () => {
+  const root = Yoga.Node.create();
+  root.setWidth(1000);
+  root.setHeight(100);
+  for (let i = 0; i < 20; i++) {
+    const child = Yoga.Node.create();
+    child.setPositionType(Yoga.POSITION_TYPE_ABSOLUTE);
+    child.setPosition(Yoga.EDGE_LEFT, i * 50);
+    child.setWidth(10);
+    child.setHeight(10);
+    root.insertChild(child, i);
+  }
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  root.setDamageTrackingEnabled(true);
+
+  for (let i = 0; i < 20; i++) {
+    root.getChild(i).setWidth(20);
+  }
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  const damage = root.takeDamage();
+  expect(damage.length / 4).toBeLessThanOrEqual(8);
+  let left = Infinity, right = -Infinity;
+  for (let i = 0; i < damage.length; i += 4) {
+    left = Math.min(left, damage[i]);
+    right = Math.max(right, damage[i] + damage[i + 2]);
+  }
+  expect(left).toBe(0);
+  expect(right).toBe(970);
+  root.freeRecursive();
+});
+
+Deno.test("take_damage_requires_tracking", () => {
+  const root = Yoga.Node.create();
+  expect(() => root.takeDamage()).toThrow("Damage tracking is not enabled");
+  root.free();
+});
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+Deno.test("node_ids_resolve_to_nodes", () => {
+  const root = Yoga.Node.create();
+  const child = Yoga.Node.create();
+  root.insertChild(child, 0);
+
+  expect(root.getId()).not.toBe(child.getId());
+  expect(Yoga.Node.fromId(root.getId())).toBe(root);
+  expect(Yoga.Node.fromId(child.getId())).toBe(child);
+
+  const id = child.getId();
+  root.freeRecursive();
+  expect(Yoga.Node.fromId(id)).toBeUndefined();
+});
+
+Deno.test("dirtied_queue_records_instead_of_calling", () => {
+  Yoga.setDirtiedQueueEnabled(true);
+
+  const root = Yoga.Node.create();
+  const child = Yoga.Node.create();
+  child.setMeasureFunc(() => ({ width: 10, height: 10 }));
+  root.insertChild(child, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  let dirtied = 0;
+  root.setDirtiedFunc(() => dirtied++);
+  child.setDirtiedFunc(() => dirtied++);
+
+  child.markDirty();
+  expect(dirtied).toBe(0);
+  expect([...Yoga.drainDirtiedQueue()]).toEqual([child.getId(), root.getId()]);
+  expect(Yoga.drainDirtiedQueue().length).toBe(0);
+
+  Yoga.setDirtiedQueueEnabled(false);
+  root.freeRecursive();
+});
+
+Deno.test("dirtied_queue_is_deduplicated", () => {
+  Yoga.setDirtiedQueueEnabled(true);
+
+  const root = Yoga.Node.create();
+  root.setMeasureFunc(() => ({ width: 10, height: 10 }));
+  root.setDirtiedFunc(() => {});
+
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  // Dirtied, cleaned by layout, then dirtied again before draining.
+  root.markDirty();
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  root.markDirty();
+
+  expect([...Yoga.drainDirtiedQueue()]).toEqual([root.getId()]);
+
+  Yoga.setDirtiedQueueEnabled(false);
+  root.freeRecursive();
+});
+
+Deno.test("dirtied_queue_skips_freed_nodes", () => {
+  Yoga.setDirtiedQueueEnabled(true);
+
+  const root = Yoga.Node.create();
+  root.setMeasureFunc(() => ({ width: 10, height: 10 }));
+  root.setDirtiedFunc(() => {});
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  root.markDirty();
+  root.free();
+
+  expect(Yoga.drainDirtiedQueue().length).toBe(0);
+
+  Yoga.setDirtiedQueueEnabled(false);
+});
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function createTree() {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+  const container = Yoga.Node.create();
+  const leaf = Yoga.Node.create();
+  leaf.setHeight(10);
+  container.insertChild(leaf, 0);
+  root.insertChild(container, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  return { root, container, leaf };
+}
+
+Deno.test("dirty_trace_reports_origin_and_operation", () => {
+  const { root, container, leaf } = createTree();
+  Yoga.setDirtyTracingEnabled(true);
+
+  leaf.setHeight(20);
+  leaf.setWidth(20);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  container.insertChild(Yoga.Node.create(), 1);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  const traces = Yoga.takeDirtyTrace();
+  expect(traces.length).toBe(2);
+  expect(traces[0].root).toBe(root);
+  expect(traces[0].durationMs).toBeGreaterThanOrEqual(0);
+  expect(traces[0].events).toEqual([
+    { node: leaf, operation: "setHeight", dirtiedNodes: 3 },
+  ]);
+  expect(traces[1].events).toEqual([
+    { node: container, operation: "insertChild", dirtiedNodes: 2 },
+  ]);
+  expect(Yoga.takeDirtyTrace()).toEqual([]);
+
+  Yoga.setDirtyTracingEnabled(false);
+  root.freeRecursive();
+});
+
+Deno.test("dirty_trace_keeps_events_until_their_root_is_laid_out", () => {
+  const first = createTree();
+  const second = createTree();
+  first.leaf.setMeasureFunc(() => ({ width: 0, height: 0 }));
+  first.root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  Yoga.setDirtyTracingEnabled(true);
+
+  first.leaf.markDirty();
+  second.leaf.setFlexGrow(1);
+  first.root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  let traces = Yoga.takeDirtyTrace();
+  expect(traces.length).toBe(1);
+  expect(traces[0].events.map((event) => event.operation)).toEqual([
+    "markDirty",
+  ]);
+
+  second.root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  traces = Yoga.takeDirtyTrace();
+  expect(traces[0].root).toBe(second.root);
+  expect(traces[0].events[0].node).toBe(second.leaf);
+
+  Yoga.setDirtyTracingEnabled(false);
+  first.root.freeRecursive();
+  second.root.freeRecursive();
+});
+
+Deno.test("dirty_trace_captures_stacks_on_request", () => {
+  const { root, leaf } = createTree();
+  Yoga.setDirtyTracingEnabled(true, true);
+
+  leaf.setHeight(30);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  const [trace] = Yoga.takeDirtyTrace();
+  expect(trace.events[0].stack).toContain("YGDirtyTracingTest");
+
+  Yoga.setDirtyTracingEnabled(false);
+  root.freeRecursive();
+});
+
+Deno.test("dirty_trace_forgets_freed_nodes", () => {
+  const { root, container, leaf } = createTree();
+  Yoga.setDirtyTracingEnabled(true);
+
+  leaf.setHeight(40);
+  container.removeChild(leaf);
+  leaf.free();
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(Yoga.takeDirtyTrace()).toEqual([]);
+
+  root.setWidth(50);
+  Yoga.setDirtyTracingEnabled(false);
+  Yoga.setDirtyTracingEnabled(true);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(Yoga.takeDirtyTrace()).toEqual([]);
+
+  Yoga.setDirtyTracingEnabled(false);
+  root.freeRecursive();
+});
+
+Deno.test("dirty_trace_keeps_events_after_freed_nodes", () => {
+  const { root, container, leaf } = createTree();
+  Yoga.setDirtyTracingEnabled(true);
+
+  // The new node may reuse the id of the freed one.
+  leaf.setHeight(40);
+  container.removeChild(leaf);
+  leaf.free();
+  const other = Yoga.Node.create();
+  other.setHeight(10);
+  container.insertChild(other, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  for (const trace of Yoga.takeDirtyTrace()) {
+    expect(trace.events.map((event) => event.node)).not.toContain(undefined);
+  }
+
+  other.setHeight(30);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const traces = Yoga.takeDirtyTrace();
+  expect(traces.length).toBe(1);
+  expect(traces[0].events).toEqual([
+    { node: other, operation: "setHeight", dirtiedNodes: 3 },
+  ]);
+
+  Yoga.setDirtyTracingEnabled(false);
+  root.freeRecursive();
+});
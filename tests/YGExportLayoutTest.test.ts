@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function createTree(pointScaleFactor: number) {
+  const config = Yoga.Config.create();
+  config.setPointScaleFactor(pointScaleFactor);
+
+  const root = Yoga.Node.create(config);
+  root.setWidth(100.3);
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setPadding(Yoga.EDGE_LEFT, 0.4);
+  for (let i = 0; i < 3; i++) {
+    const child = Yoga.Node.create(config);
+    child.setFlexGrow(1);
+    child.setHeight(10.35);
+    root.insertChild(child, i);
+  }
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  return { root, config };
+}
+
+function frames(root: ReturnType<typeof Yoga.Node.create>) {
+  const result = [];
+  const stack = [root];
+  while (stack.length > 0) {
+    const node = stack.pop()!;
+    result.push(
+      node.getComputedLeft(),
+      node.getComputedTop(),
+      node.getComputedWidth(),
+      node.getComputedHeight(),
+    );
+    for (let i = node.getChildCount() - 1; i >= 0; i--) {
+      stack.push(node.getChild(i));
+    }
+  }
+  return result;
+}
+
+Deno.test("export_layout_matches_computed_layout", () => {
+  const { root, config } = createTree(0);
+
+  expect(Array.from(root.exportLayout())).toEqual(
+    Array.from(new Float32Array(frames(root))),
+  );
+
+  root.freeRecursive();
+  config.free();
+});
+
+Deno.test("export_layout_snaps_like_point_scale_factor", () => {
+  const unrounded = createTree(0);
+  for (const scale of [1, 2, 3]) {
+    const rounded = createTree(scale);
+    const expected = frames(rounded.root).map((value) =>
+      Math.round(value * scale)
+    );
+
+    expect(Array.from(unrounded.root.exportLayout(scale))).toEqual(expected);
+    expect(Array.from(unrounded.root.exportLayout(scale, true))).toEqual(
+      expected,
+    );
+
+    rounded.root.freeRecursive();
+    rounded.config.free();
+  }
+  unrounded.root.freeRecursive();
+  unrounded.config.free();
+});
+
+Deno.test("export_layout_rejects_invalid_scale", () => {
+  const node = Yoga.Node.create();
+  expect(() => node.exportLayout(-1)).toThrow("Invalid pixel scale");
+  expect(node.exportLayout(2, true)).toBeInstanceOf(Int32Array);
+  node.free();
+});
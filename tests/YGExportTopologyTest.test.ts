@@ -0,0 +1,46 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function createTree() {
+  const root = Yoga.Node.create();
+  const a = Yoga.Node.create();
+  const b = Yoga.Node.create();
+  const a0 = Yoga.Node.create();
+  const a1 = Yoga.Node.create();
+  root.setChildren([a, b]);
+  a.setChildren([a0, a1]);
+  return { root, a, b, a0, a1 };
+}
+
+Deno.test("export_topology_is_preorder", () => {
+  const { root, a, b, a0, a1 } = createTree();
+  const topology = root.exportTopology();
+
+  expect(Array.from(topology.parent)).toEqual([-1, 0, 1, 1, 0]);
+  expect(Array.from(topology.childCount)).toEqual([2, 2, 0, 0, 0]);
+  expect(Array.from(topology.depth)).toEqual([0, 1, 2, 2, 1]);
+  expect(Array.from(topology.ids)).toEqual(
+    [root, a, a0, a1, b].map((node) => node.getId()),
+  );
+  expect(topology.nodes).toBeUndefined();
+
+  root.freeRecursive();
+});
+
+Deno.test("export_topology_includes_nodes", () => {
+  const { root, a, b, a0, a1 } = createTree();
+  const { nodes } = a.exportTopology(true);
+
+  expect(nodes).toEqual([a, a0, a1]);
+  expect(nodes![1]).toBe(a0);
+  expect(b.exportTopology(true).nodes).toEqual([b]);
+
+  root.freeRecursive();
+});
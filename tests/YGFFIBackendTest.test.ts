@@ -0,0 +1,56 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+import { backends } from "../src/yoga_ffi.ts";
+
+Deno.test("ffi_setters_match_napi_setters", () => {
+  const ffiNode = Yoga.Node.create();
+  const napiNode = Yoga.Node.create();
+  const napi = backends.ffi ? backends.napi : Yoga.Node.prototype;
+
+  ffiNode.setWidth("50%");
+  ffiNode.setMargin(Yoga.EDGE_TOP, 10);
+  ffiNode.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  napi.setWidthPercent.call(napiNode, 50);
+  napi.setMargin.call(napiNode, Yoga.EDGE_TOP, 10);
+  napi.setFlexDirection.call(napiNode, Yoga.FLEX_DIRECTION_ROW);
+
+  expect(ffiNode.getWidth()).toEqual(napiNode.getWidth());
+  expect(ffiNode.getMargin(Yoga.EDGE_TOP)).toEqual(
+    napiNode.getMargin(Yoga.EDGE_TOP),
+  );
+  expect(ffiNode.getFlexDirection()).toBe(napiNode.getFlexDirection());
+
+  ffiNode.free();
+  napiNode.free();
+});
+
+Deno.test("ffi_setters_deliver_dirtied_callbacks", () => {
+  const root = Yoga.Node.create();
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  let dirtied = 0;
+  root.setDirtiedFunc(() => {
+    dirtied++;
+  });
+  root.setWidth(100);
+  expect(dirtied).toBe(1);
+
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(root.getComputedLayout()).toEqual({
+    left: 0,
+    right: 0,
+    top: 0,
+    bottom: 0,
+    width: 100,
+    height: 0,
+  });
+
+  root.free();
+});
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+import { getMeasureCounter } from "./tools/MeasureCounter.ts";
+
+// Three words of 20x10 that wrap to fit the offered width.
+function measureWords(width: number, widthMode: number) {
+  const perLine = widthMode === Yoga.MEASURE_MODE_UNDEFINED
+    ? 3
+    : Math.max(1, Math.min(3, Math.floor(width / 20)));
+  return { width: perLine * 20, height: Math.ceil(3 / perLine) * 10 };
+}
+
+Deno.test("intrinsic_sizes_of_wrapping_row", () => {
+  const root = Yoga.Node.create();
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setFlexWrap(Yoga.WRAP_WRAP);
+  root.setPadding(Yoga.EDGE_ALL, 5);
+  for (const width of [30, 50]) {
+    const child = Yoga.Node.create();
+    child.setWidth(width);
+    child.setHeight(10);
+    root.insertChild(child, root.getChildCount());
+  }
+
+  expect(root.getIntrinsicSizes()).toEqual({
+    minContentWidth: 60,
+    minContentHeight: 30,
+    maxContentWidth: 90,
+    maxContentHeight: 20,
+  });
+
+  root.freeRecursive();
+});
+
+Deno.test("intrinsic_sizes_leave_layout_alone", () => {
+  const root = Yoga.Node.create();
+  const text = Yoga.Node.create();
+  const counter = getMeasureCounter(measureWords);
+  text.setMeasureFunc(counter.inc);
+  root.insertChild(text, 0);
+  root.calculateLayout(200, undefined, Yoga.DIRECTION_LTR);
+  const layout = text.getComputedLayout();
+
+  expect(root.getIntrinsicSizes()).toEqual({
+    minContentWidth: 20,
+    minContentHeight: 30,
+    maxContentWidth: 60,
+    maxContentHeight: 10,
+  });
+  expect(root.getComputedWidth()).toBe(200);
+  expect(text.getComputedLayout()).toEqual(layout);
+  expect(root.isDirty()).toBe(false);
+
+  root.freeRecursive();
+});
+
+Deno.test("intrinsic_sizes_are_kept_until_dirtied", () => {
+  const root = Yoga.Node.create();
+  const text = Yoga.Node.create();
+  const counter = getMeasureCounter(measureWords);
+  text.setMeasureFunc(counter.inc);
+  root.insertChild(text, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  const sizes = root.getIntrinsicSizes();
+  const measured = counter.get();
+  expect(root.getIntrinsicSizes()).toEqual(sizes);
+  expect(counter.get()).toBe(measured);
+
+  root.setPadding(Yoga.EDGE_LEFT, 10);
+  expect(root.getIntrinsicSizes().maxContentWidth).toBe(70);
+
+  root.freeRecursive();
+});
@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+import { collectLayouts } from "./tools/collectLayouts.ts";
+
+function createCard() {
+  const root = Yoga.Node.create();
+  root.setWidth(300);
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setPadding(Yoga.EDGE_ALL, 8);
+
+  const avatar = Yoga.Node.create();
+  avatar.setWidth(40);
+  avatar.setHeight(40);
+  root.insertChild(avatar, 0);
+
+  const body = Yoga.Node.create();
+  body.setFlexGrow(1);
+  body.setMargin(Yoga.EDGE_LEFT, 8);
+  root.insertChild(body, 1);
+
+  const title = Yoga.Node.create();
+  title.setHeight(20);
+  body.insertChild(title, 0);
+  return root;
+}
+
+function withLayoutCache(fn: () => void) {
+  Yoga.clearLayoutCache();
+  Yoga.setLayoutCacheCapacity(16);
+  try {
+    fn();
+  } finally {
+    Yoga.setLayoutCacheCapacity(0);
+    Yoga.clearLayoutCache();
+  }
+}
+
+Deno.test("identical_subtrees_share_cached_layout", () => {
+  withLayoutCache(() => {
+    const first = createCard();
+    const second = createCard();
+
+    first.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+    expect(Yoga.getLayoutCacheStats().hits).toBe(1);
+    expect(second.isDirty()).toBe(false);
+    expect(second.hasNewLayout()).toBe(true);
+    expect(collectLayouts(second)).toEqual(collectLayouts(first));
+
+    first.freeRecursive();
+    second.freeRecursive();
+  });
+});
+
+Deno.test("different_constraints_miss_cache", () => {
+  withLayoutCache(() => {
+    const first = createCard();
+    const second = createCard();
+
+    first.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_RTL);
+
+    expect(Yoga.getLayoutCacheStats().hits).toBe(0);
+    expect(second.getChild(0).getComputedLeft()).toBe(252);
+
+    first.freeRecursive();
+    second.freeRecursive();
+  });
+});
+
+Deno.test("style_change_invalidates_subtree_hash", () => {
+  withLayoutCache(() => {
+    const first = createCard();
+    const second = createCard();
+    first.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+    second.getChild(1).getChild(0).setHeight(60);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(Yoga.getLayoutCacheStats().hits).toBe(0);
+    expect(second.getComputedHeight()).toBe(76);
+
+    second.getChild(1).getChild(0).setHeight(20);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(Yoga.getLayoutCacheStats().hits).toBe(1);
+    expect(collectLayouts(second)).toEqual(collectLayouts(first));
+
+    first.freeRecursive();
+    second.freeRecursive();
+  });
+});
+
+Deno.test("measured_subtrees_require_measure_cache_key", () => {
+  withLayoutCache(() => {
+    const measure = () => ({ width: 50, height: 15 });
+    const first = createCard();
+    const second = createCard();
+    first.getChild(1).getChild(0).setMeasureFunc(measure);
+    second.getChild(1).getChild(0).setMeasureFunc(measure);
+
+    first.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(Yoga.getLayoutCacheStats()).toEqual({
+      hits: 0,
+      misses: 0,
+      size: 0,
+      capacity: 16,
+    });
+
+    first.getChild(1).getChild(0).setMeasureCacheKey("Hello");
+    second.getChild(1).getChild(0).setMeasureCacheKey("Hello");
+    first.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(Yoga.getLayoutCacheStats().hits).toBe(1);
+
+    second.getChild(1).getChild(0).setMeasureCacheKey("Goodbye");
+    expect(second.isDirty()).toBe(true);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(Yoga.getLayoutCacheStats().hits).toBe(1);
+
+    first.freeRecursive();
+    second.freeRecursive();
+  });
+});
+
+Deno.test("layout_cache_evicts_least_recently_used", () => {
+  withLayoutCache(() => {
+    Yoga.setLayoutCacheCapacity(2);
+    const nodes = [100, 200, 300].map((width) => {
+      const node = Yoga.Node.create();
+      node.setWidth(width);
+      node.setHeight(10);
+      node.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+      return node;
+    });
+    expect(Yoga.getLayoutCacheStats().size).toBe(2);
+
+    const repeat = Yoga.Node.create();
+    repeat.setWidth(100);
+    repeat.setHeight(10);
+    repeat.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(Yoga.getLayoutCacheStats().hits).toBe(0);
+
+    repeat.setWidth(300);
+    repeat.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(Yoga.getLayoutCacheStats().hits).toBe(1);
+    expect(repeat.getComputedWidth()).toBe(300);
+
+    for (const node of [...nodes, repeat]) {
+      node.free();
+    }
+  });
+});
+
+Deno.test("layouts_without_cache_do_not_leave_stale_hashes", () => {
+  withLayoutCache(() => {
+    const card = createCard();
+    card.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+    Yoga.setLayoutCacheCapacity(0);
+    card.getChild(1).getChild(0).setHeight(50);
+    card.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    Yoga.setLayoutCacheCapacity(16);
+
+    const original = createCard();
+    original.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    card.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(card.getChild(1).getChild(0).getComputedHeight()).toBe(50);
+
+    card.freeRecursive();
+    original.freeRecursive();
+  });
+});
+
+Deno.test("gap_units_are_part_of_the_hash", () => {
+  withLayoutCache(() => {
+    const points = createCard();
+    points.setGap(Yoga.GUTTER_COLUMN, 10);
+    const percent = createCard();
+    percent.setGapPercent(Yoga.GUTTER_COLUMN, 10);
+
+    points.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    percent.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+    expect(Yoga.getLayoutCacheStats().hits).toBe(0);
+    expect(percent.getChild(1).getComputedLeft()).not.toBe(
+      points.getChild(1).getComputedLeft(),
+    );
+
+    points.freeRecursive();
+    percent.freeRecursive();
+  });
+});
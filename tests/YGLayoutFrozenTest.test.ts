@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function buildPanel() {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  const panel = Yoga.Node.create();
+  const item = Yoga.Node.create();
+  item.setWidth(20);
+  item.setHeight(10);
+  panel.insertChild(item, 0);
+  root.insertChild(panel, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  return { root, panel, item };
+}
+
+Deno.test("frozen_layout_keeps_last_layout", () => {
+  const { root, panel, item } = buildPanel();
+  panel.setLayoutFrozen(true);
+  expect(panel.isLayoutFrozen()).toBe(true);
+
+  item.setHeight(30);
+  expect(item.isDirty()).toBe(true);
+  expect(panel.isDirty()).toBe(true);
+  expect(root.isDirty()).toBe(false);
+
+  root.setHeight(200);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(root.getComputedHeight()).toBe(200);
+  expect(panel.getComputedHeight()).toBe(10);
+  expect(item.getComputedHeight()).toBe(10);
+
+  root.freeRecursive();
+});
+
+Deno.test("unfrozen_layout_catches_up", () => {
+  const { root, panel, item } = buildPanel();
+  const dirtied: string[] = [];
+  root.setDirtiedFunc(() => dirtied.push("root"));
+  panel.setLayoutFrozen(true);
+  item.setHeight(30);
+  item.setWidth(40);
+  expect(dirtied).toEqual([]);
+
+  panel.setLayoutFrozen(false);
+  expect(dirtied).toEqual(["root"]);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(panel.getComputedWidth()).toBe(40);
+  expect(panel.getComputedHeight()).toBe(30);
+  expect(root.isDirty()).toBe(false);
+  expect(panel.isDirty()).toBe(false);
+
+  root.freeRecursive();
+});
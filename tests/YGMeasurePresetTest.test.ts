@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function createRoot() {
+  const root = Yoga.Node.create();
+  root.setWidth(200);
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  return root;
+}
+
+Deno.test("intrinsic_size_measures_natively", () => {
+  const root = createRoot();
+  const image = Yoga.Node.create();
+  image.setIntrinsicSize(40, 30);
+  root.insertChild(image, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(image.getComputedWidth()).toBe(40);
+  expect(image.getComputedHeight()).toBe(30);
+
+  image.setIntrinsicSize(300, 30);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(image.getComputedWidth()).toBe(200);
+
+  root.freeRecursive();
+});
+
+Deno.test("aspect_measure_follows_offered_width", () => {
+  const root = createRoot();
+  const stretched = Yoga.Node.create();
+  stretched.setAlignSelf(Yoga.ALIGN_STRETCH);
+  stretched.setAspectMeasure(2);
+  root.insertChild(stretched, 0);
+  const bounded = Yoga.Node.create();
+  bounded.setAspectMeasure(2, 0, 100);
+  root.insertChild(bounded, 1);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(stretched.getComputedWidth()).toBe(200);
+  expect(stretched.getComputedHeight()).toBe(100);
+  expect(bounded.getComputedWidth()).toBe(100);
+  expect(bounded.getComputedHeight()).toBe(50);
+
+  root.freeRecursive();
+});
+
+Deno.test("clamp_measure_bounds_offered_size", () => {
+  const root = createRoot();
+  const node = Yoga.Node.create();
+  node.setClampMeasure(0, 20, 120, 50);
+  root.insertChild(node, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(node.getComputedWidth()).toBe(120);
+  expect(node.getComputedHeight()).toBe(50);
+
+  root.freeRecursive();
+});
+
+Deno.test("measure_presets_keep_layouts_cacheable", () => {
+  Yoga.clearLayoutCache();
+  Yoga.setLayoutCacheCapacity(16);
+  try {
+    const first = createRoot();
+    const second = createRoot();
+    for (const root of [first, second]) {
+      const icon = Yoga.Node.create();
+      icon.setIntrinsicSize(24, 24);
+      root.insertChild(icon, 0);
+      root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    }
+    expect(Yoga.getLayoutCacheStats().hits).toBe(1);
+
+    second.getChild(0).setIntrinsicSize(32, 32);
+    second.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(second.getChild(0).getComputedWidth()).toBe(32);
+
+    first.freeRecursive();
+    second.freeRecursive();
+  } finally {
+    Yoga.setLayoutCacheCapacity(0);
+    Yoga.clearLayoutCache();
+  }
+});
+
+Deno.test("measure_presets_reject_invalid_values", () => {
+  const root = createRoot();
+  root.insertChild(Yoga.Node.create(), 0);
+
+  expect(() => root.setIntrinsicSize(10, 10)).toThrow(
+    "Nodes with measure functions cannot have children",
+  );
+  const leaf = root.getChild(0);
+  expect(() => leaf.setIntrinsicSize(-1, 10)).toThrow(RangeError);
+  expect(() => leaf.setAspectMeasure(0)).toThrow(RangeError);
+  expect(() => leaf.setClampMeasure(10, 0, 5)).toThrow(RangeError);
+
+  root.freeRecursive();
+});
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+const SERIF = 1;
+const SANS = 2;
+
+Deno.test("mark_dirty_by_tag_remeasures_matching_nodes", () => {
+  let glyphWidth = 10;
+  const root = Yoga.Node.create();
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  for (const font of [SERIF, SANS, SERIF]) {
+    const text = Yoga.Node.create();
+    text.setMeasureFunc(() => ({ width: glyphWidth * font, height: 10 }));
+    text.setMeasureTag(font);
+    root.insertChild(text, root.getChildCount());
+  }
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(root.getChild(0).getComputedWidth()).toBe(10);
+
+  glyphWidth = 12;
+  expect(Yoga.markDirtyByTag(root, SERIF)).toBe(2);
+  expect(root.isDirty()).toBe(true);
+  expect(root.getChild(1).isDirty()).toBe(false);
+
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(root.getChild(0).getComputedWidth()).toBe(12);
+  expect(root.getChild(1).getComputedWidth()).toBe(20);
+  expect(root.getChild(2).getComputedWidth()).toBe(12);
+
+  root.freeRecursive();
+});
+
+Deno.test("mark_dirty_by_tag_drops_cached_layouts", () => {
+  Yoga.clearLayoutCache();
+  Yoga.setLayoutCacheCapacity(16);
+  try {
+    let glyphWidth = 10;
+    const root = Yoga.Node.create();
+    root.setAlignItems(Yoga.ALIGN_FLEX_START);
+    const text = Yoga.Node.create();
+    text.setMeasureFunc(() => ({ width: glyphWidth, height: 10 }));
+    text.setMeasureCacheKey("hello");
+    text.setMeasureTag(SERIF);
+    root.insertChild(text, 0);
+    root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+    glyphWidth = 14;
+    Yoga.markDirtyByTag(root, SERIF);
+    root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+    expect(text.getComputedWidth()).toBe(14);
+
+    root.freeRecursive();
+  } finally {
+    Yoga.setLayoutCacheCapacity(0);
+    Yoga.clearLayoutCache();
+  }
+});
+
+Deno.test("mark_dirty_by_tag_ignores_untagged_nodes", () => {
+  const root = Yoga.Node.create();
+  const text = Yoga.Node.create();
+  text.setMeasureFunc(() => ({ width: 10, height: 10 }));
+  root.insertChild(text, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(Yoga.markDirtyByTag(root, 0)).toBe(0);
+  expect(Yoga.markDirtyByTag(root, SERIF)).toBe(0);
+  expect(root.isDirty()).toBe(false);
+
+  root.freeRecursive();
+});
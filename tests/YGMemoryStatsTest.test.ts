@@ -0,0 +1,58 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+Deno.test("memory_stats_track_live_and_freed_nodes", () => {
+  const before = Yoga.getMemoryStats();
+
+  const root = Yoga.Node.create();
+  for (let i = 0; i < 10; i++) {
+    root.insertChild(Yoga.Node.create(), i);
+  }
+
+  const during = Yoga.getMemoryStats();
+  expect(during.liveNodes - before.liveNodes).toBe(11);
+  expect(during.bytes).toBeGreaterThan(before.bytes);
+  expect(during.peakBytes).toBeGreaterThanOrEqual(during.bytes);
+
+  root.freeRecursive();
+
+  const after = Yoga.getMemoryStats();
+  expect(after.liveNodes).toBe(before.liveNodes);
+  expect(after.freedNodes - before.freedNodes).toBe(11);
+  expect(after.bytes).toBe(before.bytes);
+  expect(after.peakBytes).toBe(during.peakBytes);
+});
+
+Deno.test("memory_stats_track_configs", () => {
+  const before = Yoga.getMemoryStats();
+
+  const config = Yoga.Config.create();
+  const node = Yoga.Node.create(config);
+  expect(Yoga.getMemoryStats().liveConfigs - before.liveConfigs).toBe(1);
+
+  node.free();
+  config.free();
+
+  const after = Yoga.getMemoryStats();
+  expect(after.liveConfigs).toBe(before.liveConfigs);
+  expect(after.freedConfigs - before.freedConfigs).toBe(1);
+  expect(after.bytes).toBe(before.bytes);
+});
+
+Deno.test("memory_stats_include_virtual_lists", () => {
+  const list = Yoga.Node.create();
+  const before = Yoga.getMemoryStats();
+
+  list.setVirtualItemCount(100000, 20);
+  expect(Yoga.getMemoryStats().bytes - before.bytes).toBeGreaterThan(100000);
+
+  list.free();
+  expect(Yoga.getMemoryStats().bytes).toBeLessThan(before.bytes);
+});
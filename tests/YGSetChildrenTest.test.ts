@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function createChildren(count: number) {
+  const children = [];
+  for (let i = 0; i < count; i++) {
+    const child = Yoga.Node.create();
+    child.setHeight(10 * (i + 1));
+    children.push(child);
+  }
+  return children;
+}
+
+Deno.test("set_children_reorders_children", () => {
+  const root = Yoga.Node.create();
+  const [a, b, c] = createChildren(3);
+
+  root.setChildren([a, b, c]);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  root.setChildren([c, a, b]);
+  expect(root.getChildCount()).toBe(3);
+  expect(root.getChild(0)).toBe(c);
+  expect(root.getChild(1)).toBe(a);
+  expect(root.getChild(2)).toBe(b);
+  expect(root.isDirty()).toBe(true);
+
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(c.getComputedTop()).toBe(0);
+  expect(a.getComputedTop()).toBe(30);
+  expect(b.getComputedTop()).toBe(40);
+
+  root.freeRecursive();
+});
+
+Deno.test("set_children_with_same_children_does_not_dirty", () => {
+  const root = Yoga.Node.create();
+  const children = createChildren(3);
+
+  root.setChildren(children);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  root.setChildren(children);
+  expect(root.isDirty()).toBe(false);
+
+  root.freeRecursive();
+});
+
+Deno.test("set_children_detaches_removed_children", () => {
+  const root = Yoga.Node.create();
+  const [a, b, c] = createChildren(3);
+
+  root.setChildren([a, b, c]);
+  root.setChildren([c]);
+
+  expect(root.getChildCount()).toBe(1);
+  expect(a.getParent()).toBeFalsy();
+  expect(b.getParent()).toBeFalsy();
+  expect(c.getParent()).toBe(root);
+
+  root.freeRecursive();
+  a.free();
+  b.free();
+});
+
+Deno.test("set_children_rejects_children_of_other_nodes", () => {
+  const root = Yoga.Node.create();
+  const other = Yoga.Node.create();
+  const [a] = createChildren(1);
+
+  other.insertChild(a, 0);
+  expect(() => root.setChildren([a])).toThrow();
+  expect(root.getChildCount()).toBe(0);
+
+  root.freeRecursive();
+  other.freeRecursive();
+});
+
+Deno.test("insert_children_at_index", () => {
+  const root = Yoga.Node.create();
+  const [a, b, c, d] = createChildren(4);
+
+  root.setChildren([a, d]);
+  root.insertChildren([b, c], 1);
+
+  expect(root.getChildCount()).toBe(4);
+  expect(root.getChild(0)).toBe(a);
+  expect(root.getChild(1)).toBe(b);
+  expect(root.getChild(2)).toBe(c);
+  expect(root.getChild(3)).toBe(d);
+  expect(c.getParent()).toBe(root);
+
+  root.freeRecursive();
+});
+
+Deno.test("remove_all_children", () => {
+  const root = Yoga.Node.create();
+  const [a, b] = createChildren(2);
+
+  root.setChildren([a, b]);
+  root.removeAllChildren();
+
+  expect(root.getChildCount()).toBe(0);
+  expect(a.getParent()).toBeFalsy();
+  expect(b.getParent()).toBeFalsy();
+
+  root.free();
+  a.free();
+  b.free();
+});
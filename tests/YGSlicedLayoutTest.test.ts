@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+import { collectLayouts } from "./tools/collectLayouts.ts";
+
+function createGrid() {
+  const root = Yoga.Node.create();
+  root.setWidth(500);
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setFlexWrap(Yoga.WRAP_WRAP);
+
+  for (let i = 0; i < 20; i++) {
+    const card = Yoga.Node.create();
+    card.setWidth(100);
+    card.setHeight(80);
+    card.setPadding(Yoga.EDGE_ALL, 5);
+    root.insertChild(card, i);
+
+    for (let j = 0; j < 3; j++) {
+      const line = Yoga.Node.create();
+      line.setFlexGrow(1);
+      line.setMargin(Yoga.EDGE_BOTTOM, 2);
+      card.insertChild(line, j);
+    }
+  }
+  return root;
+}
+
+Deno.test("sliced_layout_resumes_until_finished", () => {
+  const sliced = createGrid();
+  const whole = createGrid();
+
+  let calls = 1;
+  while (
+    !sliced.calculateLayoutSliced(undefined, undefined, Yoga.DIRECTION_LTR, 0)
+  ) {
+    calls++;
+  }
+  whole.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(calls).toBeGreaterThan(1);
+  expect(sliced.isDirty()).toBe(false);
+  expect(collectLayouts(sliced)).toEqual(collectLayouts(whole));
+
+  sliced.freeRecursive();
+  whole.freeRecursive();
+});
+
+Deno.test("sliced_layout_finishes_within_large_budget", () => {
+  const root = createGrid();
+
+  expect(
+    root.calculateLayoutSliced(undefined, undefined, Yoga.DIRECTION_LTR, 1e6),
+  ).toBe(true);
+  expect(root.getComputedHeight()).toBe(320);
+
+  root.getChild(3).setHeight(100);
+  expect(
+    root.calculateLayoutSliced(undefined, undefined, Yoga.DIRECTION_LTR, 0),
+  ).toBe(false);
+  expect(
+    root.calculateLayoutSliced(undefined, undefined, Yoga.DIRECTION_LTR, 0),
+  ).toBe(true);
+  expect(root.getComputedHeight()).toBe(340);
+
+  root.freeRecursive();
+});
+
+Deno.test("sliced_layout_matches_with_percentages_and_absolutes", () => {
+  function createTree() {
+    const root = createGrid();
+    for (let i = 0; i < 20; i += 2) {
+      root.getChild(i).setPaddingPercent(Yoga.EDGE_LEFT, 2);
+    }
+    const holder = root.getChild(1);
+    holder.setPositionType(Yoga.POSITION_TYPE_STATIC);
+    const badge = Yoga.Node.create();
+    badge.setPositionType(Yoga.POSITION_TYPE_ABSOLUTE);
+    badge.setPosition(Yoga.EDGE_RIGHT, 0);
+    badge.setWidth(10);
+    badge.setHeight(10);
+    holder.insertChild(badge, 0);
+    return root;
+  }
+  const sliced = createTree();
+  const whole = createTree();
+
+  while (
+    !sliced.calculateLayoutSliced(undefined, undefined, Yoga.DIRECTION_LTR, 0)
+  );
+  whole.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(collectLayouts(sliced)).toEqual(collectLayouts(whole));
+
+  sliced.freeRecursive();
+  whole.freeRecursive();
+});
+
+Deno.test("sliced_layout_matches_with_inherited_direction_and_flex", () => {
+  function createTree() {
+    const root = createGrid();
+    root.setDirection(Yoga.DIRECTION_RTL);
+    for (let i = 0; i < 20; i++) {
+      const card = root.getChild(i);
+      card.setAlignItems(Yoga.ALIGN_FLEX_START);
+      card.getChild(0).setWidth(20);
+    }
+    root.getChild(5).setFlexShrink(1);
+    root.getChild(6).setFlexBasis(50);
+    return root;
+  }
+  const sliced = createTree();
+  const whole = createTree();
+
+  while (
+    !sliced.calculateLayoutSliced(undefined, undefined, Yoga.DIRECTION_LTR, 0)
+  );
+  whole.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(sliced.getChild(0).getChild(0).getComputedLeft()).toBe(75);
+  expect(sliced.getChild(6).getComputedWidth()).toBe(50);
+  expect(collectLayouts(sliced)).toEqual(collectLayouts(whole));
+
+  sliced.freeRecursive();
+  whole.freeRecursive();
+});
@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+import { collectLayouts } from "./tools/collectLayouts.ts";
+
+function createTree() {
+  const root = Yoga.Node.create();
+  root.setWidth(200);
+  root.setHeight(100);
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setPadding(Yoga.EDGE_ALL, 10);
+
+  const child0 = Yoga.Node.create();
+  child0.setFlexGrow(1);
+  child0.setMargin(Yoga.EDGE_RIGHT, "5%");
+  root.insertChild(child0, 0);
+
+  const child1 = Yoga.Node.create();
+  child1.setWidth("25%");
+  child1.setFlex(1);
+  root.insertChild(child1, 1);
+
+  const grandChild = Yoga.Node.create();
+  grandChild.setHeight(30);
+  grandChild.setMarginAuto(Yoga.EDGE_TOP);
+  child1.insertChild(grandChild, 0);
+
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  return root;
+}
+
+Deno.test("deserialized_tree_has_layout_without_calculating", () => {
+  const root = createTree();
+  const restored = Yoga.Node.deserialize(root.serialize());
+
+  expect(restored.isDirty()).toBe(false);
+  expect(restored.getChildCount()).toBe(2);
+  expect(restored.getChild(1).getChildCount()).toBe(1);
+  expect(collectLayouts(restored)).toEqual(collectLayouts(root));
+
+  root.freeRecursive();
+  restored.freeRecursive();
+});
+
+Deno.test("deserialized_tree_keeps_styles", () => {
+  const root = createTree();
+  const restored = Yoga.Node.deserialize(new Uint8Array(root.serialize()));
+
+  expect(restored.getFlexDirection()).toBe(Yoga.FLEX_DIRECTION_ROW);
+  expect(restored.getChild(0).getMargin(Yoga.EDGE_RIGHT)).toEqual({
+    unit: Yoga.UNIT_PERCENT,
+    value: 5,
+  });
+  expect(restored.getChild(1).getWidth()).toEqual({
+    unit: Yoga.UNIT_PERCENT,
+    value: 25,
+  });
+  expect(restored.getChild(1).getChild(0).getMargin(Yoga.EDGE_TOP).unit).toBe(
+    Yoga.UNIT_AUTO,
+  );
+
+  // Relayout from scratch matches the original layout.
+  restored.setWidth(201);
+  restored.setWidth(200);
+  restored.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(collectLayouts(restored)).toEqual(collectLayouts(root));
+
+  root.freeRecursive();
+  restored.freeRecursive();
+});
+
+Deno.test("deserialize_rejects_invalid_snapshots", () => {
+  const root = createTree();
+  const bytes = new Uint8Array(root.serialize());
+
+  expect(() => Yoga.Node.deserialize(new ArrayBuffer(3))).toThrow();
+  expect(() => Yoga.Node.deserialize(bytes.slice(0, bytes.length - 1)))
+    .toThrow();
+
+  root.freeRecursive();
+});
+
+Deno.test("deserialized_tree_keeps_percent_gaps", () => {
+  const root = Yoga.Node.create();
+  root.setWidth(200);
+  root.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.setGapPercent(Yoga.GUTTER_COLUMN, 10);
+  for (let i = 0; i < 2; i++) {
+    const child = Yoga.Node.create();
+    child.setWidth(20);
+    root.insertChild(child, i);
+  }
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const restored = Yoga.Node.deserialize(root.serialize());
+
+  restored.setWidth(400);
+  restored.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(restored.getChild(1).getComputedLeft()).toBe(60);
+
+  root.freeRecursive();
+  restored.freeRecursive();
+});
+
+Deno.test("deserialize_reads_only_the_viewed_bytes", () => {
+  const root = createTree();
+  const bytes = new Uint8Array(root.serialize());
+  const padded = new Uint8Array(bytes.length + 8);
+  padded.set(bytes, 4);
+
+  const restored = Yoga.Node.deserialize(
+    padded.subarray(4, 4 + bytes.length),
+  );
+  expect(collectLayouts(restored)).toEqual(collectLayouts(root));
+  expect(() =>
+    Yoga.Node.deserialize(padded.subarray(4, 4 + bytes.length - 1))
+  ).toThrow();
+  const view = new DataView(padded.buffer, 4, bytes.length);
+  Yoga.Node.deserialize(view).freeRecursive();
+
+  root.freeRecursive();
+  restored.freeRecursive();
+});
+
+Deno.test("deserialized_tree_keeps_measure_presets", () => {
+  const root = Yoga.Node.create();
+  root.setWidth(200);
+  root.setAlignItems(Yoga.ALIGN_FLEX_START);
+  const icon = Yoga.Node.create();
+  icon.setIntrinsicSize(24, 16);
+  root.insertChild(icon, 0);
+  const image = Yoga.Node.create();
+  image.setAspectMeasure(2, 0, 120);
+  root.insertChild(image, 1);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const restored = Yoga.Node.deserialize(root.serialize());
+
+  // The presets answer again once the layout is redone.
+  restored.setWidth(100);
+  root.setWidth(100);
+  restored.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(restored.getChild(0).getComputedWidth()).toBe(24);
+  expect(restored.getChild(0).getComputedHeight()).toBe(16);
+  expect(collectLayouts(restored)).toEqual(collectLayouts(root));
+
+  // A preset leaf keeps its preset through a second round trip.
+  const again = Yoga.Node.deserialize(restored.serialize());
+  again.getChild(1).setWidth(60);
+  again.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(again.getChild(1).getComputedHeight()).toBe(30);
+
+  root.freeRecursive();
+  restored.freeRecursive();
+  again.freeRecursive();
+});
@@ -0,0 +1,71 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function createList(count: number) {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+  root.setHeight(100);
+
+  const scroll = Yoga.Node.create();
+  scroll.setHeight(50);
+  scroll.setOverflow(Yoga.OVERFLOW_SCROLL);
+  root.insertChild(scroll, 0);
+
+  for (let i = 0; i < count; i++) {
+    const row = Yoga.Node.create();
+    row.setHeight(10);
+    row.setFlexShrink(0);
+    scroll.insertChild(row, i);
+  }
+
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  return { root, scroll };
+}
+
+Deno.test("query_rect_returns_nodes_in_document_order", () => {
+  const { root, scroll } = createList(10);
+
+  const nodes = root.queryRect(0, 15, 100, 10);
+  expect(nodes).toEqual([root, scroll, scroll.getChild(1), scroll.getChild(2)]);
+
+  root.freeRecursive();
+});
+
+Deno.test("query_rect_skips_nodes_clipped_by_overflow", () => {
+  const { root, scroll } = createList(10);
+
+  const nodes = root.queryRect(0, 60, 100, 40);
+  expect(nodes).toEqual([root]);
+  expect(nodes.includes(scroll.getChild(7))).toBe(false);
+
+  root.freeRecursive();
+});
+
+Deno.test("hit_test_returns_topmost_node", () => {
+  const { root, scroll } = createList(10);
+
+  expect(root.hitTest(50, 25)).toBe(scroll.getChild(2));
+  expect(root.hitTest(50, 75)).toBe(root);
+  expect(root.hitTest(150, 25)).toBeUndefined();
+
+  root.freeRecursive();
+});
+
+Deno.test("spatial_index_follows_relayout", () => {
+  const { root, scroll } = createList(10);
+
+  expect(root.hitTest(50, 5)).toBe(scroll.getChild(0));
+
+  scroll.getChild(0).setHeight(30);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(root.hitTest(50, 25)).toBe(scroll.getChild(0));
+
+  root.freeRecursive();
+});
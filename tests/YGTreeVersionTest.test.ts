@@ -0,0 +1,161 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function buildTree(rows: number, columns: number) {
+  const root = Yoga.Node.create();
+  root.setWidth(1000);
+  for (let i = 0; i < rows; i++) {
+    const row = Yoga.Node.create();
+    row.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+    row.setHeight(10);
+    for (let j = 0; j < columns; j++) {
+      const cell = Yoga.Node.create();
+      cell.setWidth(10);
+      row.insertChild(cell, j);
+    }
+    root.insertChild(row, i);
+  }
+  return root;
+}
+
+Deno.test("snapshot_keeps_layout_after_changes", () => {
+  const root = buildTree(3, 3);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const cell = root.getChild(1).getChild(2);
+
+  const version = root.snapshot();
+  cell.setWidth(50);
+  root.getChild(0).setHeight(30);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(cell.getComputedWidth()).toBe(50);
+  expect(root.getComputedHeight()).toBe(50);
+  expect(version.getComputedLayout(cell)).toMatchObject({
+    left: 20,
+    top: 0,
+    width: 10,
+  });
+  expect(version.getComputedLayout()?.height).toBe(30);
+  expect(version.getComputedLayout(root.getChild(1))?.top).toBe(10);
+  expect(Array.from(version.exportLayout())).not.toEqual(
+    Array.from(root.exportLayout()),
+  );
+
+  version.free();
+  root.freeRecursive();
+  expect(Yoga.getMemoryStats().frozenNodes).toBe(0);
+});
+
+Deno.test("snapshot_shares_unchanged_subtrees", () => {
+  const root = buildTree(100, 10);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const before = Yoga.getMemoryStats().frozenNodes;
+
+  const version = root.snapshot();
+  expect(Yoga.getMemoryStats().frozenNodes - before).toBe(1);
+
+  // Only the path to the changed cell is copied; the rows and cells the
+  // layout visits again stay shared.
+  root.getChild(50).getChild(5).setWidth(20);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const copied = Yoga.getMemoryStats().frozenNodes - before;
+  expect(copied).toBe(3);
+
+  expect(version.exportTopology().ids).toEqual(root.exportTopology().ids);
+  expect(version.exportTopology(true).nodes).toBeUndefined();
+  expect(version.getComputedLayout(root.getChild(50).getChild(6))?.left)
+    .toBe(60);
+  expect(root.getChild(50).getChild(6).getComputedLeft()).toBe(70);
+
+  version.free();
+  expect(Yoga.getMemoryStats().frozenNodes).toBe(before);
+  root.freeRecursive();
+});
+
+Deno.test("snapshot_survives_freeing_the_live_tree", () => {
+  const root = buildTree(2, 2);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const bytes = root.serialize();
+
+  const version = root.snapshot();
+  root.freeRecursive();
+
+  expect(new Uint8Array(version.serialize())).toEqual(new Uint8Array(bytes));
+  expect(version.exportTopology().childCount).toEqual(
+    new Uint32Array([2, 2, 0, 0, 2, 0, 0]),
+  );
+
+  version.free();
+  version.free();
+  expect(Yoga.getMemoryStats().frozenNodes).toBe(0);
+});
+
+Deno.test("snapshot_children_can_be_moved", () => {
+  const root = buildTree(2, 2);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  const version = root.snapshot();
+
+  const moved = root.getChild(0).getChild(1);
+  root.getChild(0).removeChild(moved);
+  root.getChild(1).insertChild(moved, 0);
+  root.setChildren([root.getChild(1), root.getChild(0)]);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(moved.getParent()?.getChildCount()).toBe(3);
+  expect(version.exportTopology().childCount).toEqual(
+    new Uint32Array([2, 2, 0, 0, 2, 0, 0]),
+  );
+  expect(version.getComputedLayout(moved)).toMatchObject({ left: 10, top: 0 });
+
+  version.free();
+  root.freeRecursive();
+});
+
+Deno.test("snapshot_keeps_layout_after_fractional_shift", () => {
+  const root = Yoga.Node.create();
+  root.setWidth(100);
+  const spacer = Yoga.Node.create();
+  spacer.setHeight(10.3);
+  root.insertChild(spacer, 0);
+  const row = Yoga.Node.create();
+  row.setFlexDirection(Yoga.FLEX_DIRECTION_ROW);
+  root.insertChild(row, 1);
+  const cell = Yoga.Node.create();
+  cell.setWidth(20.4);
+  cell.setHeight(10.4);
+  row.insertChild(cell, 0);
+  const inner = Yoga.Node.create();
+  inner.setMargin(Yoga.EDGE_TOP, 0.4);
+  inner.setHeight(5.2);
+  cell.insertChild(inner, 0);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  const version = root.snapshot();
+  const cellLayout = version.getComputedLayout(cell);
+  const innerLayout = version.getComputedLayout(inner);
+  const frames = Array.from(version.exportLayout());
+  const bytes = new Uint8Array(version.serialize());
+
+  // The row and everything below it keep their layout and are reused, but
+  // move by a fraction of a pixel.
+  spacer.setHeight(10.6);
+  root.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(row.getComputedTop()).toBe(11);
+  expect(version.getComputedLayout(row)?.top).toBe(10);
+  expect(version.getComputedLayout(cell)).toEqual(cellLayout);
+  expect(version.getComputedLayout(inner)).toEqual(innerLayout);
+  expect(Array.from(version.exportLayout())).toEqual(frames);
+  expect(new Uint8Array(version.serialize())).toEqual(bytes);
+
+  version.free();
+  root.freeRecursive();
+  expect(Yoga.getMemoryStats().frozenNodes).toBe(0);
+});
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Yoga from "yoga-layout";
+import { expect } from "jsr:@std/expect";
+
+function createRows(count: number, height: number) {
+  const rows = [];
+  for (let i = 0; i < count; i++) {
+    const row = Yoga.Node.create();
+    row.setHeight(height);
+    rows.push(row);
+  }
+  return rows;
+}
+
+Deno.test("virtual_list_range_covers_window_and_overscan", () => {
+  const list = Yoga.Node.create();
+  list.setHeight(100);
+  list.setVirtualItemCount(1000, 20);
+  list.setVirtualWindow(0, 100, 2);
+
+  expect(list.getVirtualRange()).toEqual({ start: 0, end: 7 });
+  expect(list.getVirtualContentSize()).toBe(20000);
+  expect(list.getPadding(Yoga.EDGE_BOTTOM)).toEqual({
+    unit: Yoga.UNIT_POINT,
+    value: 19860,
+  });
+
+  list.freeRecursive();
+});
+
+Deno.test("virtual_list_feeds_back_measured_sizes", () => {
+  const list = Yoga.Node.create();
+  list.setHeight(100);
+  list.setVirtualItemCount(1000, 20);
+  list.setVirtualWindow(0, 100, 2);
+  list.setChildren(createRows(7, 30));
+  list.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(list.getChild(1).getComputedTop()).toBe(30);
+  expect(list.getVirtualItemOffset(7)).toBe(210);
+  expect(list.getVirtualContentSize()).toBe(20070);
+
+  list.setVirtualWindow(1000, 100);
+  expect(list.getVirtualRange()).toEqual({ start: 46, end: 52 });
+  expect(list.getVirtualItemOffset(46)).toBe(990);
+
+  const previous = [];
+  for (let i = 0; i < list.getChildCount(); i++) {
+    previous.push(list.getChild(i));
+  }
+  list.setChildren(createRows(6, 20));
+  for (const row of previous) {
+    row.free();
+  }
+  list.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+  expect(list.getChild(0).getComputedTop()).toBe(990);
+
+  list.freeRecursive();
+});
+
+Deno.test("virtual_list_content_size_excludes_trailing_gap", () => {
+  const list = Yoga.Node.create();
+  list.setGap(Yoga.GUTTER_ROW, 10);
+  list.setVirtualItemCount(3, 30);
+  list.setVirtualWindow(0, 1000);
+  list.setChildren(createRows(3, 20));
+  list.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(list.getVirtualRange()).toEqual({ start: 0, end: 3 });
+  expect(list.getVirtualContentSize()).toBe(80);
+  expect(list.getComputedHeight()).toBe(80);
+
+  list.freeRecursive();
+});
+
+Deno.test("virtual_list_methods_require_virtual_list", () => {
+  const node = Yoga.Node.create();
+  expect(() => node.getVirtualRange()).toThrow("Node is not a virtual list");
+
+  node.setVirtualItemCount(10, 10);
+  node.unsetVirtualList();
+  expect(() => node.setVirtualWindow(0, 10)).toThrow();
+  expect(node.getPadding(Yoga.EDGE_BOTTOM).unit).toBe(Yoga.UNIT_UNDEFINED);
+
+  node.free();
+});
+
+Deno.test("virtual_list_spacers_add_to_own_padding", () => {
+  const list = Yoga.Node.create();
+  list.setHeight(100);
+  list.setPadding(Yoga.EDGE_TOP, 8);
+  list.setPadding(Yoga.EDGE_VERTICAL, 4);
+  list.setVirtualItemCount(100, 20);
+  list.setVirtualWindow(400, 100);
+
+  expect(list.getVirtualRange()).toEqual({ start: 20, end: 25 });
+  expect(list.getPadding(Yoga.EDGE_TOP)).toEqual({
+    unit: Yoga.UNIT_POINT,
+    value: 408,
+  });
+  expect(list.getPadding(Yoga.EDGE_BOTTOM)).toEqual({
+    unit: Yoga.UNIT_POINT,
+    value: 1504,
+  });
+
+  list.unsetVirtualList();
+  expect(list.getPadding(Yoga.EDGE_TOP)).toEqual({
+    unit: Yoga.UNIT_POINT,
+    value: 8,
+  });
+  expect(list.getPadding(Yoga.EDGE_BOTTOM).unit).toBe(Yoga.UNIT_UNDEFINED);
+  expect(list.getPadding(Yoga.EDGE_VERTICAL)).toEqual({
+    unit: Yoga.UNIT_POINT,
+    value: 4,
+  });
+
+  list.free();
+});
+
+Deno.test("virtual_list_range_follows_measured_sizes", () => {
+  const list = Yoga.Node.create();
+  list.setHeight(100);
+  list.setVirtualItemCount(1000, 20);
+  list.setVirtualWindow(0, 100);
+  list.setChildren(createRows(5, 50));
+  list.calculateLayout(undefined, undefined, Yoga.DIRECTION_LTR);
+
+  expect(list.getVirtualRange()).toEqual({ start: 0, end: 2 });
+
+  list.freeRecursive();
+});
@@ -1,4 +1,4 @@
-#!/usr/bin/env ts-node
+#!/usr/bin/env -S deno run -A
 /**
  * Copyright (c) Meta Platforms, Inc. and affiliates.
  *
@@ -8,54 +8,261 @@
  * @format
  */
 
-import path from "path";
+// Runs YGBENCHMARK files against one or more Yoga backends and reports
+// per-benchmark medians, p95s and 95% confidence intervals.
+//
+//   deno run -A tests/bin/run-bench.ts [options] <files...>
+//
+//   --backend <list>     comma separated backends (default: napi,wasm)
+//   --min-time <ms>      minimum measuring time per benchmark (default: 1000)
+//   --json <file>        write the results as JSON
+//   --baseline <file>    compare against results previously written by --json
+//   --threshold <pct>    allowed median slowdown vs. the baseline (default: 5)
+//
+// Each backend runs in its own Deno subprocess with an import map pointing
+// "yoga-layout" at that backend, so every backend sees the same scenarios.
+// Exits with status 1 if a benchmark regressed against the baseline.
 
-const WARMUP_ITERATIONS = 3;
-const BENCHMARK_ITERATIONS = 10;
+import { parseArgs } from "jsr:@std/cli/parse-args";
 
-const testFiles = process.argv.slice(2);
+const BACKENDS: Record<string, string> = {
+  napi: new URL("../../mod.ts", import.meta.url).href,
+  wasm: "npm:yoga-layout@^3.1.0",
+};
 
-const testResults = new Map<string, Map<string, number>>();
+const MIN_WARMUP_MS = 200;
+const MIN_WARMUP_ITERATIONS = 3;
+const MIN_SAMPLE_MS = 10;
+const MIN_SAMPLES = 10;
+const MAX_SAMPLES = 200;
 
-for (const type of ["wasm"]) {
-  for (const file of testFiles) {
-    globalThis.YGBENCHMARK = (name: string, fn: () => void) => {
-      let testEntry = testResults.get(name);
+type Stats = {
+  median: number;
+  p95: number;
+  mean: number;
+  ciLow: number;
+  ciHigh: number;
+  samples: number;
+  iterationsPerSample: number;
+};
 
-      if (testEntry === undefined) {
-        testResults.set(name, testEntry = new Map());
-      }
+type Results = Record<string, Record<string, Stats | { error: string }>>;
+
+type Report = {
+  version: 1;
+  date: string;
+  deno: string;
+  results: Results;
+};
 
-      for (let t = 0; t < WARMUP_ITERATIONS; ++t) fn();
+const args = parseArgs(Deno.args, {
+  string: ["backend", "min-time", "json", "baseline", "threshold", "out"],
+  boolean: ["worker"],
+  default: { backend: "napi,wasm", "min-time": "1000", threshold: "5" },
+});
 
-      const start = Date.now();
+const files = args._.map((file) =>
+  new URL(String(file), `file://${Deno.cwd()}/`).href
+);
+const minTime = Number(args["min-time"]);
 
-      for (let t = 0; t < BENCHMARK_ITERATIONS; ++t) fn();
+function percentile(sorted: number[], p: number) {
+  const rank = (sorted.length - 1) * p;
+  const lower = Math.floor(rank);
+  const upper = Math.ceil(rank);
+  return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+}
 
-      const end = Date.now();
+// The confidence interval of the median comes from order statistics, so it
+// makes no assumption about how the samples are distributed.
+function summarize(samples: number[], iterationsPerSample: number): Stats {
+  const sorted = [...samples].sort((a, b) => a - b);
+  const n = sorted.length;
+  const spread = 1.96 * Math.sqrt(n) / 2;
+  const low = Math.max(0, Math.floor(n / 2 - spread));
+  const high = Math.min(n - 1, Math.ceil(n / 2 + spread));
+  return {
+    median: percentile(sorted, 0.5),
+    p95: percentile(sorted, 0.95),
+    mean: sorted.reduce((sum, value) => sum + value, 0) / n,
+    ciLow: sorted[low],
+    ciHigh: sorted[high],
+    samples: n,
+    iterationsPerSample,
+  };
+}
 
-      testEntry.set(type, (end - start) / BENCHMARK_ITERATIONS);
-    };
+const collectGarbage = (globalThis as { gc?: () => void }).gc ?? (() => {});
 
-    const modulePath = path.resolve(file);
-    await import(modulePath);
-  }
+// Times `iterations` calls and returns the time per call in milliseconds.
+function timeBatch(fn: () => void, iterations: number) {
+  const start = performance.now();
+  for (let i = 0; i < iterations; i++) fn();
+  return (performance.now() - start) / iterations;
 }
 
-console.log(
-  `Note: those tests are independants; there is no time relation to be expected between them`,
-);
+function measure(fn: () => void): Stats {
+  // Warm up until the JIT settled, and use it to size the batches.
+  let warmupIterations = 0;
+  const warmupStart = performance.now();
+  while (
+    warmupIterations < MIN_WARMUP_ITERATIONS ||
+    performance.now() - warmupStart < MIN_WARMUP_MS
+  ) {
+    fn();
+    warmupIterations++;
+  }
+  const estimate = (performance.now() - warmupStart) / warmupIterations;
+  const iterations = Math.max(1, Math.ceil(MIN_SAMPLE_MS / estimate));
 
-for (const [name, results] of testResults) {
-  console.log();
+  // Garbage left by one sample must not be collected during the next one.
+  const samples: number[] = [];
+  const start = performance.now();
+  while (
+    samples.length < MIN_SAMPLES ||
+    (performance.now() - start < minTime && samples.length < MAX_SAMPLES)
+  ) {
+    collectGarbage();
+    samples.push(timeBatch(fn, iterations));
+  }
+  return summarize(samples, iterations);
+}
 
-  const min = Math.min(Infinity, ...results.values());
+async function runWorker(backend: string) {
+  const results: Results = {};
+  (globalThis as any).YGBENCHMARK = (name: string, fn: () => void) => {
+    try {
+      results[name] = { [backend]: measure(fn) };
+    } catch (e) {
+      results[name] = { [backend]: { error: String(e) } };
+    }
+  };
+  for (const file of files) {
+    await import(file);
+  }
+  await Deno.writeTextFile(args.out!, JSON.stringify(results));
+}
 
-  console.log(name);
+async function runBackend(backend: string): Promise<Results> {
+  const importMap = await Deno.makeTempFile({ suffix: ".json" });
+  const out = await Deno.makeTempFile({ suffix: ".json" });
+  try {
+    await Deno.writeTextFile(
+      importMap,
+      JSON.stringify({ imports: { "yoga-layout": BACKENDS[backend] } }),
+    );
+    const command = new Deno.Command(Deno.execPath(), {
+      args: [
+        "run",
+        "-A",
+        "--v8-flags=--expose-gc",
+        `--import-map=${importMap}`,
+        new URL(import.meta.url).pathname,
+        "--worker",
+        `--backend=${backend}`,
+        `--min-time=${minTime}`,
+        `--out=${out}`,
+        ...files,
+      ],
+      stdout: "inherit",
+      stderr: "inherit",
+    });
+    const { success } = await command.output();
+    if (!success) {
+      throw new Error(`The ${backend} benchmarks failed`);
+    }
+    return JSON.parse(await Deno.readTextFile(out));
+  } finally {
+    await Deno.remove(importMap);
+    await Deno.remove(out);
+  }
+}
 
-  for (const [type, result] of results) {
-    console.log(
-      `  - ${type}: ${result}ms (${Math.round((result / min) * 10000) / 100}%)`,
+function format(ms: number) {
+  return ms >= 1 ? `${ms.toFixed(2)}ms` : `${(ms * 1000).toFixed(1)}µs`;
+}
+
+function print(results: Results) {
+  for (const [name, entries] of Object.entries(results)) {
+    console.log();
+    console.log(name);
+    const medians = Object.values(entries).flatMap((entry) =>
+      "median" in entry ? [entry.median] : []
     );
+    const fastest = Math.min(...medians);
+    for (const [backend, entry] of Object.entries(entries)) {
+      if ("error" in entry) {
+        console.log(`  - ${backend}: unsupported (${entry.error})`);
+        continue;
+      }
+      const relative = Math.round((entry.median / fastest) * 100);
+      console.log(
+        `  - ${backend}: median ${format(entry.median)} ` +
+          `[${format(entry.ciLow)}, ${format(entry.ciHigh)}], ` +
+          `p95 ${format(entry.p95)}, ${entry.samples} samples ` +
+          `(${relative}%)`,
+      );
+    }
+  }
+}
+
+// A benchmark regressed if its median is slower than the threshold allows and
+// the confidence intervals don't overlap, so noise alone can't fail a run.
+function compare(results: Results, baseline: Report, threshold: number) {
+  const regressions: string[] = [];
+  for (const [name, entries] of Object.entries(results)) {
+    for (const [backend, entry] of Object.entries(entries)) {
+      const previous = baseline.results[name]?.[backend];
+      if (!previous || !("median" in previous) || !("median" in entry)) {
+        continue;
+      }
+      const change = (entry.median / previous.median - 1) * 100;
+      if (change > threshold && entry.ciLow > previous.ciHigh) {
+        regressions.push(
+          `${name} (${backend}): ${format(previous.median)} -> ` +
+            `${format(entry.median)} (+${change.toFixed(1)}%)`,
+        );
+      }
+    }
+  }
+  return regressions;
+}
+
+if (args.worker) {
+  await runWorker(args.backend);
+} else {
+  const results: Results = {};
+  for (const backend of args.backend.split(",")) {
+    if (!(backend in BACKENDS)) {
+      throw new Error(`Unknown backend "${backend}"`);
+    }
+    for (const [name, entries] of Object.entries(await runBackend(backend))) {
+      results[name] = { ...results[name], ...entries };
+    }
+  }
+
+  print(results);
+
+  const report: Report = {
+    version: 1,
+    date: new Date().toISOString(),
+    deno: Deno.version.deno,
+    results,
+  };
+  if (args.json) {
+    await Deno.writeTextFile(args.json, JSON.stringify(report, null, 2));
+  }
+  if (args.baseline) {
+    const baseline = JSON.parse(await Deno.readTextFile(args.baseline));
+    const regressions = compare(results, baseline, Number(args.threshold));
+    console.log();
+    if (regressions.length > 0) {
+      console.log(`Regressions beyond ${args.threshold}%:`);
+      for (const regression of regressions) {
+        console.log(`  - ${regression}`);
+      }
+      Deno.exit(1);
+    }
+    console.log(`No regressions beyond ${args.threshold}%`);
   }
 }
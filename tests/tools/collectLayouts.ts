@@ -0,0 +1,19 @@
+/**
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ *
+ * @format
+ */
+
+import type { Layout, Node } from "yoga-layout";
+
+// The computed layouts of the subtree under `node`, in preorder.
+export function collectLayouts(node: Node): Layout[] {
+  const layouts = [node.getComputedLayout()];
+  for (let i = 0; i < node.getChildCount(); i++) {
+    layouts.push(...collectLayouts(node.getChild(i)));
+  }
+  return layouts;
+}